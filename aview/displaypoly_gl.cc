@@ -31,6 +31,7 @@
 #include "../config.h"
 #endif
 
+#define GL_GLEXT_PROTOTYPES
 #ifdef HAVE_GL_GL_H
 #include <GL/gl.h>
 #elif defined HAVE_OPENGL_GL_H
@@ -43,17 +44,29 @@
 #include <OpenGL/glu.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <functional>
+#include <map>
 #include <vector>
 
 #include "../base/antiprism.h"
 #include "displaypoly_gl.h"
 #include "gl_writer.h"
 
+using std::map;
 using std::vector;
 
 using namespace anti;
 
+// Buffer objects, shaders and instanced drawing are used when the GL
+// headers declare them and the GL version is at least 3.3
+#if defined(GL_VERSION_3_3) && !defined(_WIN32)
+#define USE_GL_BUFFERS
+#endif
+
 extern unsigned char stippleMask[17][128];
 
 void gl_set_material(Color col = Vec3d(.5, .5, .5), bool trans = true,
@@ -73,36 +86,507 @@ void gl_set_material(Color col, bool trans, int sides)
     glPolygonStipple(stippleMask[int(cv[3] * 16 + 0.5)]);
 }
 
+// Display lists and buffers released by objects, which may not have a
+// current GL context, are deleted the next time a model is drawn
+static vector<std::pair<GLuint, GLsizei>> &lists_to_delete()
+{
+  static vector<std::pair<GLuint, GLsizei>> lists;
+  return lists;
+}
+
+static vector<GLuint> &bufs_to_delete()
+{
+  static vector<GLuint> bufs;
+  return bufs;
+}
+
+static void delete_released_lists()
+{
+  for (const auto &lists : lists_to_delete())
+    glDeleteLists(lists.first, lists.second);
+  lists_to_delete().clear();
+#ifdef USE_GL_BUFFERS
+  if (bufs_to_delete().size())
+    glDeleteBuffers(bufs_to_delete().size(), bufs_to_delete().data());
+#endif
+  bufs_to_delete().clear();
+}
+
+DisplayPoly_gl::ElemList &
+DisplayPoly_gl::ElemList::operator=(const ElemList &)
+{
+  geom_changed(); // keep the lists and buffers, but make them again
+  return *this;
+}
+
+bool DisplayPoly_gl::ElemList::needs_compile(const vector<double> &new_key)
+{
+  if (key.size() && key == new_key)
+    return false;
+  release();
+  key = new_key;
+  return true;
+}
+
+void DisplayPoly_gl::ElemList::gen_lists(int num_groups)
+{
+  group_cols.clear();
+  lists = (num_groups) ? glGenLists(num_groups) : 0;
+  num_lists = (lists) ? num_groups : 0;
+}
+
+void DisplayPoly_gl::ElemList::geom_changed()
+{
+  key.clear();
+  group_starts.clear();
+  disp_cols.clear();
+}
+
+void DisplayPoly_gl::ElemList::release()
+{
+  if (lists)
+    lists_to_delete().push_back({lists, num_lists});
+  if (mesh)
+    lists_to_delete().push_back({mesh, 1});
+  for (GLuint buf : {geom_buf, col_buf, mesh_buf})
+    if (buf)
+      bufs_to_delete().push_back(buf);
+  lists = 0;
+  num_lists = 0;
+  mesh = 0;
+  geom_buf = 0;
+  col_buf = 0;
+  mesh_buf = 0;
+  mesh_sz = 0;
+  group_cols.clear();
+  group_starts.clear();
+  disp_cols.clear();
+  key.clear();
+}
+
+// Group the elements of a type by the colour they have in the geometry,
+// which may be an index. The display colour of a group depends on the
+// colour map and the default colour, and is found when it is drawn.
+static map<Color, vector<int>> elems_by_color(const Geometry &geom,
+                                             int type, int num_elems)
+{
+  map<Color, vector<int>> col_elems;
+  for (int i = 0; i < num_elems; i++)
+    col_elems[geom.colors(type).get(i)].push_back(i);
+  return col_elems;
+}
+
+// Colour to display a group of elements with
+static Color display_col(Color col, const Coloring &clrng, Color def_col)
+{
+  if (col.is_index())
+    col = clrng.get_col(col.get_index());
+  if (!col.is_value())
+    col = def_col; // use default
+  return col;
+}
+
+#ifdef USE_GL_BUFFERS
+
+// Vertex shader with the lighting of the fixed pipeline, as set up by
+// gl_writer, and the materials of gl_set_material(), but with the colour
+// taken from an attribute. A point is placed by a translation and the
+// images of the axes, which are attributes for each ball or rod instance.
+static const char *vert_shader_src = R"(
+#version 120
+attribute vec4 col;
+attribute vec3 inst_pos;
+attribute vec3 inst_x;
+attribute vec3 inst_y;
+attribute vec3 inst_z;
+uniform bool back_black;
+
+vec4 light(vec3 norm, vec3 pt, vec4 scene_col, vec4 amb, vec3 diff)
+{
+  vec4 l_pos = gl_LightSource[0].position;
+  vec3 l_dir = normalize(l_pos.xyz - l_pos.w * pt);
+  vec3 c = scene_col.rgb + gl_LightSource[0].ambient.rgb * amb.rgb;
+  float n_dot_l = dot(norm, l_dir);
+  if (n_dot_l > 0.0) {
+    vec3 half_v = normalize(l_dir + vec3(0.0, 0.0, 1.0));
+    float spec = pow(max(dot(norm, half_v), 0.0), 100.0);
+    c += gl_LightSource[0].diffuse.rgb * diff * n_dot_l +
+         gl_LightSource[0].specular.rgb * diff / 2.0 * spec;
+  }
+  return vec4(c, 1.0);
+}
+
+void main()
+{
+  vec3 pt = inst_pos + inst_x * gl_Vertex.x + inst_y * gl_Vertex.y +
+            inst_z * gl_Vertex.z;
+  vec3 norm = inst_x * gl_Normal.x + inst_y * gl_Normal.y +
+              inst_z * (gl_Normal.z / dot(inst_z, inst_z));
+  vec4 eye_pt = gl_ModelViewMatrix * vec4(pt, 1.0);
+  gl_Position = gl_ProjectionMatrix * eye_pt;
+  norm = normalize(gl_NormalMatrix * norm);
+  vec3 e_pt = eye_pt.xyz / eye_pt.w;
+  gl_FrontColor = light(norm, e_pt, gl_FrontLightModelProduct.sceneColor,
+                        gl_FrontMaterial.ambient, col.rgb);
+  gl_BackColor = light(-norm, e_pt, gl_BackLightModelProduct.sceneColor,
+                       gl_BackMaterial.ambient,
+                       back_black ? vec3(0.0) : col.rgb);
+}
+)";
+
+// The shader program and its attribute locations
+struct GlProgram {
+  GLuint prog = 0;
+  GLint col;
+  GLint inst[4]; // inst_pos, inst_x, inst_y, inst_z
+  GLint back_black;
+};
+
+// Make the shader program, the first time it is needed. Returns nullptr
+// if the GL does not have what is needed to draw with buffers.
+static const GlProgram *gl_program()
+{
+  static GlProgram gl_prog;
+  static bool tried = false;
+  if (tried)
+    return (gl_prog.prog) ? &gl_prog : nullptr;
+  tried = true;
+
+  int major = 0, minor = 0;
+  const char *ver = (const char *)glGetString(GL_VERSION);
+  if (!ver || sscanf(ver, "%d.%d", &major, &minor) != 2 ||
+      major * 10 + minor < 33)
+    return nullptr;
+
+  GLuint shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(shader, 1, &vert_shader_src, nullptr);
+  glCompileShader(shader);
+  GLint ok;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+  if (!ok) {
+    glDeleteShader(shader);
+    return nullptr;
+  }
+  GLuint prog = glCreateProgram();
+  glAttachShader(prog, shader);
+  glLinkProgram(prog);
+  glDeleteShader(shader);
+  glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+  if (!ok) {
+    glDeleteProgram(prog);
+    return nullptr;
+  }
+
+  gl_prog.prog = prog;
+  gl_prog.col = glGetAttribLocation(prog, "col");
+  const char *inst_names[] = {"inst_pos", "inst_x", "inst_y", "inst_z"};
+  for (int i = 0; i < 4; i++)
+    gl_prog.inst[i] = glGetAttribLocation(prog, inst_names[i]);
+  gl_prog.back_black = glGetUniformLocation(prog, "back_black");
+  bool all_found = (gl_prog.col >= 0);
+  for (int i = 0; i < 4; i++)
+    all_found = all_found && gl_prog.inst[i] >= 0;
+  if (!all_found) {
+    glDeleteProgram(prog);
+    gl_prog.prog = 0;
+    return nullptr;
+  }
+  return &gl_prog;
+}
+
+// Upload data to a buffer, generating the buffer if necessary
+template <typename T>
+static void upload_buf(GLuint &buf, const vector<T> &data)
+{
+  if (!buf)
+    glGenBuffers(1, &buf);
+  glBindBuffer(GL_ARRAY_BUFFER, buf);
+  glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(T), data.data(),
+               GL_STATIC_DRAW);
+}
+
+#endif // USE_GL_BUFFERS
+
+// Append a triangle, with the points and normals interleaved, turned to
+// face the same way as its normals
+static void add_mesh_tri(vector<float> &mesh, Vec3d pts[3], Vec3d norms[3])
+{
+  if (vdot(vcross(pts[1] - pts[0], pts[2] - pts[0]),
+           norms[0] + norms[1] + norms[2]) < 0) {
+    std::swap(pts[1], pts[2]);
+    std::swap(norms[1], norms[2]);
+  }
+  for (int i = 0; i < 3; i++)
+    for (const Vec3d &v : {pts[i], norms[i]})
+      for (int j = 0; j < 3; j++)
+        mesh.push_back(v[j]);
+}
+
+// Ball mesh, divided as gluSphere()
+static vector<float> ball_mesh(double rad, int long_div, int lat_div)
+{
+  auto dir = [&](int lat, int lng) {
+    double a = M_PI * lat / lat_div;
+    double b = 2 * M_PI * lng / long_div;
+    return Vec3d(-sin(b) * sin(a), cos(b) * sin(a), cos(a));
+  };
+  vector<float> mesh;
+  for (int i = 0; i < lat_div; i++)
+    for (int j = 0; j < long_div; j++) {
+      // two triangles for each quadrilateral, one at a pole
+      Vec3d q[4] = {dir(i, j), dir(i + 1, j), dir(i + 1, j + 1),
+                    dir(i, j + 1)};
+      if (i < lat_div - 1) {
+        Vec3d pts[3] = {q[0] * rad, q[1] * rad, q[2] * rad};
+        Vec3d norms[3] = {q[0], q[1], q[2]};
+        add_mesh_tri(mesh, pts, norms);
+      }
+      if (i > 0) {
+        Vec3d pts[3] = {q[0] * rad, q[2] * rad, q[3] * rad};
+        Vec3d norms[3] = {q[0], q[2], q[3]};
+        add_mesh_tri(mesh, pts, norms);
+      }
+    }
+  return mesh;
+}
+
+// Rod mesh of unit length along the z-axis, divided as gluCylinder()
+// with one stack
+static vector<float> rod_mesh(double rad, int long_div)
+{
+  auto dir = [&](int lng) {
+    double b = 2 * M_PI * lng / long_div;
+    return Vec3d(sin(b), cos(b), 0);
+  };
+  vector<float> mesh;
+  for (int j = 0; j < long_div; j++) {
+    Vec3d d0 = dir(j), d1 = dir(j + 1);
+    Vec3d norms0[3] = {d0, d1, d1};
+    Vec3d pts0[3] = {d0 * rad, d1 * rad, d1 * rad + Vec3d::Z};
+    add_mesh_tri(mesh, pts0, norms0);
+    Vec3d norms1[3] = {d0, d1, d0};
+    Vec3d pts1[3] = {d0 * rad, d1 * rad + Vec3d::Z, d0 * rad + Vec3d::Z};
+    add_mesh_tri(mesh, pts1, norms1);
+  }
+  return mesh;
+}
+
+// Whether to draw with buffer objects rather than display lists
+static bool use_gl_bufs()
+{
+#ifdef USE_GL_BUFFERS
+  return gl_program() != nullptr;
+#else
+  return false;
+#endif
+}
+
+// Display colours of the groups of an element type
+static vector<Color> group_disp_cols(const vector<Color> &group_cols,
+                                     const Coloring &clrng, Color def_col)
+{
+  vector<Color> disp_cols;
+  for (const auto &col : group_cols)
+    disp_cols.push_back(display_col(col, clrng, def_col));
+  return disp_cols;
+}
+
+void DisplayPoly_gl::ElemList::call_lists(const vector<Color> &disp_cols,
+                                          bool trans, int sides) const
+{
+  // Call the group lists of each material together, after setting the
+  // material once. Invisible groups are not drawn.
+  map<Color, vector<GLuint>> mat_lists;
+  for (unsigned int i = 0; i < disp_cols.size(); i++)
+    if (!disp_cols[i].is_invisible())
+      mat_lists[disp_cols[i]].push_back(lists + i);
+  for (const auto &kp : mat_lists) {
+    gl_set_material(kp.first, trans, sides);
+    glCallLists(kp.second.size(), GL_UNSIGNED_INT, kp.second.data());
+  }
+}
+
+void DisplayPoly_gl::ElemList::set_mesh(const vector<float> &mesh_data)
+{
+#ifdef USE_GL_BUFFERS
+  upload_buf(mesh_buf, mesh_data);
+  mesh_sz = mesh_data.size() / 6;
+#endif
+}
+
+void DisplayPoly_gl::ElemList::set_groups(
+    const map<Color, vector<int>> &col_elems,
+    const std::function<void(int, vector<float> &)> &add, int item_sz)
+{
+#ifdef USE_GL_BUFFERS
+  // add() appends the items for an element, each of item_sz values
+  vector<float> data;
+  group_cols.clear();
+  group_starts.assign(1, 0);
+  for (const auto &kp : col_elems) {
+    for (int idx : kp.second)
+      add(idx, data);
+    group_cols.push_back(kp.first);
+    group_starts.push_back(data.size() / item_sz);
+  }
+  upload_buf(geom_buf, data);
+  disp_cols.clear();
+#endif
+}
+
+void DisplayPoly_gl::ElemList::draw_bufs(const vector<Color> &cols,
+                                         bool trans, bool instanced,
+                                         bool back_black)
+{
+#ifdef USE_GL_BUFFERS
+  // Upload the display colours, for each item, if they have changed
+  if (cols != disp_cols) {
+    vector<GLubyte> item_cols;
+    item_cols.reserve(4 * group_starts.back());
+    for (unsigned int i = 0; i < cols.size(); i++)
+      for (int j = group_starts[i]; j < group_starts[i + 1]; j++)
+        for (int k = 0; k < 4; k++)
+          item_cols.push_back(cols[i][k]);
+    upload_buf(col_buf, item_cols);
+    disp_cols = cols;
+  }
+
+  const GlProgram *gl_prog = gl_program();
+  glUseProgram(gl_prog->prog);
+  glUniform1i(gl_prog->back_black, back_black);
+  glEnable(GL_VERTEX_PROGRAM_TWO_SIDE);
+
+  // Points and normals come from the mesh, or the faces
+  glBindBuffer(GL_ARRAY_BUFFER, (instanced) ? mesh_buf : geom_buf);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 6 * sizeof(GLfloat), (void *)0);
+  glNormalPointer(GL_FLOAT, 6 * sizeof(GLfloat),
+                  (void *)(3 * sizeof(GLfloat)));
+
+  vector<GLint> attribs = {gl_prog->col};
+  if (instanced)
+    attribs.insert(attribs.end(), gl_prog->inst, gl_prog->inst + 4);
+  else {
+    // faces are not moved by a placement
+    const Vec3d pl[4] = {Vec3d(0, 0, 0), Vec3d::X, Vec3d::Y, Vec3d::Z};
+    for (int i = 0; i < 4; i++)
+      glVertexAttrib3d(gl_prog->inst[i], pl[i][0], pl[i][1], pl[i][2]);
+  }
+  for (GLint attrib : attribs) {
+    glEnableVertexAttribArray(attrib);
+    glVertexAttribDivisor(attrib, instanced);
+  }
+
+  // Point the colours, and placements, at the first item to draw. Faces
+  // are drawn from an offset, so their colours start at the first item.
+  auto set_pointers = [&](int first) {
+    glBindBuffer(GL_ARRAY_BUFFER, col_buf);
+    glVertexAttribPointer(gl_prog->col, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0,
+                          (void *)(4 * (size_t)first));
+    glBindBuffer(GL_ARRAY_BUFFER, geom_buf);
+    for (int i = 0; i < 4 && instanced; i++)
+      glVertexAttribPointer(
+          gl_prog->inst[i], 3, GL_FLOAT, GL_FALSE, 12 * sizeof(GLfloat),
+          (void *)((12 * (size_t)first + 3 * i) * sizeof(GLfloat)));
+  };
+  if (!instanced)
+    set_pointers(0);
+
+  // Draw each run of consecutive visible groups with the same
+  // transparency with a single call
+  auto level = [&](const Color &col) {
+    return (trans) ? int(col.get_vec4d()[3] * 16 + 0.5) : 16;
+  };
+  const int num_groups = cols.size();
+  for (int i = 0; i < num_groups;) {
+    int end = i;
+    while (end < num_groups && !cols[end].is_invisible() &&
+           level(cols[end]) == level(cols[i]))
+      end++;
+    if (end == i) { // invisible
+      i++;
+      continue;
+    }
+    if (trans)
+      glPolygonStipple(stippleMask[level(cols[i])]);
+    const int first = group_starts[i];
+    const int count = group_starts[end] - first;
+    if (instanced) {
+      set_pointers(first);
+      glDrawArraysInstanced(GL_TRIANGLES, 0, mesh_sz, count);
+    }
+    else
+      glDrawArrays(GL_TRIANGLES, first, count);
+    i = end;
+  }
+
+  for (GLint attrib : attribs) {
+    glVertexAttribDivisor(attrib, 0);
+    glDisableVertexAttribArray(attrib);
+  }
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisable(GL_VERTEX_PROGRAM_TWO_SIDE);
+  glUseProgram(0);
+#endif
+}
+
 void DisplayPoly_gl::gl_verts(const Scene &scen)
 {
   double v_rad = get_vert_rad();
   double extra = 10 * v_rad / scen.get_width();
   int long_div = int(11 * (1 + extra));
   int lat_div = int(7 * (1 + extra));
-  GLUquadric *quad = gluNewQuadric();
-  GLuint sph = glGenLists(1);
-  glNewList(sph, GL_COMPILE);
-  gluSphere(quad, v_rad, long_div, lat_div);
-  glEndList();
+  vector<double> key = {v_rad, double(long_div), double(lat_div)};
 
+  ElemList &e_list = elem_lists[VERTS];
   const vector<Vec3d> &verts = disp_geom.verts();
-  for (unsigned int i = 0; i < verts.size(); i++) {
-    Color col = disp_geom.colors(VERTS).get((int)i);
-    if (col.is_index())
-      col = clrng(VERTS).get_col(col.get_index());
-    if (!col.is_value())
-      col = def_col(VERTS); // use default
-    if (col.is_invisible())
-      continue;
-
-    gl_set_material(col, get_elem_trans(), GL_FRONT);
-    glPushMatrix();
-    glTranslated(verts[i][0], verts[i][1], verts[i][2]);
-    glCallList(sph);
-    glPopMatrix();
+  const bool use_bufs = use_gl_bufs();
+  if (use_bufs) {
+    if (e_list.key != key) {
+      e_list.set_mesh(ball_mesh(v_rad, long_div, lat_div));
+      e_list.key = key;
+    }
+    if (e_list.group_starts.empty()) {
+      auto add = [&](int v_idx, vector<float> &data) {
+        for (const Vec3d &v : {verts[v_idx], Vec3d::X, Vec3d::Y, Vec3d::Z})
+          data.insert(data.end(), {float(v[0]), float(v[1]), float(v[2])});
+      };
+      e_list.set_groups(elems_by_color(disp_geom, VERTS, verts.size()), add,
+                        12);
+    }
   }
-  glDeleteLists(sph, 1);
-  gluDeleteQuadric(quad);
+  else if (e_list.needs_compile(key)) {
+    GLUquadric *quad = gluNewQuadric();
+    e_list.mesh = glGenLists(1);
+    glNewList(e_list.mesh, GL_COMPILE);
+    gluSphere(quad, v_rad, long_div, lat_div);
+    glEndList();
+    gluDeleteQuadric(quad);
+
+    auto col_verts = elems_by_color(disp_geom, VERTS, verts.size());
+    e_list.gen_lists(col_verts.size());
+    for (const auto &kp : col_verts) {
+      glNewList(e_list.lists + e_list.group_cols.size(), GL_COMPILE);
+      for (int v_idx : kp.second) {
+        glPushMatrix();
+        glTranslated(verts[v_idx][0], verts[v_idx][1], verts[v_idx][2]);
+        glCallList(e_list.mesh);
+        glPopMatrix();
+      }
+      glEndList();
+      e_list.group_cols.push_back(kp.first);
+    }
+  }
+
+  vector<Color> disp_cols =
+      group_disp_cols(e_list.group_cols, get_clrngs()[VERTS], def_col(VERTS));
+  if (use_bufs)
+    e_list.draw_bufs(disp_cols, get_elem_trans(), true);
+  else
+    e_list.call_lists(disp_cols, get_elem_trans(), GL_FRONT);
 }
 
 static void edge_cyl_trans(Vec3d p1, Vec3d p2)
@@ -120,68 +604,143 @@ void DisplayPoly_gl::gl_edges(const Scene &scen)
   double extra = 10 * e_rad / scen.get_width();
   int long_div = int(11 * (1 + extra));
   int lat_div = 1;
+  vector<double> key = {e_rad, double(long_div)};
 
-  GLUquadric *quad = gluNewQuadric();
-  GLuint cyl = glGenLists(1);
-  glNewList(cyl, GL_COMPILE);
-  gluCylinder(quad, e_rad, e_rad, 1, long_div, lat_div);
-  glEndList();
-
+  ElemList &e_list = elem_lists[EDGES];
   const vector<Vec3d> &verts = disp_geom.verts();
   const vector<vector<int>> &edges = disp_geom.edges();
-  for (unsigned int i = 0; i < edges.size(); i++) {
-    Color col = disp_geom.colors(EDGES).get((int)i);
-    if (col.is_index())
-      col = clrng(EDGES).get_col(col.get_index());
-    if (!col.is_value())
-      col = def_col(EDGES); // use default
-    if (col.is_invisible())
-      continue;
-
-    gl_set_material(col, get_elem_trans(), GL_FRONT);
-    glPushMatrix();
-    edge_cyl_trans(verts[edges[i][0]], verts[edges[i][1]]);
-    glCallList(cyl);
-    glPopMatrix();
+  const bool use_bufs = use_gl_bufs();
+  if (use_bufs) {
+    if (e_list.key != key) {
+      e_list.set_mesh(rod_mesh(e_rad, long_div));
+      e_list.key = key;
+    }
+    if (e_list.group_starts.empty()) {
+      // placed as by edge_cyl_trans(), rods of no length are not drawn
+      auto add = [&](int e_idx, vector<float> &data) {
+        const Vec3d &p1 = verts[edges[e_idx][0]];
+        Vec3d p1to2 = verts[edges[e_idx][1]] - p1;
+        if (p1to2.len() < epsilon)
+          return;
+        Trans3d rot = Trans3d::rotate(Vec3d::Z, p1to2);
+        for (const Vec3d &v : {p1, rot * Vec3d::X, rot * Vec3d::Y, p1to2})
+          data.insert(data.end(), {float(v[0]), float(v[1]), float(v[2])});
+      };
+      e_list.set_groups(elems_by_color(disp_geom, EDGES, edges.size()), add,
+                        12);
+    }
+  }
+  else if (e_list.needs_compile(key)) {
+    GLUquadric *quad = gluNewQuadric();
+    e_list.mesh = glGenLists(1);
+    glNewList(e_list.mesh, GL_COMPILE);
+    gluCylinder(quad, e_rad, e_rad, 1, long_div, lat_div);
+    glEndList();
+    gluDeleteQuadric(quad);
+
+    auto col_edges = elems_by_color(disp_geom, EDGES, edges.size());
+    e_list.gen_lists(col_edges.size());
+    for (const auto &kp : col_edges) {
+      glNewList(e_list.lists + e_list.group_cols.size(), GL_COMPILE);
+      for (int e_idx : kp.second) {
+        glPushMatrix();
+        edge_cyl_trans(verts[edges[e_idx][0]], verts[edges[e_idx][1]]);
+        glCallList(e_list.mesh);
+        glPopMatrix();
+      }
+      glEndList();
+      e_list.group_cols.push_back(kp.first);
+    }
   }
-  glDeleteLists(cyl, 1);
-  gluDeleteQuadric(quad);
+
+  vector<Color> disp_cols =
+      group_disp_cols(e_list.group_cols, get_clrngs()[EDGES], def_col(EDGES));
+  if (use_bufs)
+    e_list.draw_bufs(disp_cols, get_elem_trans(), true);
+  else
+    e_list.call_lists(disp_cols, get_elem_trans(), GL_FRONT);
+}
+
+// Add the points of a face as a triangle fan, with the face normal
+// repeated for each point
+static void add_face_pts(const Geometry &geom, int f_idx, vector<float> &pts,
+                         vector<float> &norms)
+{
+  const vector<Vec3d> &verts = geom.verts();
+  const vector<int> &face = geom.faces(f_idx);
+  if (face.size() < 3)
+    return;
+  Vec3d norm = face_norm(verts, face);
+  for (unsigned int j = 1; j < face.size() - 1; j++)
+    for (int v_idx : {face[0], face[j], face[j + 1]}) {
+      for (int k = 0; k < 3; k++)
+        pts.push_back(verts[v_idx][k]);
+      for (int k = 0; k < 3; k++)
+        norms.push_back(norm[k]);
+    }
 }
 
 void DisplayPoly_gl::gl_faces(const Scene &)
 {
-  const vector<Vec3d> &verts = disp_geom.verts();
+  vector<double> key = {1.0}; // only compiled again for a new geometry
+
+  ElemList &e_list = elem_lists[FACES];
   const vector<vector<int>> &faces = disp_geom.faces();
-  for (unsigned int i = 0; i < faces.size(); i++) {
-    if (faces[i].size() < 3)
-      continue;
-    Color col = disp_geom.colors(FACES).get((int)i);
-    if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
-    if (!col.is_value())
-      col = def_col(FACES); // use default
-    if (col.is_invisible())
-      continue;
-    if (show_orientation) {
-      gl_set_material(Color(1.0, 1.0, 1.0), get_elem_trans(), GL_FRONT);
-      gl_set_material(Color(0.0, 0.0, 0.0), get_elem_trans(), GL_BACK);
+  const bool use_bufs = use_gl_bufs();
+  if (use_bufs) {
+    if (e_list.group_starts.empty()) {
+      // points and normals interleaved
+      auto add = [&](int f_idx, vector<float> &data) {
+        add_face_pts(disp_geom, f_idx, data, data);
+      };
+      e_list.set_groups(elems_by_color(disp_geom, FACES, faces.size()), add,
+                        6);
     }
-    else {
-      if (get_transparency_type() == trans_50pc)
-        col.set_rgba(col[0], col[1], col[2], 128);
-      else if (get_transparency_type() == trans_0pc)
-        col.set_rgba(col[0], col[1], col[2], 255);
-
-      gl_set_material(col, get_elem_trans());
+  }
+  else if (e_list.needs_compile(key)) {
+    // Draw the faces of a group with a single call
+    vector<float> pts;
+    vector<float> norms;
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    auto col_faces = elems_by_color(disp_geom, FACES, faces.size());
+    e_list.gen_lists(col_faces.size());
+    for (const auto &kp : col_faces) {
+      pts.clear();
+      norms.clear();
+      for (int f_idx : kp.second)
+        add_face_pts(disp_geom, f_idx, pts, norms);
+      glNewList(e_list.lists + e_list.group_cols.size(), GL_COMPILE);
+      glVertexPointer(3, GL_FLOAT, 0, pts.data());
+      glNormalPointer(GL_FLOAT, 0, norms.data());
+      glDrawArrays(GL_TRIANGLES, 0, pts.size() / 3);
+      glEndList();
+      e_list.group_cols.push_back(kp.first);
     }
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+  }
 
-    glBegin(GL_POLYGON);
-    Vec3d norm = face_norm(verts, faces[i]);
-    glNormal3dv(norm.get_v());
-    for (unsigned int j = 0; j < faces[i].size(); j++)
-      glVertex3dv(verts[faces[i][j]].get_v());
-    glEnd();
+  vector<Color> disp_cols =
+      group_disp_cols(e_list.group_cols, get_clrngs()[FACES], def_col(FACES));
+  for (auto &col : disp_cols) {
+    if (col.is_invisible())
+      continue;
+    if (show_orientation)
+      col = Color(1.0, 1.0, 1.0);
+    else if (get_transparency_type() == trans_50pc)
+      col.set_rgba(col[0], col[1], col[2], 128);
+    else if (get_transparency_type() == trans_0pc)
+      col.set_rgba(col[0], col[1], col[2], 255);
+  }
+  if (use_bufs)
+    e_list.draw_bufs(disp_cols, get_elem_trans(), false, show_orientation);
+  else if (show_orientation) {
+    gl_set_material(Color(0.0, 0.0, 0.0), get_elem_trans(), GL_BACK);
+    e_list.call_lists(disp_cols, get_elem_trans(), GL_FRONT);
   }
+  else
+    e_list.call_lists(disp_cols, get_elem_trans(), GL_FRONT_AND_BACK);
 }
 
 DisplayPoly_gl::DisplayPoly_gl()
@@ -189,8 +748,21 @@ DisplayPoly_gl::DisplayPoly_gl()
 {
 }
 
+void DisplayPoly_gl::lists_changed()
+{
+  for (auto &e_list : elem_lists)
+    e_list.geom_changed();
+}
+
+void DisplayPoly_gl::geom_changed()
+{
+  DisplayPoly::geom_changed();
+  lists_changed();
+}
+
 void DisplayPoly_gl::gl_geom(const Scene &scen)
 {
+  delete_released_lists();
   if (elem(VERTS).get_show())
     gl_verts(scen);
   if (elem(FACES).get_show())
@@ -349,6 +921,12 @@ void DisplayNumLabels_gl::gl_geom(const Scene &scen)
     gl_edges(scen);
 }
 
+void DisplaySymmetry_gl::disp_changed()
+{
+  DisplaySymmetry::disp_changed();
+  lists_changed();
+}
+
 void DisplaySymmetry_gl::gl_geom(const Scene &scen)
 {
   DisplayPoly_gl::gl_geom(scen);
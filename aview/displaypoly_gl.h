@@ -31,6 +31,10 @@
 
 #include "../base/antiprism.h"
 
+#include <functional>
+#include <map>
+#include <vector>
+
 using namespace anti;
 
 class DisplayPoly_gl : public virtual DisplayPoly {
@@ -38,16 +42,68 @@ private:
   bool show_orientation;
   int transparency_type;
 
+  // Drawing data for an element type, kept between frames. The elements
+  // are grouped by the colour they have in the geometry, and the group
+  // colours are looked up when they are drawn, so changing the colour
+  // map or cycling the colours does not rebuild the geometry data.
+  //
+  // When the GL has buffer objects and shaders, face points and normals,
+  // or the placement of each ball or rod, are uploaded once for each
+  // display geometry. The display colours are kept in a separate buffer,
+  // which is the only one uploaded again when they change. Balls and rods
+  // are drawn as instances of a single mesh. Otherwise a display list is
+  // compiled for each group, again when the settings they were made with
+  // (the key) change, or the display geometry changes.
+  //
+  // Released lists and buffers are deleted when a model is next drawn,
+  // with a current context.
+  struct ElemList {
+    unsigned int lists = 0;        // first group list, 0 if none
+    int num_lists = 0;             // number of group lists
+    unsigned int mesh = 0;         // ball or rod list called by the lists
+    std::vector<Color> group_cols; // geometry colour of each group
+    std::vector<double> key;       // settings the lists were compiled with
+
+    unsigned int geom_buf = 0;     // face points and normals, or placements
+    unsigned int col_buf = 0;      // colour of each face point or placement
+    unsigned int mesh_buf = 0;     // ball or rod points and normals
+    int mesh_sz = 0;               // number of points in the mesh
+    std::vector<int> group_starts; // start of each group, then the end
+    std::vector<Color> disp_cols;  // display colour of each group in col_buf
+
+    ElemList() = default;
+    ElemList(const ElemList &) {} // lists belong to a single object
+    ElemList &operator=(const ElemList &);
+    ~ElemList() { release(); }
+    bool needs_compile(const std::vector<double> &new_key);
+    void gen_lists(int num_groups);
+    void call_lists(const std::vector<Color> &disp_cols, bool trans,
+                    int sides) const;
+    void set_mesh(const std::vector<float> &mesh_data);
+    void set_groups(const std::map<Color, std::vector<int>> &col_elems,
+                    const std::function<void(int, std::vector<float> &)> &add,
+                    int item_sz);
+    void draw_bufs(const std::vector<Color> &disp_cols, bool trans,
+                   bool instanced, bool back_black = false);
+    void geom_changed();
+    void release();
+  };
+  ElemList elem_lists[3];
+
 protected:
   void gl_verts(const Scene &scen);
   void gl_edges(const Scene &scen);
   void gl_faces(const Scene &scen);
 
+  /// Make the element drawing data again before it is next drawn
+  void lists_changed();
+
 public:
   enum { trans_model = 0, trans_50pc, trans_0pc };
   DisplayPoly_gl();
 
   GeometryDisplay *clone() const { return new DisplayPoly_gl(*this); };
+  void geom_changed();
   void gl_geom(const Scene &scen);
   void set_show_orientation(bool show = true) { show_orientation = show; }
   bool get_show_orientation() { return show_orientation; }
@@ -76,8 +132,12 @@ public:
 
 class DisplaySymmetry_gl : public virtual DisplaySymmetry,
                            public virtual DisplayPoly_gl {
+protected:
+  void disp_changed();
+
 public:
   GeometryDisplay *clone() const { return new DisplaySymmetry_gl(*this); }
+  void geom_changed() { DisplaySymmetry::geom_changed(); }
   void gl_geom(const Scene &scen);
 };
 
@@ -33,6 +33,7 @@
  * with polyhedra. It includes:
  * - import of OFF, LG3D and simple text coordinate files
  * - export of OFF, VRML, POV, LG3D and text coordinate files
+ * - rendering of PNG and PPM images
  * - vector and matrix operations
  * - geometric utilities
  * - analysis of polyhedra
@@ -53,6 +54,7 @@
 #include "const.h"
 #include "displaypoly.h"
 #include "elemprops.h"
+#include "faceintersect.h"
 #include "geometry.h"
 #include "geometryinfo.h"
 #include "geometryutils.h"
@@ -60,13 +62,18 @@
 #include "iteration.h"
 #include "mathutils.h"
 #include "normal.h"
+#include "parallel.h"
 #include "planar.h"
 #include "polygon.h"
 #include "povwriter.h"
+#include "profile.h"
 #include "random.h"
+#include "rasterwriter.h"
+#include "relaxation.h"
 #include "scene.h"
 #include "status.h"
 #include "symmetry.h"
+#include "textwriter.h"
 #include "tiling.h"
 #include "timer.h"
 #include "trans3d.h"
@@ -30,6 +30,9 @@
 #include "geometry.h"
 #include "geometryutils.h"
 #include "mathutils.h"
+#include "parallel.h"
+#include "private_misc.h"
+#include "profile.h"
 #include "qhull/qhull_ra.h"
 #include "utils.h"
 
@@ -51,70 +54,167 @@ using std::vector;
 
 namespace anti {
 
-static void qhull_cleanup(qhT *qh)
+namespace {
+
+/// Convex hull calculator
+/**Keeps a qhull session, and its error sink, open between calculations,
+ * so that calculating many hulls does not repeat the setup. Vertex
+ * coordinates are passed to qhull without being copied. A context must
+ * only be used by one thread at a time. */
+class HullContext {
+private:
+  qhT *qh;
+  FILE *errfile;
+  bool own_errfile;
+
+  bool run(const std::vector<Vec3d> &verts, std::string qh_cmd);
+  void cleanup();
+  Status make_hull(Geometry &geom, bool append, const std::string &qh_args);
+  int dimension_safe_make_hull(Geometry &geom, bool append,
+                               const std::string &qh_args, Status *stat);
+
+public:
+  /// Constructor
+  HullContext();
+
+  /// Destructor
+  ~HullContext();
+
+  HullContext(const HullContext &) = delete;
+  HullContext &operator=(const HullContext &) = delete;
+
+  /// Add the faces of the convex hull to a geometry.
+  /**\param geom the geometry.
+   * \param qh_args additional arguments to pass to qhull (unsupported,
+   *  may not work, check output.)
+   * \param dim dimension of the hull 3, 2, 1 or 0.
+   * \return status, which evaluates to \c true if qhull could
+   *  calculate the hull(possibly with warnings), otherwise \c false */
+  Status add_hull(Geometry &geom, const std::string &qh_args = "",
+                  int *dim = nullptr);
+
+  /// Set a geometry to its convex hull.
+  /**If the convex hull could not be calculated the geometry is cleared.
+   * \param geom the geometry.
+   * \param qh_args additional arguments to pass to qhull (unsupported,
+   *  may not work, check output.)
+   * \param dim dimension of the hull 3, 2, 1 or 0.
+   * \return status, which evaluates to \c true if qhull could
+   *  calculate the hull(possibly with warnings), otherwise \c false */
+  Status set_hull(Geometry &geom, const std::string &qh_args = "",
+                  int *dim = nullptr);
+
+  /// Get Delaunay edges.
+  /**\param verts the vertices to find the Delaunay edges for
+   * \param edges the Delaunay edges, as a pairs of vertex index numbers,
+   *  mapped to the number of Delaunay tetrahedra the edge was part of
+   * \param qh_args additional arguments to pass to qhull (unsupported,
+   *  may not work, check output.)
+   * \return status, evaluates to \c true if the edges were calculated,
+   *  otherwise false.*/
+  Status get_delaunay_edges(const std::vector<Vec3d> &verts,
+                            std::map<std::pair<int, int>, int> &edges,
+                            const std::string &qh_args = "");
+
+  /// Get Voronoi cells.
+  /**\param verts the vertices to find the Voronoi cells for
+   * \param cells to return the Voronoi cells
+   * \param qh_args additional arguments to pass to qhull (unsupported,
+   *  may not work, check output.)
+   * \return status, evaluates to \c true if the cells were calculated,
+   *  otherwise false.*/
+  Status get_voronoi_cells(const std::vector<Vec3d> &verts,
+                           std::vector<Geometry> *cells,
+                           const std::string &qh_args = "");
+};
+
+} // namespace
+
+HullContext::HullContext()
 {
-  qh_freeqhull(qh, !qh_ALL); // free long memory
-  int curlong, totlong;
-  qh_memfreeshort(qh, &curlong, &totlong); // free short mem and mem allocator
+  errfile = fopen("/dev/null", "w"); // suppress qhull error messages
+  if (!errfile)
+    errfile = fopen("nul", "w"); // try for windows cross compilation
+  own_errfile = (errfile != nullptr);
+  if (!own_errfile)
+    errfile = stderr; // must be a valid pointer
+
+  qh = new qhT;
+  QHULL_LIB_CHECK
+  qh_zero(qh, errfile);
 }
 
-static Status make_hull(Geometry &geom, bool append, string qh_args)
+HullContext::~HullContext()
 {
-  vector<Vec3d> verts = geom.verts();
-  Vec3d cent = geom.centroid();
-
-  map<int, Color> vcols;
-  vcols = geom.colors(VERTS).get_properties();
-
-  const int dim = 3;
-  auto *points = new coordT[verts.size() * dim];
-
-  for (unsigned i = 0; i < verts.size(); i++)
-    for (int j = 0; j < dim; j++)
-      points[i * dim + j] = verts[i][j];
-
-  qh_args.insert(0, "qhull o ");
+  delete qh;
+  if (own_errfile)
+    fclose(errfile);
+}
 
+// Run qhull on the vertex coordinates in place, without copying them.
+// qhull does not write to the input points when ismalloc is False, and
+// makes its own copy before any input transformation.
+bool HullContext::run(const vector<Vec3d> &verts, string qh_cmd)
+{
+  static_assert(sizeof(Vec3d) == 3 * sizeof(coordT),
+                "Vec3d must be stored as three packed coordinates");
+  auto *points =
+      const_cast<coordT *>(reinterpret_cast<const coordT *>(verts.data()));
   boolT ismalloc = False;  // don't free points in qh_freeqhull() or realloc
   FILE *outfile = nullptr; // suppress output from qh_produce_output()
-  FILE *errfile = fopen("/dev/null", "w"); // suppress qhull error messages
-  if (!errfile) {
-    errfile = fopen("nul", "w"); // try for windows cross compilation
-    if (!errfile)
-      errfile = stderr; // must be a valid pointer
-  }
+  return qh_new_qhull(qh, 3, verts.size(), points, ismalloc,
+                      (char *)qh_cmd.c_str(), outfile, errfile) == 0;
+}
 
-  qhT qh_val;
-  qhT *qh = &qh_val;
-  QHULL_LIB_CHECK
-  qh_zero(qh, errfile);
+// Release the memory of the last calculation. qhull sizes its short
+// memory free lists for the hull dimension and options of each run, so
+// they are released too, but the session and error sink are kept.
+void HullContext::cleanup()
+{
+  qh_freeqhull(qh, !qh_ALL); // free long memory
+  int curlong, totlong;
+  qh_memfreeshort(qh, &curlong, &totlong); // free short mem and mem allocator
+}
 
-  int ret = qh_new_qhull(qh, dim, verts.size(), points, ismalloc,
-                         (char *)qh_args.c_str(), outfile, errfile);
+Status HullContext::make_hull(Geometry &geom, bool append,
+                              const string &qh_args)
+{
+  ANTI_PROFILE_SCOPE("hull");
+  const vector<Vec3d> &verts = geom.verts();
+  Vec3d cent = geom.centroid();
 
-  if (ret) {
-    qhull_cleanup(qh);
-    delete[] points;
+  const int dim = 3;
+  if (!run(verts, "qhull o " + qh_args)) {
+    cleanup();
     return Status::error("error calculating convex hull");
   }
 
-  map<size_t, int> vert_order;
+  // map from input vertex index to hull vertex index, when not appending
+  vector<int> vert_order;
+  vector<Vec3d> hull_verts;
+  vector<Color> hull_cols;
+  const coordT *points = qh->first_point;
   vertexT *vertex;
 
   if (!append) {
-    geom.clear_all();
-
+    vert_order.resize(verts.size(), -1);
     int i = 0;
     FORALLvertices
     {
       size_t idx = (vertex->point - points) / dim;
       vert_order[idx] = i++;
-      int v_idx = geom.add_vert(verts[idx]);
-      geom.colors(VERTS).set(v_idx, vcols[idx]);
+      hull_verts.push_back(verts[idx]);
+      hull_cols.push_back(geom.colors(VERTS).get(idx));
     }
   }
 
+  auto vert_idx = [&](const vertexT *vid) {
+    int idx = (vid->point - points) / dim;
+    return (append) ? idx : vert_order[idx];
+  };
+
   string message;
+  vector<vector<int>> hull_faces;
   facetT *facet;
   FORALLfacets
   {
@@ -123,10 +223,7 @@ static Status make_hull(Geometry &geom, bool append, string qh_args)
     int vid_i, vid_n;
     FOREACHsetelement_i_(qh, vertexT, facet->vertices, vid)
     {
-      if (!append)
-        face.push_back(vert_order[(vid->point - points) / dim]);
-      else
-        face.push_back((vid->point - points) / dim);
+      face.push_back(vert_idx(vid));
     }
     if (face.size() > 3) {
       // order the face vertices so joining them sequentially will
@@ -140,10 +237,7 @@ static Status make_hull(Geometry &geom, bool append, string qh_args)
         r_cnt++;
         FOREACHsetelement_i_(qh, vertexT, ridge->vertices, vid)
         {
-          if (!append)
-            lns.push_back(vert_order[(vid->point - points) / dim]);
-          else
-            lns.push_back((vid->point - points) / dim);
+          lns.push_back(vert_idx(vid));
         }
       }
 
@@ -173,20 +267,29 @@ static Status make_hull(Geometry &geom, bool append, string qh_args)
     else {
       ordered_face = face;
     }
-    int f_no = geom.add_face(ordered_face);
+    hull_faces.push_back(ordered_face);
+  }
+
+  cleanup();
+
+  if (!append) {
+    geom.clear_all();
+    for (unsigned int i = 0; i < hull_verts.size(); i++)
+      geom.add_vert(hull_verts[i], hull_cols[i]);
+  }
+
+  for (auto &face : hull_faces) {
+    int f_no = geom.add_face(face);
     if (vdot(geom.face_norm(f_no), geom.face_v(f_no, 0) - cent) <
         -anti::epsilon)
       reverse(geom.raw_faces()[f_no].begin(), geom.raw_faces()[f_no].end());
   }
 
-  qhull_cleanup(qh);
-  delete[] points;
-
   return (message.empty()) ? Status::ok() : Status::warning(message);
 }
 
-static int dimension_safe_make_hull(Geometry &geom, bool append, string qh_args,
-                                    Status *stat)
+int HullContext::dimension_safe_make_hull(Geometry &geom, bool append,
+                                          const string &qh_args, Status *stat)
 {
   // an empty geom should be the only reason an error can occur
   Status tmp;
@@ -335,7 +438,7 @@ static int dimension_safe_make_hull(Geometry &geom, bool append, string qh_args,
   return dimension;
 }
 
-Status add_hull(Geometry &geom, string qh_args, int *dim)
+Status HullContext::add_hull(Geometry &geom, const string &qh_args, int *dim)
 {
   Status stat;
   int ret = dimension_safe_make_hull(geom, true, qh_args, &stat);
@@ -345,7 +448,7 @@ Status add_hull(Geometry &geom, string qh_args, int *dim)
   return stat;
 }
 
-Status set_hull(Geometry &geom, string qh_args, int *dim)
+Status HullContext::set_hull(Geometry &geom, const string &qh_args, int *dim)
 {
   Status stat;
   int ret = dimension_safe_make_hull(geom, false, qh_args, &stat);
@@ -358,36 +461,14 @@ Status set_hull(Geometry &geom, string qh_args, int *dim)
   return stat;
 }
 
-Status get_delaunay_edges(const vector<Vec3d> &verts,
-                          map<pair<int, int>, int> &edges, string qh_args)
+Status HullContext::get_delaunay_edges(const vector<Vec3d> &verts,
+                                       map<pair<int, int>, int> &edges,
+                                       const string &qh_args)
 {
+  ANTI_PROFILE_SCOPE("delaunay");
   const int dim = 3;
-  auto *points = new coordT[verts.size() * dim];
-
-  for (unsigned i = 0; i < verts.size(); i++)
-    for (int j = 0; j < dim; j++)
-      points[i * dim + j] = verts[i][j];
-
-  qh_args.insert(0, "qhull d Qbb QJ o ");
-
-  boolT ismalloc = False;  // don't free points in qh_freeqhull() or realloc
-  FILE *outfile = nullptr; // suppress output from qh_produce_output()
-  FILE *errfile = fopen("/dev/null", "w"); // suppress qhull error messages
-  if (!errfile) {
-    errfile = fopen("nul", "w"); // try for windows cross compilation
-    if (!errfile)
-      errfile = stderr; // must be a valid pointer
-  }
-
-  qhT qh_val;
-  qhT *qh = &qh_val;
-  QHULL_LIB_CHECK
-  qh_zero(qh, errfile);
-
-  if (qh_new_qhull(qh, dim, verts.size(), points, ismalloc,
-                   (char *)qh_args.c_str(), outfile, errfile)) {
-    qhull_cleanup(qh);
-    delete[] points;
+  if (!run(verts, "qhull d Qbb QJ o " + qh_args)) {
+    cleanup();
     return Status::error("error calculating delaunay triangulation");
   }
 
@@ -427,8 +508,7 @@ Status get_delaunay_edges(const vector<Vec3d> &verts,
       }
   }
 
-  qhull_cleanup(qh);
-  delete[] points;
+  cleanup();
 
   return Status::ok();
 }
@@ -466,36 +546,13 @@ double get_min_vert_to_vert_dist(const vector<Vec3d> &verts, double sig_dist)
   return (min_sig_dist < 1e99) ? sqrt(min_sig_dist) : sig_dist;
 }
 
-Status get_voronoi_cells(const vector<Vec3d> &verts, vector<Geometry> *cells,
-                         string qh_args)
+Status HullContext::get_voronoi_cells(const vector<Vec3d> &verts,
+                                      vector<Geometry> *cells,
+                                      const string &qh_args)
 {
-  const int dim = 3;
-  auto *points = new coordT[verts.size() * dim];
-
-  for (unsigned i = 0; i < verts.size(); i++)
-    for (int j = 0; j < dim; j++)
-      points[i * dim + j] = verts[i][j];
-
-  qh_args.insert(0, "qhull v o ");
-
-  boolT ismalloc = False;  /* don't free points in qh_freeqhull() or realloc*/
-  FILE *outfile = nullptr; /* output from qh_produce_output()   nullptr ?*/
-  FILE *errfile = fopen("/dev/null", "w"); // suppress qhull error messages
-  if (!errfile) {
-    errfile = fopen("nul", "w"); // try for windows cross compilation
-    if (!errfile)
-      errfile = stderr; // must be a valid pointer
-  }
-
-  qhT qh_val;
-  qhT *qh = &qh_val;
-  QHULL_LIB_CHECK
-  qh_zero(qh, errfile);
-
-  if (qh_new_qhull(qh, dim, verts.size(), points, ismalloc,
-                   (char *)qh_args.c_str(), outfile, errfile)) {
-    qhull_cleanup(qh);
-    delete[] points;
+  ANTI_PROFILE_SCOPE("voronoi");
+  if (!run(verts, "qhull v o " + qh_args)) {
+    cleanup();
     return Status::error("error calculating voronoi cells");
   }
 
@@ -568,22 +625,85 @@ Status get_voronoi_cells(const vector<Vec3d> &verts, vector<Geometry> *cells,
           face.push_back(neighbor->visitid - 1);
       }
     }
-    if (face[0] >= 0)
+    if (face.size() && face[0] >= 0)
       vcells.add_face(face);
   }
   qh_settempfree(qh, &vertices);
 
-  qhull_cleanup(qh);
-  delete[] points;
+  cleanup();
 
-  for (unsigned int i = 0; i < vcells.faces().size(); i++) {
-    Geometry cell;
+  // the cells are independent, so calculate their hulls as a batch
+  vector<Geometry> new_cells(vcells.faces().size());
+  for (unsigned int i = 0; i < vcells.faces().size(); i++)
     for (unsigned int j = 0; j < vcells.faces(i).size(); j++)
-      cell.add_vert(vcells.face_v(i, j));
-    cell.add_hull();
-    cells->push_back(cell);
-  }
+      new_cells[i].add_vert(vcells.face_v(i, j));
+  add_hulls(new_cells);
+  cells->insert(cells->end(), new_cells.begin(), new_cells.end());
+
   return Status::ok();
 }
 
+// Each thread has its own context, which is kept for the life of the thread
+static HullContext &thread_hull_context()
+{
+  static thread_local HullContext context;
+  return context;
+}
+
+Status add_hull(Geometry &geom, string qh_args, int *dim)
+{
+  return thread_hull_context().add_hull(geom, qh_args, dim);
+}
+
+Status set_hull(Geometry &geom, string qh_args, int *dim)
+{
+  return thread_hull_context().set_hull(geom, qh_args, dim);
+}
+
+Status get_delaunay_edges(const vector<Vec3d> &verts,
+                          map<pair<int, int>, int> &edges, string qh_args)
+{
+  return thread_hull_context().get_delaunay_edges(verts, edges, qh_args);
+}
+
+Status get_voronoi_cells(const vector<Vec3d> &verts, vector<Geometry> *cells,
+                         string qh_args)
+{
+  return thread_hull_context().get_voronoi_cells(verts, cells, qh_args);
+}
+
+static Status make_hulls(vector<Geometry> &geoms, bool append,
+                         const string &qh_args, int num_threads)
+{
+  vector<Status> stats(geoms.size());
+  parallel_for(
+      geoms.size(),
+      [&](size_t i) {
+        HullContext &context = thread_hull_context();
+        stats[i] = (append) ? context.add_hull(geoms[i], qh_args)
+                            : context.set_hull(geoms[i], qh_args);
+      },
+      num_threads);
+
+  // report the first error, otherwise the first warning
+  for (int type = 0; type < 2; type++)
+    for (unsigned int i = 0; i < stats.size(); i++)
+      if ((type == 0) ? stats[i].is_error() : stats[i].is_warning())
+        return stats[i].add_prefix(msg_str("geometry %u: ", i));
+
+  return Status::ok();
+}
+
+Status add_hulls(vector<Geometry> &geoms, const string &qh_args,
+                 int num_threads)
+{
+  return make_hulls(geoms, true, qh_args, num_threads);
+}
+
+Status set_hulls(vector<Geometry> &geoms, const string &qh_args,
+                 int num_threads)
+{
+  return make_hulls(geoms, false, qh_args, num_threads);
+}
+
 } // namespace anti
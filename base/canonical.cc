@@ -30,6 +30,8 @@
 
 #include "boundbox.h"
 #include "geometryinfo.h"
+#include "profile.h"
+#include "relaxation.h"
 #include "utils.h"
 
 using std::string;
@@ -66,6 +68,7 @@ void update_base_from_ambo(Geometry &base, const Geometry &ambo)
 Status make_planar_unit(Geometry &base_geom, IterationControl it_ctrl,
                         double factor, double factor_max, Symmetry sym)
 {
+  ANTI_PROFILE_SCOPE("solve: planar unit");
   // chosen by experiment
   const double readjust_up = 1.01;    // to adjust adjustment factor up
   const double readjust_down = 0.995; // to adjust adjustment factor down
@@ -82,11 +85,9 @@ Status make_planar_unit(Geometry &base_geom, IterationControl it_ctrl,
   base_geom.transform(Trans3d::translate(base_geom.centroid()));
   sym.set_to_std(sym.get_to_std() * Trans3d::translate(initial_centroid));
 
-  bool using_symmetry = (sym.get_sym_type() > Symmetry::C1);
   auto fixed_subspace = sym.get_fixed_subspace(); // used to find centroid
-  SymmetricUpdater sym_updater((using_symmetry) ? base_geom : Geometry(), sym);
-  const Geometry &geom =
-      (using_symmetry) ? sym_updater.get_geom_working() : base_geom;
+  Relaxation relax(base_geom, sym);
+  const Geometry &geom = relax.get_geom();
 
   // No further processing if no faces, but not an error
   if (geom.faces().size() == 0)
@@ -119,54 +120,42 @@ Status make_planar_unit(Geometry &base_geom, IterationControl it_ctrl,
   }
 
   // Get a list of the faces that contain a principal vertex of any type
-  vector<int> principal_verts;  // first vertex in each vertex orbit
-  vector<int> verts_to_update;  // vertices accessed during iteration
-  vector<int> faces_to_process; // faces processed during iteration
-  if (using_symmetry) {
-    principal_verts = sym_updater.get_principal(VERTS);
-    faces_to_process = sym_updater.get_associated_elems(vert_faces);
-    verts_to_update =
-        SymmetricUpdater::get_included_verts(faces_to_process, geom.faces());
-    auto vfig_verts_to_update =
-        SymmetricUpdater::get_included_verts(principal_verts, vert_figs);
-    verts_to_update.insert(verts_to_update.end(), vfig_verts_to_update.begin(),
-                           vfig_verts_to_update.end());
-    SymmetricUpdater::to_unique_index_list(verts_to_update);
-  }
-  else { // not using_symmetry
-    principal_verts =
-        SymmetricUpdater::sequential_index_list(geom.verts().size());
-    faces_to_process =
-        SymmetricUpdater::sequential_index_list(geom.faces().size());
-  }
+  const vector<int> &principal_verts = relax.get_principal_verts();
+  vector<int> faces_to_process = // faces processed during iteration
+      relax.get_elems_to_process(vert_faces, faces.size());
+  // vertices accessed during iteration
+  relax.add_verts_to_update(
+      SymmetricUpdater::get_included_verts(faces_to_process, geom.faces()));
+  relax.add_verts_to_update(
+      SymmetricUpdater::get_included_verts(principal_verts, vert_figs));
 
   // Use oversized arrays to avoid mapping
   vector<Vec3d> offsets(verts.size()); // Vertex adjustments
+  vector<double> diffs2(verts.size()); // Vertex adjustments squared
   vector<Vec3d> norms(faces.size());   // Face normals
   vector<Vec3d> cents(faces.size());   // Face centroids
 
   double test_val = it_ctrl.get_test_val();
   double last_max_diff2 = 0.0;
-  for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
-    std::fill(offsets.begin(), offsets.end(), Vec3d::zero);
+  stat = relax.resume(it_ctrl, {&factor, &last_max_diff2});
+  if (stat.is_error())
+    return stat;
 
-    if (using_symmetry) {
-      // Ensure that the vertices used in adjustment are up to date
-      for (auto v_idx : verts_to_update)
-        sym_updater.update_from_principal_vertex(v_idx);
-    }
+  for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
+    // Ensure that the vertices used in adjustment are up to date
+    relax.update_verts();
 
     // Initialize face data for just the necessary faces
-    for (auto f_idx : faces_to_process) {
+    relax.for_each(faces_to_process, [&](int f_idx) {
       norms[f_idx] = geom.face_norm(f_idx).unit();
       cents[f_idx] = geom.face_cent(f_idx);
-    }
+    });
 
     Vec3d centroid = Vec3d::zero;
-    if (using_symmetry) {
+    if (relax.is_using_symmetry()) {
       // For each orbit, project a vertex weighted by the orbit size onto
       // the fixed subspace
-      const auto &vorbits = sym_updater.get_equiv_sets(VERTS);
+      const auto &vorbits = relax.get_vert_orbits();
       for (const auto &vorbit : vorbits)
         centroid += fixed_subspace.nearest_point(verts[*vorbit.begin()]) *
                     vorbit.size();
@@ -176,11 +165,11 @@ Status make_planar_unit(Geometry &base_geom, IterationControl it_ctrl,
       centroid = geom.centroid();
     }
 
-    double max_diff2 = 0.0;
-    for (auto v_idx : principal_verts) {
+    relax.for_each(principal_verts, [&](int v_idx) {
       const auto &vfaces = vert_faces[v_idx];
       const int vf_sz = vfaces.size();
       // target vertex is centroid of projection of vertex onto planes
+      offsets[v_idx] = Vec3d::zero;
       for (int f0 = 0; f0 < vf_sz; f0++) {
         int f0_idx = vfaces[f0];
         offsets[v_idx] +=
@@ -211,30 +200,21 @@ Status make_planar_unit(Geometry &base_geom, IterationControl it_ctrl,
         }
       }
 
-      auto diff2 = offsets[v_idx].len2();
-      if (diff2 > max_diff2)
-        max_diff2 = diff2;
-    }
+      diffs2[v_idx] = offsets[v_idx].len2();
+    });
 
-    // adjust vertices post-loop
-    if (using_symmetry) {
-      // adjust principal vertices
-      for (int v_idx : principal_verts) {
-        auto new_v = verts[v_idx] + offsets[v_idx];
-        double new_v_len = new_v.len();
-        new_v *= 1 + (1 / new_v_len - 1) * unit_mult;
-        sym_updater.update_principal_vertex(v_idx, new_v);
-      }
-    }
-    else { // not using_symmetry
-      // adjust all vertices
-      for (unsigned int i = 0; i < verts.size(); i++) {
-        auto new_v = verts[i] + offsets[i];
-        double new_v_len = new_v.len();
-        new_v *= 1 + (1 / new_v_len - 1) * unit_mult;
-        base_geom.raw_verts()[i] = new_v;
-      }
-    }
+    double max_diff2 = 0.0;
+    for (auto v_idx : principal_verts)
+      if (diffs2[v_idx] > max_diff2)
+        max_diff2 = diffs2[v_idx];
+
+    // adjust principal vertices post-loop, or all without symmetry
+    relax.move_verts([&](int v_idx) {
+      auto new_v = verts[v_idx] + offsets[v_idx];
+      double new_v_len = new_v.len();
+      new_v *= 1 + (1 / new_v_len - 1) * unit_mult;
+      return new_v;
+    });
 
     // adjust plane factor
     if (max_diff2 < last_max_diff2)
@@ -247,19 +227,17 @@ Status make_planar_unit(Geometry &base_geom, IterationControl it_ctrl,
 
     string finish_msg;
     if (it_ctrl.is_status_check_iter()) {
-      sym_updater.update_all();
+      relax.update_all_verts();
       double width = BoundBox(verts).max_width();
-      if (sqrt(max_diff2) / width < test_val) {
-        it_ctrl.set_finished();
-        finish_msg = "solved, test value achieved";
-        stat.set_ok(finish_msg);
-      }
-      else if (it_ctrl.is_last_iter()) {
-        // reached last iteration without solving
-        it_ctrl.set_finished();
-        finish_msg = "not solved, test value not achieved";
-        stat.set_warning(finish_msg);
+      bool solved = (sqrt(max_diff2) / width < test_val);
+      Status fin_stat = it_ctrl.check_solved(solved);
+      if (it_ctrl.is_finished()) {
+        finish_msg = fin_stat.msg();
+        stat = fin_stat;
       }
+      it_ctrl.record(sqrt(max_diff2) / width,
+                     {{"max_diff", sqrt(max_diff2)}, {"factor", 100 * factor}},
+                     finish_msg);
     }
 
     if (it_ctrl.is_status_report_iter()) {
@@ -269,10 +247,12 @@ Status make_planar_unit(Geometry &base_geom, IterationControl it_ctrl,
       it_ctrl.print("%-12u max_diff:%17.15e  -f %-10.5f\n",
                     it_ctrl.get_current_iter(), sqrt(max_diff2), 100 * factor);
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      relax.checkpoint(it_ctrl, {factor, last_max_diff2});
   }
 
-  if (using_symmetry)
-    base_geom = sym_updater.get_geom_final();
+  relax.finish();
 
   return stat;
 }
@@ -293,18 +273,17 @@ Status make_canonical(Geometry &geom, IterationControl it_ctrl, double factor,
 Status make_planar(Geometry &base_geom, IterationControl it_ctrl,
                    double plane_factor, const Symmetry &sym)
 {
+  ANTI_PROFILE_SCOPE("solve: planar");
   // chosen by experiment
   const double intersect_test_val = 1e-5; // test for coplanar faces
   const double diff2_test_val = 10;       // limit for using plane intersection
   const double readjustment = 1.01;       // to adjust adjustment factor
   const double plane_factor_max = 1.1;    // maximum value for adjustment factor
-  bool using_symmetry = (sym.get_sym_type() > Symmetry::C1);
 
   Status stat;
 
-  SymmetricUpdater sym_updater((using_symmetry) ? base_geom : Geometry(), sym);
-  const Geometry &geom =
-      (using_symmetry) ? sym_updater.get_geom_working() : base_geom;
+  Relaxation relax(base_geom, sym);
+  const Geometry &geom = relax.get_geom();
 
   // No further processing if no faces, but not an error
   if (geom.faces().size() == 0)
@@ -318,52 +297,42 @@ Status make_planar(Geometry &base_geom, IterationControl it_ctrl,
   const auto &vert_faces = info.get_vert_faces();
 
   // Get a list of the faces that contain a principal vertex of any type
-  vector<int> principal_verts;  // first vertex in each vertex orbit
-  vector<int> verts_to_update;  // vertices accessed during iteration
-  vector<int> faces_to_process; // faces processed during iteration
-  if (using_symmetry) {
-    principal_verts = sym_updater.get_principal(VERTS);
-    faces_to_process = sym_updater.get_associated_elems(vert_faces);
-    verts_to_update =
-        SymmetricUpdater::get_included_verts(faces_to_process, geom.faces());
-  }
-  else { // not using_symmetry
-    principal_verts =
-        SymmetricUpdater::sequential_index_list(geom.verts().size());
-    faces_to_process =
-        SymmetricUpdater::sequential_index_list(geom.faces().size());
-  }
+  const vector<int> &principal_verts = relax.get_principal_verts();
+  vector<int> faces_to_process = // faces processed during iteration
+      relax.get_elems_to_process(vert_faces, faces.size());
+  // vertices accessed during iteration
+  relax.add_verts_to_update(
+      SymmetricUpdater::get_included_verts(faces_to_process, geom.faces()));
 
   // Use oversized arrays to avoid mapping
-  vector<Vec3d> offsets(verts.size()); // Vertex adjustments
-  vector<Vec3d> norms(faces.size());   // Face normals
-  vector<Vec3d> cents(faces.size());   // Face centroids
+  vector<Vec3d> offsets(verts.size());  // Vertex adjustments
+  vector<double> diffs2(verts.size());  // Vertex adjustments squared
+  vector<char> projected(verts.size()); // Vertex projected onto planes
+  vector<Vec3d> norms(faces.size());    // Face normals
+  vector<Vec3d> cents(faces.size());    // Face centroids
 
   double test_val = it_ctrl.get_test_val();
   double last_max_diff2 = 0.0;
-  for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
-    std::fill(offsets.begin(), offsets.end(), Vec3d::zero);
+  stat = relax.resume(it_ctrl, {&plane_factor, &last_max_diff2});
+  if (stat.is_error())
+    return stat;
 
-    if (using_symmetry) {
-      // Ensure that the vertices used in adjustment are up to date
-      for (auto v_idx : verts_to_update)
-        sym_updater.update_from_principal_vertex(v_idx);
-    }
+  for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
+    // Ensure that the vertices used in adjustment are up to date
+    relax.update_verts();
 
     // Initialize face data for just the necessary faces
-    for (auto f_idx : faces_to_process) {
+    relax.for_each(faces_to_process, [&](int f_idx) {
       norms[f_idx] = geom.face_norm(f_idx).unit();
       cents[f_idx] = geom.face_cent(f_idx);
-    }
+    });
 
-    int cnt_proj = 0;
-    int cnt_int = 0;
-    double max_diff2 = 0.0;
-    for (auto v_idx : principal_verts) {
+    relax.for_each(principal_verts, [&](int v_idx) {
       int intersect_cnt = 0;
       const auto &vfaces = vert_faces[v_idx];
       const int vf_sz = vfaces.size();
       bool good_intersections = (vf_sz >= 3);
+      offsets[v_idx] = Vec3d::zero;
       for (int f0 = 0; f0 < vf_sz - 2 && good_intersections; f0++) {
         int f0_idx = vfaces[f0];
         for (int f1 = f0 + 1; f1 < vf_sz - 1 && good_intersections; f1++) {
@@ -396,29 +365,29 @@ Status make_planar(Geometry &base_geom, IterationControl it_ctrl,
               nearpoint_on_plane(verts[v_idx], cents[f0_idx], norms[f0_idx]);
         }
         offsets[v_idx] = (offsets[v_idx] / vf_sz - verts[v_idx]) * plane_factor;
-        cnt_proj++;
+        projected[v_idx] = true;
       }
       else
-        cnt_int++;
+        projected[v_idx] = false;
 
-      auto diff2 = offsets[v_idx].len2();
-      if (diff2 > max_diff2)
-        max_diff2 = diff2;
-    }
+      diffs2[v_idx] = offsets[v_idx].len2();
+    });
 
-    // adjust vertices post-loop
-    if (using_symmetry) {
-      // adjust principal vertices
-      for (int v_idx : principal_verts)
-        sym_updater.update_principal_vertex(v_idx,
-                                            verts[v_idx] + offsets[v_idx]);
-    }
-    else { // not using_symmetry
-      // adjust all vertices
-      for (unsigned int i = 0; i < verts.size(); i++)
-        base_geom.raw_verts()[i] += offsets[i];
+    int cnt_proj = 0;
+    int cnt_int = 0;
+    double max_diff2 = 0.0;
+    for (auto v_idx : principal_verts) {
+      if (projected[v_idx])
+        cnt_proj++;
+      else
+        cnt_int++;
+      if (diffs2[v_idx] > max_diff2)
+        max_diff2 = diffs2[v_idx];
     }
 
+    // adjust principal vertices post-loop, or all without symmetry
+    relax.move_verts([&](int v_idx) { return verts[v_idx] + offsets[v_idx]; });
+
     // adjust plane factor
     if (max_diff2 < last_max_diff2)
       plane_factor *= readjustment;
@@ -431,17 +400,18 @@ Status make_planar(Geometry &base_geom, IterationControl it_ctrl,
     string finish_msg;
     if (it_ctrl.is_status_check_iter()) {
       double width = BoundBox(verts).max_width();
-      if (sqrt(max_diff2) / width < test_val) {
-        it_ctrl.set_finished();
-        finish_msg = "solved, test value achieved";
-        stat.set_ok(finish_msg);
-      }
-      else if (it_ctrl.is_last_iter()) {
-        // reached last iteration without solving
-        it_ctrl.set_finished();
-        finish_msg = "not solved, test value not achieved";
-        stat.set_warning(finish_msg);
+      bool solved = (sqrt(max_diff2) / width < test_val);
+      Status fin_stat = it_ctrl.check_solved(solved);
+      if (it_ctrl.is_finished()) {
+        finish_msg = fin_stat.msg();
+        stat = fin_stat;
       }
+      it_ctrl.record(sqrt(max_diff2) / width,
+                     {{"max_diff", sqrt(max_diff2)},
+                      {"factor", 100 * plane_factor},
+                      {"intersect", cnt_int},
+                      {"project", cnt_proj}},
+                     finish_msg);
     }
 
     if (it_ctrl.is_status_report_iter()) {
@@ -452,10 +422,12 @@ Status make_planar(Geometry &base_geom, IterationControl it_ctrl,
                     it_ctrl.get_current_iter(), sqrt(max_diff2),
                     100 * plane_factor, cnt_int, cnt_proj);
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      relax.checkpoint(it_ctrl, {plane_factor, last_max_diff2});
   }
 
-  if (using_symmetry)
-    base_geom = sym_updater.get_geom_final();
+  relax.finish();
 
   return stat;
 }
@@ -30,11 +30,14 @@
 #include "displaypoly.h"
 #include "mathutils.h"
 #include "povwriter.h"
+#include "rasterwriter.h"
 #include "scene.h"
 #include "symmetry.h"
+#include "textwriter.h"
 #include "utils.h"
 #include "vrmlwriter.h"
 
+#include <algorithm>
 #include <cstring>
 #include <map>
 #include <set>
@@ -50,7 +53,7 @@ namespace anti {
 
 DisplayPoly::DisplayPoly()
     : triangulate(true), winding_rule(TESS_WINDING_NONZERO), face_alpha(-1),
-      use_lines(false)
+      use_lines(false), instanced(false)
 {
 }
 
@@ -278,46 +281,164 @@ void DisplayPoly::vrml_protos(FILE *ofile)
 
 void DisplayPoly::vrml_coords(FILE *ofile, int sig_digits)
 {
-  fprintf(ofile, "# Vertex Coordinates\n");
-  fprintf(ofile, "Shape {\n"
-                 "   geometry IndexedFaceSet {\n"
-                 "      coord DEF CRDS Coordinate {\n"
-                 "         point [\n");
+  TextWriter out(ofile);
+  out.put("# Vertex Coordinates\n");
+  out.put("Shape {\n"
+          "   geometry IndexedFaceSet {\n"
+          "      coord DEF CRDS Coordinate {\n"
+          "         point [\n");
 
   const vector<Vec3d> &vs = disp_geom.verts();
-  if (vs.size()) {
-    for (unsigned int i = 0; i < vs.size() - 1; i++)
-      fprintf(ofile, "\t%s,\n", vrml_vec(vs[i], sig_digits).c_str());
-    fprintf(ofile, "\t%s\n", vrml_vec(vs[vs.size() - 1], sig_digits).c_str());
+  for (unsigned int i = 0; i < vs.size(); i++) {
+    out.put('\t');
+    vrml_vec(out, vs[i], sig_digits);
+    out.put((i < vs.size() - 1) ? ",\n" : "\n");
   }
 
-  fprintf(ofile, "         ]\n"
-                 "      }\n"
-                 "   }\n"
-                 "}\n\n");
+  out.put("         ]\n"
+          "      }\n"
+          "   }\n"
+          "}\n\n");
 }
 
 void DisplayPoly::vrml_verts(FILE *ofile, int sig_digits)
 {
-  fprintf(ofile, "# Vertex elements\n");
+  TextWriter out(ofile);
+  out.put("# Vertex elements\n");
 
+  const string name = dots2underscores(sc_geom->get_name());
   const vector<Vec3d> &vs = disp_geom.verts();
+  const auto &v_cols = disp_geom.colors(VERTS);
   for (unsigned int i = 0; i < sc_geom->get_geom().verts().size(); i++) {
-    if (disp_geom.colors(VERTS).get(i).is_invisible())
+    Color col = v_cols.get(i);
+    if (col.is_invisible())
       continue;
-    fprintf(ofile, "V_%s { C %s ",
-            dots2underscores(sc_geom->get_name()).c_str(),
-            vrml_vec(vs[i], sig_digits).c_str());
-    Color col = disp_geom.colors(VERTS).get(i);
+    out.put("V_").put(name).put(" { C ");
+    vrml_vec(out, vs[i], sig_digits);
+    out.put(' ');
     if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
-    if (col.is_value())
-      fprintf(ofile, "clr %s trn %.4f", vrml_col(col).c_str(),
-              col.get_transparency_d());
-    fprintf(ofile, "}\n");
+      col = clrngs[VERTS].get_col(col.get_index());
+    if (col.is_value()) {
+      out.put("clr ");
+      vrml_col(out, col);
+      out.put(" trn ").put_double(col.get_transparency_d(), -4);
+    }
+    out.put("}\n");
   }
 
-  fprintf(ofile, "\n\n\n");
+  out.put("\n\n\n");
+}
+
+// Group the visible elements by their display colour
+static map<Color, vector<int>> elems_by_color(const Geometry &geom, int type,
+                                             int num_elems,
+                                             const Coloring &clrng,
+                                             Color def_col)
+{
+  map<Color, vector<int>> col_elems;
+  for (int i = 0; i < num_elems; i++) {
+    Color col = geom.colors(type).get(i);
+    if (col.is_index())
+      col = clrng.get_col(col.get_index());
+    if (!col.is_value())
+      col = def_col; // use default
+    if (col.is_invisible())
+      continue;
+    col_elems[col].push_back(i);
+  }
+  return col_elems;
+}
+
+// Colour groups smaller than this don't repay the size of their own PROTO
+static const size_t vrml_min_group_sz = 16;
+
+// Write a PROTO for each large colour group, with the colour and
+// transparency fixed, so that the element instances only give their position
+static void vrml_group_protos(TextWriter &out, const string &name,
+                              const map<Color, vector<int>> &col_elems,
+                              const char *fields, const char *trans,
+                              const string &geometry)
+{
+  int grp = 0;
+  for (const auto &kp : col_elems) {
+    if (kp.second.size() < vrml_min_group_sz)
+      continue;
+    out.put("\nPROTO ").put(name).put('_').put_int(grp++).put(" [\n");
+    out.put(fields);
+    out.put("]\n"
+            "{\n"
+            "   Transform {\n")
+        .put(trans);
+    out.put("      children [\n"
+            "         Shape {\n"
+            "            appearance Appearance {\n"
+            "               material Material {\n"
+            "                  diffuseColor ");
+    vrml_col(out, kp.first);
+    out.put("\n                  transparency ");
+    out.put_double(kp.first.get_transparency_d(), -4);
+    out.put("\n               }\n"
+            "            }\n"
+            "            geometry ")
+        .put(geometry);
+    out.put("\n         }\n"
+            "      ]\n"
+            "   }\n"
+            "}\n");
+  }
+  out.put('\n');
+}
+
+// Start an element instance, using the PROTO of its colour group if it has
+// one, otherwise the general PROTO
+static void vrml_inst_begin(TextWriter &out, const string &name,
+                            bool own_proto, int grp)
+{
+  out.put(name);
+  if (own_proto)
+    out.put('_').put_int(grp);
+  out.put(" { C ");
+}
+
+// Finish an element instance, giving its colour if it uses the general PROTO
+static void vrml_inst_end(TextWriter &out, const Color &col, bool own_proto)
+{
+  if (!own_proto) {
+    out.put(" clr ");
+    vrml_col(out, col);
+    out.put(" trn ").put_double(col.get_transparency_d(), -4);
+  }
+  out.put(" }\n");
+}
+
+void DisplayPoly::vrml_verts_inst(FILE *ofile, int sig_digits)
+{
+  TextWriter out(ofile);
+  out.put("# Vertex elements\n");
+
+  const auto col_elems =
+      elems_by_color(disp_geom, VERTS, sc_geom->get_geom().verts().size(),
+                     clrngs[VERTS], def_col(VERTS));
+  const string name =
+      "V" + get_id_label() + "_" + dots2underscores(sc_geom->get_name());
+  vrml_group_protos(out, name, col_elems,
+                    "   field SFVec3f C 0 0 0    # centre\n",
+                    "      translation IS C\n",
+                    msg_str("Sphere { radius %g }", get_vert_rad()));
+
+  const vector<Vec3d> &vs = disp_geom.verts();
+  int grp = 0;
+  for (const auto &kp : col_elems) {
+    const bool own_proto = kp.second.size() >= vrml_min_group_sz;
+    for (int idx : kp.second) {
+      vrml_inst_begin(out, name, own_proto, grp);
+      vrml_vec(out, vs[idx], sig_digits);
+      vrml_inst_end(out, kp.first, own_proto);
+    }
+    grp += own_proto;
+  }
+
+  out.put("\n\n\n");
 }
 
 void DisplayPoly::vrml_verts_l(FILE *ofile)
@@ -343,13 +464,16 @@ void DisplayPoly::vrml_verts_l(FILE *ofile)
 
 void DisplayPoly::vrml_edges(FILE *ofile)
 {
+  TextWriter out(ofile);
+  out.put("# Edge elements\n");
 
-  fprintf(ofile, "# Edge elements\n");
-
+  const string name = dots2underscores(sc_geom->get_name());
   const vector<Vec3d> &vs = disp_geom.verts();
   const vector<vector<int>> &es = disp_geom.edges();
+  const auto &e_cols = disp_geom.colors(EDGES);
   for (unsigned int i = 0; i < es.size(); i++) {
-    if (disp_geom.colors(EDGES).get((int)i).is_invisible())
+    Color col = e_cols.get((int)i);
+    if (col.is_invisible())
       continue;
     Vec3d mid = (vs[es[i][0]] + vs[es[i][1]]) / 2.0;
     Vec3d dir = vs[es[i][0]] - vs[es[i][1]];
@@ -357,68 +481,121 @@ void DisplayPoly::vrml_edges(FILE *ofile)
     dir /= ht;                                 // to unit
     double ang = -acos(safe_for_trig(dir[1])); // angle between dir and y-axis
     Vec3d axis = vcross(dir, Vec3d(0, 1, 0)).unit(); // axis
-    fprintf(ofile, "E_%s { C %s R %s %g\n\t  ht %g ",
-            dots2underscores(sc_geom->get_name()).c_str(),
-            vrml_vec(mid, 8 /*sig_digits*/).c_str(),
-            vrml_vec(axis, 8 /*sig_digits*/).c_str(), ang, ht);
+    out.put("E_").put(name).put(" { C ");
+    vrml_vec(out, mid, 8 /*sig_digits*/);
+    out.put(" R ");
+    vrml_vec(out, axis, 8 /*sig_digits*/);
+    out.put(' ').put_double(ang, 6);
+    out.put("\n\t  ht ").put_double(ht, 6).put(' ');
 
-    Color col = disp_geom.colors(EDGES).get((int)i);
     if (col.is_index())
-      col = clrng(EDGES).get_col(col.get_index());
-    if (col.is_value())
-      fprintf(ofile, "clr %s trn %.4f", vrml_col(col).c_str(),
-              col.get_transparency_d());
-    fprintf(ofile, "}\n");
+      col = clrngs[EDGES].get_col(col.get_index());
+    if (col.is_value()) {
+      out.put("clr ");
+      vrml_col(out, col);
+      out.put(" trn ").put_double(col.get_transparency_d(), -4);
+    }
+    out.put("}\n");
   }
 
-  fprintf(ofile, "\n\n\n");
+  out.put("\n\n\n");
+}
+
+void DisplayPoly::vrml_edges_inst(FILE *ofile)
+{
+  TextWriter out(ofile);
+  out.put("# Edge elements\n");
+
+  const vector<Vec3d> &vs = disp_geom.verts();
+  const vector<vector<int>> &es = disp_geom.edges();
+  const auto col_elems = elems_by_color(disp_geom, EDGES, es.size(),
+                                        clrngs[EDGES], def_col(EDGES));
+  const string name =
+      "E" + get_id_label() + "_" + dots2underscores(sc_geom->get_name());
+  vrml_group_protos(out, name, col_elems,
+                    "   field SFVec3f C 0 0 0     # centre\n"
+                    "   field SFRotation R 1 0 0 0     # rotation\n"
+                    "   field SFFloat ht 1   # height\n",
+                    "      translation IS C\n"
+                    "      rotation IS R\n",
+                    msg_str("Cylinder { radius %g height IS ht }",
+                            get_edge_rad()));
+
+  int grp = 0;
+  for (const auto &kp : col_elems) {
+    const bool own_proto = kp.second.size() >= vrml_min_group_sz;
+    for (int idx : kp.second) {
+      const vector<int> &e = es[idx];
+      Vec3d mid = (vs[e[0]] + vs[e[1]]) / 2.0;
+      Vec3d dir = vs[e[0]] - vs[e[1]];
+      double ht = dir.len();
+      dir /= ht;                                 // to unit
+      double ang = -acos(safe_for_trig(dir[1])); // angle to y-axis
+      Vec3d axis = vcross(dir, Vec3d(0, 1, 0)).unit();
+      vrml_inst_begin(out, name, own_proto, grp);
+      vrml_vec(out, mid, 8);
+      out.put(" R ");
+      vrml_vec(out, axis, 8);
+      out.put(' ').put_double(ang, 6);
+      out.put(" ht ").put_double(ht, 6);
+      vrml_inst_end(out, kp.first, own_proto);
+    }
+    grp += own_proto;
+  }
+
+  out.put("\n\n\n");
 }
 
 void DisplayPoly::vrml_edges_l(FILE *ofile)
 {
-  fprintf(ofile, "# Edge elements\n");
-  fprintf(ofile,
-          "Shape {\n"
-          "   appearance Appearance {\n"
-          "      material Material {\n"
-          "         emissiveColor %s\n"
-          "      }\n"
-          "   }\n",
-          vrml_col(def_col(EDGES)).c_str());
-  fprintf(ofile, "   geometry IndexedLineSet {\n"
-                 "      colorPerVertex FALSE\n"
-                 "      coord USE CRDS\n"
-                 "      coordIndex [\n");
+  TextWriter out(ofile);
+  out.put("# Edge elements\n");
+  out.printf("Shape {\n"
+             "   appearance Appearance {\n"
+             "      material Material {\n"
+             "         emissiveColor %s\n"
+             "      }\n"
+             "   }\n",
+             vrml_col(def_col(EDGES)).c_str());
+  out.put("   geometry IndexedLineSet {\n"
+          "      colorPerVertex FALSE\n"
+          "      coord USE CRDS\n"
+          "      coordIndex [\n");
 
   const vector<vector<int>> &es = disp_geom.edges();
+  const auto &e_cols = disp_geom.colors(EDGES);
   for (unsigned int i = 0; i < es.size(); i++) {
-    if (!disp_geom.colors(EDGES).get((int)i).is_invisible()) {
-      fprintf(ofile, "%d %d -1  ", es[i][0], es[i][1]);
+    if (!e_cols.get((int)i).is_invisible()) {
+      out.put_int(es[i][0]).put(' ').put_int(es[i][1]).put(" -1  ");
       if (!(i % 6))
-        fprintf(ofile, "\n");
+        out.put('\n');
     }
   }
-  fprintf(ofile, "      ]\n"
-                 "   }\n"
-                 "}\n");
+  out.put("      ]\n"
+          "   }\n"
+          "}\n");
 
-  fprintf(ofile, "\n\n\n");
+  out.put("\n\n\n");
 }
 
 void DisplayPoly::vrml_faces(FILE *ofile)
 {
-  fprintf(ofile, "# Face elements\n");
+  TextWriter out(ofile);
+  out.put("# Face elements\n");
 
   map<int, vector<int>> f_alpha;
   const vector<vector<int>> &fs = disp_geom.faces();
+  const auto &f_cols = disp_geom.colors(FACES);
+  vector<Color> cols(fs.size());
   for (unsigned int i = 0; i < fs.size(); i++) {
     if (fs[i].size() < 3) // skip degenerate polygons
       continue;
     int alpha = -1;
 
-    Color col = disp_geom.colors(FACES).get((int)i);
+    Color &col = cols[i];
+    col = f_cols.get((int)i);
     if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
+      col = clrngs[FACES].get_col(col.get_index());
     if (col.is_invisible())
       continue;
     if (col.is_value())
@@ -426,41 +603,35 @@ void DisplayPoly::vrml_faces(FILE *ofile)
     f_alpha[alpha].push_back(i);
   }
 
-  map<int, vector<int>>::iterator mi;
-  for (mi = f_alpha.begin(); mi != f_alpha.end(); mi++) {
-    fprintf(ofile, "F%s_%s { vc USE CRDS ci [ ", mi->first < 0 ? "0" : "",
-            dots2underscores(sc_geom->get_name()).c_str());
+  const string name = dots2underscores(sc_geom->get_name());
+  for (const auto &kp : f_alpha) {
+    out.put('F').put(kp.first < 0 ? "0" : "").put('_').put(name);
+    out.put(" { vc USE CRDS ci [ ");
     int f_cnt = 0;
-    for (int idx : mi->second) {
-      if (fs[idx].size() < 3) // skip digons
-        continue;
+    for (int idx : kp.second) {
       for (int j : fs[idx])
-        fprintf(ofile, "%d ", j);
-      fprintf(ofile, "-1  ");
+        out.put_int(j).put(' ');
+      out.put("-1  ");
       if (!((++f_cnt) % 4))
-        fprintf(ofile, "\n");
+        out.put('\n');
     }
-    fprintf(ofile, "   ]\n\t");
-    if (mi->first >= 0) {
-      fprintf(ofile, "clrs [ ");
+    out.put("   ]\n\t");
+    if (kp.first >= 0) {
+      out.put("clrs [ ");
       f_cnt = 0;
-      for (int idx : mi->second) {
-        if (fs[idx].size() < 3) // skip degenerate polygons
-          continue;
-        Color col = disp_geom.colors(FACES).get((int)idx);
-        if (col.is_index())
-          col = clrng(FACES).get_col(col.get_index());
-        fprintf(ofile, "%s, ", vrml_col(col).c_str());
+      for (int idx : kp.second) {
+        vrml_col(out, cols[idx]);
+        out.put(", ");
         if (!((++f_cnt) % 3))
-          fprintf(ofile, "\n\t");
+          out.put("\n\t");
       }
-      fprintf(ofile, " %s", "0 0 0 ]"); // dummy color for the last ','
-      fprintf(ofile, " trn %.4f", 1 - Color::i2f(mi->first));
+      out.put(" 0 0 0 ]"); // dummy color for the last ','
+      out.put(" trn ").put_double(1 - Color::i2f(kp.first), -4);
     }
-    fprintf(ofile, " }\n");
+    out.put(" }\n");
   }
 
-  fprintf(ofile, "\n\n\n");
+  out.put("\n\n\n");
 }
 
 void DisplayPoly::vrml_geom(FILE *ofile, const Scene &scen, int sig_digits)
@@ -476,12 +647,16 @@ void DisplayPoly::vrml_geom(FILE *ofile, const Scene &scen, int sig_digits)
   if (elem(VERTS).get_show()) {
     if (use_lines)
       vrml_verts_l(ofile);
+    else if (instanced)
+      vrml_verts_inst(ofile, sig_digits);
     else
       vrml_verts(ofile, sig_digits);
   }
   if (elem(EDGES).get_show()) {
     if (use_lines)
       vrml_edges_l(ofile);
+    else if (instanced)
+      vrml_edges_inst(ofile);
     else
       vrml_edges(ofile);
   }
@@ -582,99 +757,122 @@ void DisplayPoly::pov_include_files(FILE *ofile)
 
 void DisplayPoly::pov_vert_arrays(FILE *ofile, int sig_digits)
 {
+  TextWriter out(ofile);
   const vector<Vec3d> &vs = disp_geom.verts();
-  fprintf(ofile,
-          "// Array of vertex coordinates\n"
-          "#declare num_verts = %lu;\n",
-          (unsigned long)vs.size());
+  out.printf("// Array of vertex coordinates\n"
+             "#declare num_verts = %lu;\n",
+             (unsigned long)vs.size());
 
   if (!vs.size())
     return;
 
-  fprintf(ofile, "#declare verts = array [num_verts] {\n");
-  for (unsigned int i = 0; i < vs.size(); i++)
-    fprintf(ofile, "   %s%s", pov_vec(vs[i], sig_digits).c_str(),
-            (i < vs.size() - 1) ? ",\n" : "");
-  fprintf(ofile, "\n}\n\n");
-
-  fprintf(ofile, "// Array of vertex colours\n"
-                 "#declare v_cols = array [num_verts]\n");
+  out.put("#declare verts = array [num_verts] {\n");
   for (unsigned int i = 0; i < vs.size(); i++) {
-    Color col = disp_geom.colors(VERTS).get((int)i);
-    if (col.is_index())
-      col = clrng(VERTS).get_col(col.get_index());
-    if (col.is_set())
-      fprintf(ofile, "#declare v_cols[%d]=%s;\n", i, pov_col(col).c_str());
+    out.put("   ");
+    pov_vec(out, vs[i], sig_digits);
+    out.put((i < vs.size() - 1) ? ",\n" : "");
+  }
+  out.put("\n}\n\n");
+
+  out.put("// Array of vertex colours\n"
+          "#declare v_cols = array [num_verts]\n");
+  const auto &v_cols = disp_geom.colors(VERTS);
+  // grouped elements give the colour of each group in the object
+  if (!instanced) {
+    for (unsigned int i = 0; i < vs.size(); i++) {
+      Color col = v_cols.get((int)i);
+      if (col.is_index())
+        col = clrngs[VERTS].get_col(col.get_index());
+      if (col.is_set()) {
+        out.put("#declare v_cols[").put_int(i).put("]=");
+        pov_col(out, col);
+        out.put(";\n");
+      }
+    }
   }
 
-  fprintf(ofile, "\n\n\n");
+  out.put("\n\n\n");
 }
 
 void DisplayPoly::pov_edge_arrays(FILE *ofile)
 {
+  TextWriter out(ofile);
   const vector<vector<int>> &es = disp_geom.edges();
-  fprintf(ofile,
-          "// Array of edge indexes\n"
-          "#declare num_edges = %lu;\n",
-          (unsigned long)es.size());
+  out.printf("// Array of edge indexes\n"
+             "#declare num_edges = %lu;\n",
+             (unsigned long)es.size());
   if (!es.size())
     return;
 
-  fprintf(ofile, "#declare edges = array [num_edges][2] {\n");
-  for (unsigned int i = 0; i < es.size(); i++)
-    fprintf(ofile, "   {%d, %d}%s", es[i][0], es[i][1],
-            (i < es.size() - 1) ? ",\n" : "");
-  fprintf(ofile, "\n}\n\n");
-
-  fprintf(ofile, "// Array of edge colours\n"
-                 "#declare e_cols = array [num_edges]\n");
+  out.put("#declare edges = array [num_edges][2] {\n");
   for (unsigned int i = 0; i < es.size(); i++) {
-    Color col = disp_geom.colors(EDGES).get((int)i);
-    if (col.is_index())
-      col = clrng(EDGES).get_col(col.get_index());
-    if (col.is_set())
-      fprintf(ofile, "#declare e_cols[%d]=%s;\n", i, pov_col(col).c_str());
+    out.put("   {").put_int(es[i][0]).put(", ").put_int(es[i][1]).put('}');
+    out.put((i < es.size() - 1) ? ",\n" : "");
+  }
+  out.put("\n}\n\n");
+
+  out.put("// Array of edge colours\n"
+          "#declare e_cols = array [num_edges]\n");
+  const auto &e_cols = disp_geom.colors(EDGES);
+  // grouped elements give the colour of each group in the object
+  if (!instanced) {
+    for (unsigned int i = 0; i < es.size(); i++) {
+      Color col = e_cols.get((int)i);
+      if (col.is_index())
+        col = clrngs[EDGES].get_col(col.get_index());
+      if (col.is_set()) {
+        out.put("#declare e_cols[").put_int(i).put("]=");
+        pov_col(out, col);
+        out.put(";\n");
+      }
+    }
   }
 
-  fprintf(ofile, "\n\n\n");
+  out.put("\n\n\n");
 }
 
 void DisplayPoly::pov_face_arrays(FILE *ofile)
 {
+  TextWriter out(ofile);
   const vector<vector<int>> &fs = disp_geom.faces();
 
   int num_face_items = 0;
   for (const auto &f : fs)
     num_face_items += f.size() + 1; // add 1 for the numper of points
 
-  fprintf(ofile,
-          "// Array of face vertex counts and indexes\n"
-          "#declare num_faces = %lu;\n"
-          "#declare num_face_items = %d;\n",
-          (unsigned long)fs.size(), num_face_items);
+  out.printf("// Array of face vertex counts and indexes\n"
+             "#declare num_faces = %lu;\n"
+             "#declare num_face_items = %d;\n",
+             (unsigned long)fs.size(), num_face_items);
   if (!fs.size())
     return;
-  fprintf(ofile, "#declare faces = array [num_face_items] {");
+  out.put("#declare faces = array [num_face_items] {");
   for (unsigned int i = 0; i < fs.size(); i++) {
-    fprintf(ofile, "\n   %lu, ", (unsigned long)fs[i].size());
-    for (unsigned int j = 0; j < fs[i].size(); j++)
-      fprintf(ofile, "%d%s", fs[i][j],
-              ((i == fs.size() - 1) && (j == fs[i].size() - 1)) ? "" : ", ");
+    out.put("\n   ").put_int(fs[i].size()).put(", ");
+    for (unsigned int j = 0; j < fs[i].size(); j++) {
+      out.put_int(fs[i][j]);
+      if ((i < fs.size() - 1) || (j < fs[i].size() - 1))
+        out.put(", ");
+    }
   }
 
-  fprintf(ofile, "\n}\n\n");
+  out.put("\n}\n\n");
 
-  fprintf(ofile, "// Array of face colours\n"
-                 "#declare f_cols = array [num_faces]\n");
+  out.put("// Array of face colours\n"
+          "#declare f_cols = array [num_faces]\n");
+  const auto &f_cols = disp_geom.colors(FACES);
   for (unsigned int i = 0; i < fs.size(); i++) {
-    Color col = disp_geom.colors(FACES).get((int)i);
+    Color col = f_cols.get((int)i);
     if (col.is_index())
-      col = clrng(FACES).get_col(col.get_index());
-    if (col.is_set())
-      fprintf(ofile, "#declare f_cols[%d]=%s;\n", i, pov_col(col).c_str());
+      col = clrngs[FACES].get_col(col.get_index());
+    if (col.is_set()) {
+      out.put("#declare f_cols[").put_int(i).put("]=");
+      pov_col(out, col);
+      out.put(";\n");
+    }
   }
 
-  fprintf(ofile, "\n\n\n");
+  out.put("\n\n\n");
 }
 
 void DisplayPoly::pov_elements(FILE *ofile, int sig_digits)
@@ -698,39 +896,145 @@ void DisplayPoly::pov_col_maps(FILE *ofile)
           "   #declare face_tex_map = tex_map;\n\n");
 }
 
+// Group the visible elements of a type by colour, with index colours
+// looked up in the colour map. Elements without a colour are grouped
+// under an unset colour, and are given the default texture.
+static map<Color, vector<int>> pov_elems_by_color(const ElemProps<Color> &cols,
+                                                 const Coloring &clrng,
+                                                 int num_elems)
+{
+  map<Color, vector<int>> col_elems;
+  for (int i = 0; i < num_elems; i++) {
+    Color col = cols.get(i);
+    if (col.is_index())
+      col = clrng.get_col(col.get_index());
+    if (!col.is_invisible())
+      col_elems[col].push_back(i);
+  }
+  return col_elems;
+}
+
+// Write the visible elements of a colour group. The element index numbers
+// are written as an array, and a loop makes an object for each from the
+// element text, which refers to the index number as idx. The objects are
+// in a union, or an object if there is only one, and share a texture.
+static void pov_group(TextWriter &out, const vector<int> &idxs,
+                      const Color &col, const char *elem,
+                      const char *tex_args)
+{
+  const size_t num = idxs.size();
+  out.put("   #declare grp = array [").put_int(num).put("] {");
+  for (size_t i = 0; i < num; i++) {
+    out.put(i % 20 ? " " : "\n      ").put_int(idxs[i]);
+    if (i < num - 1)
+      out.put(',');
+  }
+  out.put("\n   }\n");
+  out.put((num > 1) ? "   union {\n" : "   object {\n");
+  out.put("      #declare i=0;\n"
+          "      #while (i<")
+      .put_int(num)
+      .put(")\n"
+           "         #declare idx=grp[i];\n"
+           "         ")
+      .put(elem)
+      .put("\n"
+           "         #declare i=i+1;\n"
+           "      #end\n");
+  out.put("      col_to_tex(");
+  if (col.is_set())
+    pov_col(out, col);
+  else
+    out.put("NoColour");
+  out.put(", ").put(tex_args).put(")\n   }\n");
+}
+
+void DisplayPoly::pov_verts_grouped(FILE *ofile)
+{
+  TextWriter out(ofile);
+  out.put("// Display vertex elements, a union for each colour\n"
+          "#if(verts_show)\n");
+  for (const auto &kp : pov_elems_by_color(disp_geom.colors(VERTS),
+                                           clrngs[VERTS],
+                                           disp_geom.verts().size()))
+    pov_group(out, kp.second, kp.first, "sphere{verts[idx],vert_sz}",
+              "vert_tex_map, vert_col_map, vert_tex");
+  out.put("   #end // (verts_show)\n"
+          "\n");
+}
+
+void DisplayPoly::pov_edges_grouped(FILE *ofile)
+{
+  TextWriter out(ofile);
+  out.put("// Display edge elements, a union for each colour\n"
+          "#if (edges_show)\n");
+  const vector<Vec3d> &vs = disp_geom.verts();
+  const vector<vector<int>> &es = disp_geom.edges();
+  for (auto &kp : pov_elems_by_color(disp_geom.colors(EDGES), clrngs[EDGES],
+                                     es.size())) {
+    // POV does not make a cylinder with equal end points
+    auto &e_idxs = kp.second;
+    e_idxs.erase(std::remove_if(e_idxs.begin(), e_idxs.end(),
+                                [&](int idx) {
+                                  return (vs[es[idx][0]] - vs[es[idx][1]])
+                                             .len2() == 0.0;
+                                }),
+                 e_idxs.end());
+    if (!e_idxs.empty())
+      pov_group(out, e_idxs, kp.first,
+                "cylinder{verts[edges[idx][0]],verts[edges[idx][1]],edge_sz}",
+                "edge_tex_map, edge_col_map, edge_tex");
+  }
+  out.put("   #end // (edges_show)\n"
+          "\n");
+}
+
 void DisplayPoly::pov_object(FILE *ofile)
 {
+  fprintf(ofile,
+          "#if (show)\n"
+          //"union {\n"
+          "#declare NoColour = <-1, -1, -1, 0>; // Indicates no colour has "
+          "been set");
+
+  if (instanced)
+    pov_verts_grouped(ofile);
+  else
+    fprintf(ofile,
+            "// Display vertex elements\n"
+            "#if(verts_show)\n"
+            "   #declare i=0;\n"
+            "   #while (i<num_verts)\n"
+            "      #declare col = NoColour;\n"
+            "      #ifdef (v_cols[i]) #declare col=v_cols[i]+<0,0,0,0>; #end\n"
+            "         #if (col.x!=0 | col.y!=0 | col.z!=0 | col.t!=1)\n"
+            "            disp_vertex(i, col)\n"
+            "         #end\n"
+            "      #declare i=i+1;\n"
+            "      #end\n"
+            "   #end // (verts_show)\n"
+            "\n");
+
+  if (instanced)
+    pov_edges_grouped(ofile);
+  else
+    fprintf(ofile,
+            "// Display edge elements\n"
+            "#if (edges_show)\n"
+            "   #declare i=0;\n"
+            "   #while (i<num_edges)\n"
+            "      #declare col = NoColour;\n"
+            "      #ifdef (e_cols[i]) #declare col=e_cols[i]+<0,0,0,0>; #end\n"
+            "         #if (col.x!=0 | col.y!=0 | col.z!=0 | col.t!=1)\n"
+            "            disp_edge(i, col)\n"
+            "         #end\n"
+            "      #declare i=i+1;\n"
+            "      #end\n"
+            "   #end // (edges_show)\n"
+            "\n");
+
   fprintf(
       ofile,
-      "#if (show)\n"
-      //"union {\n"
-      "#declare NoColour = <-1, -1, -1, 0>; // Indicates no colour has been set"
-      "// Display vertex elements\n"
-      "#if(verts_show)\n"
-      "   #declare i=0;\n"
-      "   #while (i<num_verts)\n"
-      "      #declare col = NoColour;\n"
-      "      #ifdef (v_cols[i]) #declare col=v_cols[i]+<0,0,0,0>; #end\n"
-      "         #if (col.x!=0 | col.y!=0 | col.z!=0 | col.t!=1)\n"
-      "            disp_vertex(i, col)\n"
-      "         #end\n"
-      "      #declare i=i+1;\n"
-      "      #end\n"
-      "   #end // (verts_show)\n"
-      "\n"
-      "// Display edge elements\n"
-      "#if (edges_show)\n"
-      "   #declare i=0;\n"
-      "   #while (i<num_edges)\n"
-      "      #declare col = NoColour;\n"
-      "      #ifdef (e_cols[i]) #declare col=e_cols[i]+<0,0,0,0>; #end\n"
-      "         #if (col.x!=0 | col.y!=0 | col.z!=0 | col.t!=1)\n"
-      "            disp_edge(i, col)\n"
-      "         #end\n"
-      "      #declare i=i+1;\n"
-      "      #end\n"
-      "   #end // (edges_show)\n"
-      "\n"
       "// Display face elements\n"
       "#if (faces_show)\n"
       "   #declare face_no=0;"
@@ -766,6 +1070,50 @@ void DisplayPoly::pov_geom(FILE *ofile, const Scene &, int sig_digits)
   pov_object(ofile);
 }
 
+void DisplayPoly::raster_geom(RasterWriter &rast, const Scene &)
+{
+  const vector<Vec3d> &verts = disp_geom.verts();
+  // Colour to draw an element, or an unset colour if it is invisible
+  auto disp_col = [&](int type, int idx, const Color &def) {
+    Color col = disp_geom.colors(type).get(idx);
+    if (col.is_index())
+      col = clrngs[type].get_col(col.get_index());
+    if (!col.is_value())
+      col = def;
+    return col.is_invisible() ? Color() : col;
+  };
+
+  if (elem(FACES).get_show()) {
+    const Color def = def_col(FACES);
+    const vector<vector<int>> &faces = disp_geom.faces();
+    for (unsigned int i = 0; i < faces.size(); i++) {
+      Color col = disp_col(FACES, i, def);
+      if (col.is_set())
+        rast.add_polygon(verts, faces[i], col, get_elem_trans());
+    }
+  }
+
+  if (elem(VERTS).get_show()) {
+    const Color def = def_col(VERTS);
+    for (unsigned int i = 0; i < verts.size(); i++) {
+      Color col = disp_col(VERTS, i, def);
+      if (col.is_set())
+        rast.add_sphere(verts[i], get_vert_rad(), col, get_elem_trans());
+    }
+  }
+
+  if (elem(EDGES).get_show()) {
+    const Color def = def_col(EDGES);
+    const vector<vector<int>> &edges = disp_geom.edges();
+    for (unsigned int i = 0; i < edges.size(); i++) {
+      Color col = disp_col(EDGES, i, def);
+      if (col.is_set())
+        rast.add_cylinder(verts[edges[i][0]], verts[edges[i][1]],
+                          get_edge_rad(), col, get_elem_trans());
+    }
+  }
+}
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -43,6 +43,7 @@ private:
   unsigned int winding_rule;
   int face_alpha;
   bool use_lines;                    // vrml
+  bool instanced;                    // vrml, pov
   std::vector<std::string> includes; // pov
 
 protected:
@@ -54,8 +55,10 @@ protected:
   void vrml_coords(FILE *ofile, int sig_digits);
   void vrml_verts_l(FILE *ofile);
   void vrml_verts(FILE *ofile, int sig_digits);
+  void vrml_verts_inst(FILE *ofile, int sig_digits);
   void vrml_edges_l(FILE *ofile);
   void vrml_edges(FILE *ofile);
+  void vrml_edges_inst(FILE *ofile);
   void vrml_faces(FILE *ofile);
 
   void pov_default_vals(FILE *ofile);
@@ -66,6 +69,8 @@ protected:
   void pov_elements(FILE *ofile, int sig_digits);
   void pov_col_maps(FILE *ofile);
   void pov_include_files(FILE *ofile);
+  void pov_verts_grouped(FILE *ofile);
+  void pov_edges_grouped(FILE *ofile);
   void pov_object(FILE *ofile);
 
 public:
@@ -83,6 +88,9 @@ public:
 
   void set_use_lines(bool lines) { use_lines = lines; }
   bool get_use_lines() { return use_lines; }
+  // group elements by colour, sharing a shape or palette entry
+  void set_instanced(bool inst) { instanced = inst; }
+  bool get_instanced() { return instanced; }
   void set_includes(std::vector<std::string> incs) { includes = incs; }
   std::vector<std::string> &get_includes() { return includes; }
   const std::vector<std::string> &get_includes() const { return includes; }
@@ -94,6 +102,7 @@ public:
 
   void vrml_geom(FILE *ofile, const Scene &scen, int sig_dgts = DEF_SIG_DGTS);
   void pov_geom(FILE *ofile, const Scene &scen, int sig_dgts = DEF_SIG_DGTS);
+  void raster_geom(RasterWriter &rast, const Scene &scen);
   // void gl_geom(const Scene &scen);
 };
 
@@ -29,16 +29,22 @@
 #include "coloring.h"
 #include "geometryinfo.h"
 #include "mathutils.h"
+#include "parallel.h"
+#include "private_point_grid.h"
 #include "symmetry.h"
 #include "utils.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 using std::map;
@@ -58,11 +64,18 @@ void sym_repeat(Geometry &geom, const Geometry &part, const Transformations &ts,
 
   Geometry symmetry_unit = part;
   geom.clear_all();
-  Transformations::const_iterator si;
-  int idx = 0;
-  for (si = ts.begin(); si != ts.end(); si++, idx++) {
+
+  // transform the vertices for all the units together
+  const vector<Trans3d> transs(ts.begin(), ts.end());
+  const auto &unit_verts = symmetry_unit.verts();
+  vector<Vec3d> all_verts;
+  transform(all_verts, unit_verts, transs);
+
+  for (unsigned int idx = 0; idx < transs.size(); idx++) {
     Geometry sym_unit = symmetry_unit;
-    sym_unit.transform(*si);
+    std::copy(all_verts.begin() + idx * unit_verts.size(),
+              all_verts.begin() + (idx + 1) * unit_verts.size(),
+              sym_unit.raw_verts().begin());
     for (int i = 0; i < 3; i++)
       clrngs[i].set_geom(&sym_unit);
 
@@ -89,6 +102,169 @@ bool sym_repeat(Geometry &geom, const Geometry &part, const Symmetry &sym,
   return true;
 }
 
+namespace {
+
+// Hash for a list of indexes
+struct IndexListHash {
+  size_t operator()(const vector<int> &idxs) const
+  {
+    size_t h = idxs.size();
+    for (int idx : idxs)
+      h ^= (size_t)idx + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+  }
+};
+
+} // namespace
+
+bool sym_repeat_merged(Geometry &geom, const Geometry &part,
+                       const Transformations &ts, const Transformations &grp,
+                       char col_part_elems, Coloring *clrngs)
+{
+  Coloring tmp_clrngs[3];
+  if (!clrngs)
+    clrngs = tmp_clrngs;
+
+  Geometry unit = part;
+  if (col_part_elems & ELEM_EDGES)
+    unit.add_missing_impl_edges();
+
+  // Group elements, and their multiplication table, by index
+  const vector<Trans3d> gs(grp.begin(), grp.end());
+  const int num_gs = gs.size();
+  auto g_idx = [&](const Trans3d &t) {
+    const auto ti = grp.get_trans().find(t);
+    return (ti == grp.end()) ? -1 : (int)std::distance(grp.begin(), ti);
+  };
+  const int id_idx = g_idx(Trans3d());
+  if (id_idx < 0)
+    return false;
+  vector<vector<int>> mult(num_gs, vector<int>(num_gs));
+  for (int i = 0; i < num_gs; i++)
+    for (int j = 0; j < num_gs; j++)
+      if ((mult[i][j] = g_idx(gs[i] * gs[j])) < 0)
+        return false;
+
+  const vector<Trans3d> transs(ts.begin(), ts.end());
+  vector<int> t_idxs(transs.size());
+  for (unsigned int c = 0; c < transs.size(); c++)
+    if ((t_idxs[c] = g_idx(transs[c])) < 0)
+      return false;
+
+  // Vertex orbits of the part: each vertex v is the image of its orbit
+  // representative orb_rep[v] by group element via[v], and the stabiliser
+  // of each representative is found along the way.
+  const auto &verts = unit.verts();
+  const int num_verts = verts.size();
+  vector<int> orb_rep(num_verts, -1);
+  vector<int> via(num_verts, id_idx);
+  vector<vector<int>> stab(num_verts);
+  PointGrid grid(verts);
+  vector<Vec3d> imgs;
+  for (int v = 0; v < num_verts; v++) {
+    if (orb_rep[v] >= 0)
+      continue;
+    orb_rep[v] = v;
+    transform(imgs, {verts[v]}, gs);
+    for (int g = 0; g < num_gs; g++)
+      grid.for_each_near(imgs[g], sym_eps, [&](int u) {
+        if (u == v)
+          stab[v].push_back(g);
+        else if (orb_rep[u] < 0) {
+          orb_rep[u] = v;
+          via[u] = g;
+        }
+      });
+  }
+
+  // The copy of vertex v made by group element t is the image of its
+  // representative r by t*via[v], and coincides with the copies of any
+  // vertex in the orbit whose element is in the same left coset of the
+  // stabiliser of r. The lowest index in the coset identifies the vertex.
+  geom.clear_all();
+  std::unordered_map<long long, int> v_map;
+  std::unordered_set<long long> e_set;
+  std::unordered_set<vector<int>, IndexListHash> f_set;
+  vector<int> v_new(num_verts);
+  vector<int> elem;
+  for (unsigned int c = 0; c < transs.size(); c++) {
+    for (int v = 0; v < num_verts; v++) {
+      const int g = mult[t_idxs[c]][via[v]];
+      int canon = num_gs;
+      for (int s : stab[orb_rep[v]])
+        canon = std::min(canon, mult[g][s]);
+      const long long key = (long long)orb_rep[v] * num_gs + canon;
+      const auto vi = v_map.find(key);
+      if (vi != v_map.end())
+        v_new[v] = vi->second;
+      else {
+        const Color col = (col_part_elems & ELEM_VERTS)
+                              ? clrngs[VERTS].get_col(c)
+                              : unit.colors(VERTS).get(v);
+        v_new[v] = geom.add_vert(transs[c] * verts[v], col);
+        v_map[key] = v_new[v];
+      }
+    }
+
+    for (unsigned int i = 0; i < unit.edges().size(); i++) {
+      int v0 = v_new[unit.edges(i, 0)];
+      int v1 = v_new[unit.edges(i, 1)];
+      if (v0 > v1)
+        swap(v0, v1);
+      if (e_set.insert(((long long)v0 << 32) + v1).second) {
+        const Color col = (col_part_elems & ELEM_EDGES)
+                              ? clrngs[EDGES].get_col(c)
+                              : unit.colors(EDGES).get(i);
+        geom.add_edge_raw({v0, v1}, col);
+      }
+    }
+
+    for (unsigned int i = 0; i < unit.faces().size(); i++) {
+      elem.clear();
+      for (int v : unit.faces(i))
+        elem.push_back(v_new[v]);
+      vector<int> f_key = elem;
+      sort(f_key.begin(), f_key.end());
+      if (f_set.insert(std::move(f_key)).second) {
+        const Color col = (col_part_elems & ELEM_FACES)
+                              ? clrngs[FACES].get_col(c)
+                              : unit.colors(FACES).get(i);
+        geom.add_face(elem, col);
+      }
+    }
+  }
+
+  return true;
+}
+
+namespace {
+
+// Sort index pairs, packed into keys, with a value for each. The pairs are
+// put in buckets by their first index, then each bucket is sorted, which
+// is quicker than sorting all the pairs when the buckets are small.
+void sort_packed_pairs(vector<pair<uint64_t, int>> &pairs)
+{
+  uint64_t max_first = 0;
+  for (const auto &pr : pairs)
+    max_first = std::max(max_first, pr.first >> 32);
+  vector<int> start(max_first + 2, 0);
+  for (const auto &pr : pairs)
+    start[(pr.first >> 32) + 1]++;
+  for (unsigned int i = 1; i < start.size(); i++)
+    start[i] += start[i - 1];
+
+  vector<pair<uint64_t, int>> sorted(pairs.size());
+  vector<int> pos(start.begin(), start.end() - 1);
+  for (const auto &pr : pairs)
+    sorted[pos[pr.first >> 32]++] = pr;
+  for (unsigned int i = 0; i + 1 < start.size(); i++)
+    if (start[i + 1] - start[i] > 1)
+      sort(sorted.begin() + start[i], sorted.begin() + start[i + 1]);
+  pairs.swap(sorted);
+}
+
+} // namespace
+
 // If a face does not contain vertex v0 followed, in cyclic order, by v1
 // then the face will be reversed
 void orient_face(vector<int> &face, int v0, int v1)
@@ -106,54 +282,129 @@ void orient_face(vector<int> &face, int v0, int v1)
 
 int orient_geom(Geometry &geom, vector<vector<int>> *parts)
 {
-  int part_num = 0;
-  const int done = -1;
-  auto edges = geom.get_edge_face_pairs(false);
-  vector<int> cur_idx(geom.faces().size(), 0);
-  vector<int> prev_face(geom.faces().size(), 0);
-  vector<int> e_verts(2);
-  vector<int> orig_e_verts(2);
-  vector<int> e_faces(2);
-  for (unsigned int i = 0; i < geom.faces().size(); i++) {
-    if (geom.faces(i).size() < 3)
-      cur_idx[i] = done; // don't process degenerate faces
-    if (cur_idx[i] == done)
+  vector<vector<int>> &faces = geom.raw_faces();
+  const int f_sz = faces.size();
+
+  // Face edges, keyed by their packed vertex-sorted index pair. Sorting
+  // brings together the face edges on each edge, in face order. The work
+  // doesn't depend on the number of vertices, as orient() is also used on
+  // a few faces of a large model.
+  vector<int> f_start(f_sz + 1, 0);
+  for (int i = 0; i < f_sz; i++)
+    f_start[i + 1] = f_start[i] + faces[i].size();
+  vector<pair<uint64_t, int>> f_edges(f_start[f_sz]);
+  vector<int> f_edge_face(f_start[f_sz]);
+  for (int i = 0; i < f_sz; i++) {
+    for (unsigned int j = 0; j < faces[i].size(); j++) {
+      unsigned int v0 = faces[i][j];
+      unsigned int v1 = faces[i][(j + 1) % faces[i].size()];
+      if (v0 > v1)
+        swap(v0, v1);
+      const int e_idx = f_start[i] + j;
+      f_edges[e_idx] = {((uint64_t)v0 << 32) | v1, e_idx};
+      f_edge_face[e_idx] = i;
+    }
+  }
+  sort(f_edges.begin(), f_edges.end());
+
+  // flat adjacency: the face that orientation spreads to across each face
+  // edge, or -1. Edge j of face i is at nbrs[f_start[i] + j]
+  vector<int> nbrs(f_start[f_sz]);
+  for (unsigned int i = 0; i < f_edges.size();) {
+    unsigned int j = i + 1;
+    while (j < f_edges.size() && f_edges[j].first == f_edges[i].first)
+      j++;
+    // first two faces on the edge
+    const int face0 = f_edge_face[f_edges[i].second];
+    const int face1 = (j - i > 1) ? f_edge_face[f_edges[i + 1].second] : -1;
+    for (; i < j; i++) {
+      const int e_idx = f_edges[i].second;
+      nbrs[e_idx] = (face0 != f_edge_face[e_idx]) ? face0 : face1;
+    }
+  }
+
+  // Find the parts. Each part is seeded by its lowest non-degenerate face.
+  // Degenerate faces never seed a part, and are only reached from parts
+  // seeded before them
+  vector<int> part_of(f_sz, -1);
+  vector<int> seeds;
+  vector<int> stack;
+  for (int i = 0; i < f_sz; i++) {
+    if (faces[i].size() < 3 || part_of[i] >= 0)
       continue;
-    int cur_fidx = i;
-    if (parts)
-      parts->push_back(vector<int>(1, i));
-    while (cur_idx[i] != done) {
+    int part_idx = seeds.size();
+    seeds.push_back(i);
+    part_of[i] = part_idx;
+    stack.push_back(i);
+    while (stack.size()) {
+      int f = stack.back();
+      stack.pop_back();
+      for (int k = f_start[f]; k < f_start[f + 1]; k++) {
+        int nbr = nbrs[k];
+        if (nbr >= 0 && part_of[nbr] < 0 &&
+            (faces[nbr].size() >= 3 || nbr > i)) {
+          part_of[nbr] = part_idx;
+          stack.push_back(nbr);
+        }
+      }
+    }
+  }
+
+  // Orient each part by a depth-first walk from its seed. The parts don't
+  // share faces, so they can be processed in parallel.
+  const int done = -1;
+  vector<int> cur_idx(f_sz, 0);
+  vector<int> prev_face(f_sz, 0);
+  vector<char> reversed(f_sz, false);
+  vector<vector<int>> part_faces(seeds.size());
+  auto orient_part = [&](size_t part_idx) {
+    const int seed = seeds[part_idx];
+    part_faces[part_idx].push_back(seed);
+    int cur_fidx = seed;
+    while (true) {
       int idx = cur_idx[cur_fidx];
       if (idx == done) {
+        if (cur_fidx == seed)
+          break; // walked back to the seed, the part is complete
         cur_fidx = prev_face[cur_fidx];
         continue;
       }
 
       // read off the next edge
-      const vector<int> &face = geom.faces(cur_fidx);
-      orig_e_verts[0] = face[idx];
-      idx = (idx + 1) % face.size();
-      orig_e_verts[1] = face[idx];
+      const vector<int> &face = faces[cur_fidx];
+      const int sz = face.size();
+      int v0 = face[idx];
+      int edge_no = (reversed[cur_fidx]) ? 2 * sz - 2 - idx : idx;
+      idx = (idx + 1) % sz;
+      int v1 = face[idx];
       cur_idx[cur_fidx] = idx ? idx : done; // set to next idx, or mark done
 
-      e_verts = orig_e_verts;
-      if (e_verts[0] > e_verts[1])
-        swap(e_verts[0], e_verts[1]);
-      e_faces = edges.find(e_verts)->second;
-
-      int next_face = (e_faces[0] != cur_fidx) ? e_faces[0] : e_faces[1];
-      if (next_face >= 0 && cur_idx[next_face] == 0) { // face not looked at yet
-        orient_face(geom.raw_faces()[next_face], orig_e_verts[1],
-                    orig_e_verts[0]);
-        if (parts)
-          parts->back().push_back(next_face);
+      int next_face = nbrs[f_start[cur_fidx] + edge_no % sz];
+      if (next_face >= 0 && part_of[next_face] == (int)part_idx &&
+          cur_idx[next_face] == 0) { // face not looked at yet
+        vector<int> &next = faces[next_face];
+        bool found = false;
+        for (unsigned int i = 0; i < next.size(); i++) {
+          if (next[i] == v1 && next[(i + 1) % next.size()] == v0) {
+            found = true;
+            break;
+          }
+        }
+        if (!found) {
+          reverse(next.begin(), next.end());
+          reversed[next_face] = true;
+        }
+        part_faces[part_idx].push_back(next_face);
         prev_face[next_face] = cur_fidx;
         cur_fidx = next_face;
       }
     }
-    part_num++;
-  }
-  return part_num;
+  };
+  parallel_for(seeds.size(), orient_part, (f_sz < 2000) ? 1 : 0);
+
+  if (parts)
+    parts->insert(parts->end(), part_faces.begin(), part_faces.end());
+  return seeds.size();
 }
 
 // From planar.cc (Roger Kaufman)
@@ -228,33 +479,48 @@ void get_dual(Geometry &dual, const Geometry &geom, double recip_rad,
   get_pol_recip_verts(dual, geom, recip_rad, centre, inf);
   vector<vector<int>> d_faces(geom.verts().size());
 
+  // Face edges, keyed by their packed vertex-sorted index pair. Sorting
+  // brings together the face edges on each edge, in face order. Lookups
+  // are replaced by a walk through the sorted edges, so the work does not
+  // depend on the number of edges at a vertex or on a face.
   const vector<vector<int>> &faces = geom.faces();
-  map<pair<int, int>, pair<int, int>> edges;
-  map<pair<int, int>, pair<int, int>>::iterator mi;
-  pair<int, int> edge;
+  vector<pair<uint64_t, int>> f_edges;
+  vector<int> f_edge_face;
+  vector<char> f_edge_rev; // edge runs from the higher vertex index
   for (unsigned int i = 0; i < faces.size(); ++i) {
     for (unsigned int j = 0; j < faces[i].size(); ++j) {
-      edge.first = faces[i][j];
-      edge.second = faces[i][(j + 1) % faces[i].size()];
-      bool swap_idxs = (edge.first > edge.second);
-      if (swap_idxs)
-        swap(edge.first, edge.second);
-      mi = edges.find(edge);
-      if (mi != edges.end()) {
-        mi->second.second = i;
-        if (swap_idxs)
-          swap(mi->second.first, mi->second.second);
-      }
-      else
-        edges[edge].first = i;
+      unsigned int v0 = faces[i][j];
+      unsigned int v1 = faces[i][(j + 1) % faces[i].size()];
+      const bool rev = (v0 > v1);
+      if (rev)
+        swap(v0, v1);
+      f_edges.push_back({((uint64_t)v0 << 32) | v1, (int)f_edge_face.size()});
+      f_edge_face.push_back(i);
+      f_edge_rev.push_back(rev);
+    }
+  }
+  sort_packed_pairs(f_edges);
+
+  // edges in sorted order, with the faces on each side. A later face on
+  // the edge replaces the second face, and if its edge runs from the
+  // higher vertex index the faces are swapped.
+  vector<pair<pair<int, int>, pair<int, int>>> edges;
+  for (unsigned int i = 0; i < f_edges.size();) {
+    const uint64_t key = f_edges[i].first;
+    pair<int, int> e_faces(f_edge_face[f_edges[i].second], 0);
+    for (i++; i < f_edges.size() && f_edges[i].first == key; i++) {
+      e_faces.second = f_edge_face[f_edges[i].second];
+      if (f_edge_rev[f_edges[i].second])
+        swap(e_faces.first, e_faces.second);
     }
+    edges.push_back({{int(key >> 32), int(key & 0xffffffff)}, e_faces});
   }
 
-  for (mi = edges.begin(); mi != edges.end(); mi++) {
-    d_faces[mi->first.first].push_back(mi->second.first);
-    d_faces[mi->first.first].push_back(mi->second.second);
-    d_faces[mi->first.second].push_back(mi->second.second);
-    d_faces[mi->first.second].push_back(mi->second.first);
+  for (const auto &e : edges) {
+    d_faces[e.first.first].push_back(e.second.first);
+    d_faces[e.first.first].push_back(e.second.second);
+    d_faces[e.first.second].push_back(e.second.second);
+    d_faces[e.first.second].push_back(e.second.first);
   }
 
   vector<int>::iterator vi;
@@ -276,25 +542,56 @@ void get_dual(Geometry &dual, const Geometry &geom, double recip_rad,
       d_face.erase(vi - 1, d_face.end());
   }
 
-  dual.clear(EDGES);
+  // explicit edges, keyed by their packed index pair, sorted so that the
+  // first occurrence of an edge, which is the one used, comes first
   const vector<vector<int>> &g_edges = geom.edges();
+  vector<pair<uint64_t, int>> g_edge_keys(g_edges.size());
+  for (unsigned int i = 0; i < g_edges.size(); i++)
+    g_edge_keys[i] = {((uint64_t)g_edges[i][0] << 32) | g_edges[i][1], i};
+  sort_packed_pairs(g_edge_keys);
+
+  // a dual edge is made for each edge that is explicit. Dual edges are
+  // keyed by their packed face-sorted index pair, added in the order they
+  // are first found, and coloured like the last edge found for them.
+  vector<pair<int, int>> d_edges;
+  vector<int> d_edge_gidx;
+  vector<pair<uint64_t, int>> d_edge_keys;
+  auto gi = g_edge_keys.begin();
+  for (const auto &e : edges) {
+    const uint64_t key = ((uint64_t)e.first.first << 32) | e.first.second;
+    while (gi != g_edge_keys.end() && gi->first < key)
+      ++gi;
+    if (gi == g_edge_keys.end() || gi->first != key)
+      continue;
+    pair<int, int> d_edge = e.second;
+    if (d_edge.first > d_edge.second)
+      swap(d_edge.first, d_edge.second);
+    d_edge_keys.push_back(
+        {((uint64_t)d_edge.first << 32) | d_edge.second, (int)d_edges.size()});
+    d_edges.push_back(d_edge);
+    d_edge_gidx.push_back(gi->second);
+  }
+  sort_packed_pairs(d_edge_keys);
+
+  // first and last occurrence of each dual edge, in first occurrence order
+  vector<pair<int, int>> d_edge_occs;
+  for (unsigned int i = 0; i < d_edge_keys.size();) {
+    const uint64_t key = d_edge_keys[i].first;
+    const int first = d_edge_keys[i].second;
+    while (i + 1 < d_edge_keys.size() && d_edge_keys[i + 1].first == key)
+      i++;
+    d_edge_occs.push_back({first, d_edge_keys[i++].second});
+  }
+  sort(d_edge_occs.begin(), d_edge_occs.end());
+
+  dual.clear(EDGES);
   dual.colors(FACES) = geom.colors(VERTS);
   dual.colors(VERTS) = geom.colors(FACES);
-  vector<int> g_edge(2);
-  vector<int> d_edge(2);
-  for (mi = edges.begin(); mi != edges.end(); mi++) {
-    g_edge[0] = mi->first.first;
-    g_edge[1] = mi->first.second;
-    d_edge[0] = mi->second.first;
-    d_edge[1] = mi->second.second;
-    int gidx, didx;
-    vector<vector<int>>::const_iterator ei;
-    ei = find(g_edges.begin(), g_edges.end(), g_edge);
-    if (ei != g_edges.end()) {
-      gidx = ei - g_edges.begin();
-      didx = dual.add_edge(d_edge);
-      dual.colors(EDGES).set(didx, geom.colors(EDGES).get(gidx));
-    }
+  for (const auto &occ : d_edge_occs) {
+    const auto &d_edge = d_edges[occ.first];
+    int d_idx = dual.add_edge_raw({d_edge.first, d_edge.second});
+    dual.colors(EDGES).set(d_idx,
+                           geom.colors(EDGES).get(d_edge_gidx[occ.second]));
   }
 
   for (unsigned int i = 0; i < d_faces.size(); ++i)
@@ -0,0 +1,475 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file faceintersect.cc
+   \brief Find the faces of a model that intersect each other
+*/
+
+#include "faceintersect.h"
+#include "vec_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::vector;
+
+namespace anti {
+
+namespace {
+
+const int leaf_sz = 4; // maximum number of faces in a tree leaf
+
+// Intervals along a line where the winding number of a face is not zero.
+// The line is where the face plane meets another plane, and dists are the
+// distances of the face vertices from that plane. Zero distances are
+// treated as positive if zero_pos is true, otherwise as negative.
+void interior_intervals(const vector<Vec3d> &verts, const vector<int> &face,
+                        const vector<double> &dists, bool zero_pos,
+                        const Vec3d &dir, vector<pair<double, double>> &ivals)
+{
+  vector<pair<double, int>> crossings; // position, change in winding number
+  const int sz = face.size();
+  for (int i = 0; i < sz; i++) {
+    const int i2 = (i + 1) % sz;
+    const bool pos0 = dists[i] > 0 || (dists[i] == 0 && zero_pos);
+    const bool pos1 = dists[i2] > 0 || (dists[i2] == 0 && zero_pos);
+    if (pos0 != pos1) {
+      const double t0 = vdot(dir, verts[face[i]]);
+      const double t1 = vdot(dir, verts[face[i2]]);
+      const double frac = dists[i] / (dists[i] - dists[i2]);
+      crossings.push_back({t0 + frac * (t1 - t0), pos1 ? 1 : -1});
+    }
+  }
+  sort(crossings.begin(), crossings.end());
+
+  ivals.clear();
+  int winding = 0;
+  double start = 0;
+  for (const auto &cross : crossings) {
+    const int prev = winding;
+    winding += cross.second;
+    if (prev == 0 && winding != 0)
+      start = cross.first;
+    else if (prev != 0 && winding == 0)
+      ivals.push_back({start, cross.first});
+  }
+}
+
+// Intersection of two sorted lists of disjoint intervals
+void intersect_intervals(const vector<pair<double, double>> &ivals0,
+                         const vector<pair<double, double>> &ivals1,
+                         vector<pair<double, double>> &ivals)
+{
+  ivals.clear();
+  unsigned int i0 = 0;
+  unsigned int i1 = 0;
+  while (i0 < ivals0.size() && i1 < ivals1.size()) {
+    const double start = std::max(ivals0[i0].first, ivals1[i1].first);
+    const double end = std::min(ivals0[i0].second, ivals1[i1].second);
+    if (start < end)
+      ivals.push_back({start, end});
+    if (ivals0[i0].second < ivals1[i1].second)
+      i0++;
+    else
+      i1++;
+  }
+}
+
+// Intervals along the line of intersection with another plane that are
+// inside a face, excluding parts of the boundary lying along the line
+void face_line_intervals(const vector<Vec3d> &verts, const vector<int> &face,
+                         const vector<double> &dists, const Vec3d &dir,
+                         vector<pair<double, double>> &ivals)
+{
+  vector<pair<double, double>> ivals_pos;
+  vector<pair<double, double>> ivals_neg;
+  interior_intervals(verts, face, dists, true, dir, ivals_pos);
+  interior_intervals(verts, face, dists, false, dir, ivals_neg);
+  intersect_intervals(ivals_pos, ivals_neg, ivals);
+}
+
+// Distances of face vertices from a plane, rounded to 0 when within eps.
+// Return false if the face lies on one side of the plane.
+bool plane_dists(const vector<Vec3d> &verts, const vector<int> &face,
+                 const Vec3d &norm, double offset, double eps,
+                 vector<double> &dists)
+{
+  dists.resize(face.size());
+  bool pos = false;
+  bool neg = false;
+  for (unsigned int i = 0; i < face.size(); i++) {
+    double dist = vdot(norm, verts[face[i]]) - offset;
+    if (fabs(dist) < eps)
+      dist = 0;
+    pos = pos || dist > 0;
+    neg = neg || dist < 0;
+    dists[i] = dist;
+  }
+  return pos && neg;
+}
+
+// Coordinates in a plane, to test coplanar faces in 2D
+struct PlaneCrds {
+  Vec3d u, v;
+  explicit PlaneCrds(const Vec3d &norm)
+  {
+    u = vcross(norm, (fabs(norm[0]) < 0.5) ? Vec3d::X : Vec3d::Y).unit();
+    v = vcross(norm, u);
+  }
+  pair<double, double> operator()(const Vec3d &pt) const
+  {
+    return {vdot(u, pt), vdot(v, pt)};
+  }
+};
+
+typedef pair<double, double> Pt2d;
+
+double orient2d(const Pt2d &a, const Pt2d &b, const Pt2d &c)
+{
+  return (b.first - a.first) * (c.second - a.second) -
+         (b.second - a.second) * (c.first - a.first);
+}
+
+// Whether a point is within eps of a segment
+bool on_segment(const Pt2d &p, const Pt2d &a, const Pt2d &b, double eps)
+{
+  const double dx = b.first - a.first;
+  const double dy = b.second - a.second;
+  const double len2 = dx * dx + dy * dy;
+  double t = 0;
+  if (len2 > 0)
+    t = ((p.first - a.first) * dx + (p.second - a.second) * dy) / len2;
+  t = std::max(0.0, std::min(1.0, t));
+  const double px = a.first + t * dx - p.first;
+  const double py = a.second + t * dy - p.second;
+  return px * px + py * py < eps * eps;
+}
+
+// Whether a point is strictly inside a polygon, by non-zero winding number
+bool inside_polygon(const Pt2d &p, const vector<Pt2d> &poly, double eps)
+{
+  int winding = 0;
+  const int sz = poly.size();
+  for (int i = 0; i < sz; i++) {
+    const Pt2d &a = poly[i];
+    const Pt2d &b = poly[(i + 1) % sz];
+    if (on_segment(p, a, b, eps))
+      return false;
+    if (a.second <= p.second) {
+      if (b.second > p.second && orient2d(a, b, p) > 0)
+        winding++;
+    }
+    else if (b.second <= p.second && orient2d(a, b, p) < 0)
+      winding--;
+  }
+  return winding != 0;
+}
+
+// Whether two segments cross at a point inside both
+bool segments_cross(const Pt2d &a0, const Pt2d &a1, const Pt2d &b0,
+                    const Pt2d &b1, double eps)
+{
+  const double len_a = hypot(a1.first - a0.first, a1.second - a0.second);
+  const double len_b = hypot(b1.first - b0.first, b1.second - b0.second);
+  const double o0 = orient2d(a0, a1, b0) / len_a;
+  const double o1 = orient2d(a0, a1, b1) / len_a;
+  const double o2 = orient2d(b0, b1, a0) / len_b;
+  const double o3 = orient2d(b0, b1, a1) / len_b;
+  return ((o0 > eps && o1 < -eps) || (o0 < -eps && o1 > eps)) &&
+         ((o2 > eps && o3 < -eps) || (o2 < -eps && o3 > eps));
+}
+
+// Points strictly inside a polygon, one just inside each edge where
+// possible. Coplanar polygons which overlap without any edges crossing,
+// or any vertex inside the other polygon, share a boundary, and some of
+// these points will lie inside the other polygon.
+void interior_samples(const vector<Pt2d> &poly, double eps,
+                      vector<Pt2d> &samples)
+{
+  samples.clear();
+  const int sz = poly.size();
+  const Pt2d origin(0, 0);
+  double area2 = 0;
+  for (int i = 0; i < sz; i++)
+    area2 += orient2d(origin, poly[i], poly[(i + 1) % sz]);
+  const double sign = (area2 < 0) ? -1 : 1;
+
+  for (int i = 0; i < sz; i++) {
+    const Pt2d &a = poly[i];
+    const Pt2d &b = poly[(i + 1) % sz];
+    const double dx = b.first - a.first;
+    const double dy = b.second - a.second;
+    const double len = hypot(dx, dy);
+    if (len < eps)
+      continue;
+    // step in from the edge mid-point, closer until inside the polygon
+    const Pt2d mid((a.first + b.first) / 2, (a.second + b.second) / 2);
+    for (double dist = len / 4; dist > 16 * eps; dist /= 16) {
+      const double scale = sign * dist / len;
+      const Pt2d pt(mid.first - dy * scale, mid.second + dx * scale);
+      if (inside_polygon(pt, poly, eps)) {
+        samples.push_back(pt);
+        break;
+      }
+    }
+  }
+}
+
+} // namespace
+
+FaceIntersections::FaceIntersections(const Geometry &geom, double eps)
+    : geom(geom), eps(eps), f_data(geom.faces().size())
+{
+  const auto &verts = geom.verts();
+  const Vec3d expand(eps, eps, eps);
+  for (unsigned int i = 0; i < geom.faces().size(); i++) {
+    const auto &face = geom.faces(i);
+    FaceData &fd = f_data[i];
+    if (face.size() < 3)
+      continue;
+    Vec3d norm = face_norm(verts, face);
+    if (norm.len() < eps)
+      continue;
+    fd.norm = norm.unit();
+    fd.offset = vdot(fd.norm, centroid(verts, face));
+    fd.min = verts[face[0]];
+    fd.max = verts[face[0]];
+    for (int v : face)
+      for (int j = 0; j < 3; j++) {
+        fd.min[j] = std::min(fd.min[j], verts[v][j]);
+        fd.max[j] = std::max(fd.max[j], verts[v][j]);
+      }
+    fd.min -= expand;
+    fd.max += expand;
+    order.push_back(i);
+  }
+
+  if (order.size())
+    build(0, order.size());
+}
+
+int FaceIntersections::build(int start, int end)
+{
+  Node node;
+  node.min = f_data[order[start]].min;
+  node.max = f_data[order[start]].max;
+  for (int i = start + 1; i < end; i++)
+    for (int j = 0; j < 3; j++) {
+      node.min[j] = std::min(node.min[j], f_data[order[i]].min[j]);
+      node.max[j] = std::max(node.max[j], f_data[order[i]].max[j]);
+    }
+  node.left = -1;
+  node.right = -1;
+  node.start = start;
+  node.end = end;
+  const int idx = nodes.size();
+  nodes.push_back(node);
+
+  if (end - start > leaf_sz) {
+    // split at the median of the face box centres along the longest side
+    const Vec3d size = node.max - node.min;
+    int axis = 0;
+    for (int j = 1; j < 3; j++)
+      if (size[j] > size[axis])
+        axis = j;
+    const int mid = (start + end) / 2;
+    std::nth_element(order.begin() + start, order.begin() + mid,
+                     order.begin() + end, [&](int f0, int f1) {
+                       return f_data[f0].min[axis] + f_data[f0].max[axis] <
+                              f_data[f1].min[axis] + f_data[f1].max[axis];
+                     });
+    const int left = build(start, mid);
+    const int right = build(mid, end);
+    nodes[idx].left = left;
+    nodes[idx].right = right;
+  }
+
+  return idx;
+}
+
+void FaceIntersections::faces_near(const Vec3d &min_coords,
+                                   const Vec3d &max_coords,
+                                   vector<int> &f_idxs) const
+{
+  f_idxs.clear();
+  if (nodes.empty())
+    return;
+
+  auto overlaps = [&](const Vec3d &min, const Vec3d &max) {
+    for (int j = 0; j < 3; j++)
+      if (min[j] > max_coords[j] || max[j] < min_coords[j])
+        return false;
+    return true;
+  };
+
+  vector<int> stack(1, 0);
+  while (stack.size()) {
+    const Node &node = nodes[stack.back()];
+    stack.pop_back();
+    if (!overlaps(node.min, node.max))
+      continue;
+    if (node.left < 0) {
+      for (int i = node.start; i < node.end; i++) {
+        const FaceData &fd = f_data[order[i]];
+        if (overlaps(fd.min, fd.max))
+          f_idxs.push_back(order[i]);
+      }
+    }
+    else {
+      stack.push_back(node.right);
+      stack.push_back(node.left);
+    }
+  }
+}
+
+bool FaceIntersections::crossing_intersect(int f0, int f1,
+                                           const Vec3d &dir) const
+{
+  const auto &verts = geom.verts();
+  const auto &face0 = geom.faces(f0);
+  const auto &face1 = geom.faces(f1);
+  const FaceData &fd0 = f_data[f0];
+  const FaceData &fd1 = f_data[f1];
+
+  // each face must have vertices on both sides of the other face plane
+  vector<double> dists0;
+  vector<double> dists1;
+  if (!plane_dists(verts, face0, fd1.norm, fd1.offset, eps, dists0) ||
+      !plane_dists(verts, face1, fd0.norm, fd0.offset, eps, dists1))
+    return false;
+
+  vector<pair<double, double>> ivals0;
+  vector<pair<double, double>> ivals1;
+  vector<pair<double, double>> ivals;
+  face_line_intervals(verts, face0, dists0, dir, ivals0);
+  face_line_intervals(verts, face1, dists1, dir, ivals1);
+  intersect_intervals(ivals0, ivals1, ivals);
+  for (const auto &ival : ivals)
+    if (ival.second - ival.first > eps)
+      return true;
+
+  return false;
+}
+
+bool FaceIntersections::coplanar_intersect(int f0, int f1) const
+{
+  const auto &verts = geom.verts();
+  const PlaneCrds to_2d(f_data[f0].norm);
+  vector<Pt2d> polys[2];
+  for (int v : geom.faces(f0))
+    polys[0].push_back(to_2d(verts[v]));
+  for (int v : geom.faces(f1))
+    polys[1].push_back(to_2d(verts[v]));
+
+  const int sz0 = polys[0].size();
+  const int sz1 = polys[1].size();
+  for (int i = 0; i < sz0; i++)
+    for (int j = 0; j < sz1; j++)
+      if (segments_cross(polys[0][i], polys[0][(i + 1) % sz0], polys[1][j],
+                         polys[1][(j + 1) % sz1], eps))
+        return true;
+
+  for (int p = 0; p < 2; p++)
+    for (const auto &pt : polys[p])
+      if (inside_polygon(pt, polys[1 - p], eps))
+        return true;
+
+  vector<Pt2d> samples;
+  for (int p = 0; p < 2; p++) {
+    interior_samples(polys[p], eps, samples);
+    for (const auto &pt : samples)
+      if (inside_polygon(pt, polys[1 - p], eps))
+        return true;
+  }
+
+  return false;
+}
+
+bool FaceIntersections::faces_intersect(int f0, int f1) const
+{
+  if (f0 == f1)
+    return false;
+  const FaceData &fd0 = f_data[f0];
+  const FaceData &fd1 = f_data[f1];
+  if (!fd0.norm.is_set() || !fd1.norm.is_set())
+    return false;
+  for (int j = 0; j < 3; j++)
+    if (fd0.min[j] > fd1.max[j] || fd0.max[j] < fd1.min[j])
+      return false;
+
+  const Vec3d dir = vcross(fd0.norm, fd1.norm);
+  if (dir.len() > eps)
+    return crossing_intersect(f0, f1, dir.unit());
+
+  // parallel planes, test if they are the same plane
+  for (int v : geom.faces(f1))
+    if (fabs(vdot(fd0.norm, geom.verts(v)) - fd0.offset) > eps)
+      return false;
+  return coplanar_intersect(f0, f1);
+}
+
+void FaceIntersections::for_each_pair(
+    const std::function<bool(int, int)> &func) const
+{
+  vector<int> near;
+  for (unsigned int f0 = 0; f0 < f_data.size(); f0++) {
+    if (!f_data[f0].norm.is_set())
+      continue;
+    faces_near(f_data[f0].min, f_data[f0].max, near);
+    sort(near.begin(), near.end());
+    for (int f1 : near)
+      if (f1 > (int)f0 && faces_intersect(f0, f1) && !func(f0, f1))
+        return;
+  }
+}
+
+bool FaceIntersections::any() const
+{
+  bool found = false;
+  for_each_pair([&](int, int) {
+    found = true;
+    return false;
+  });
+  return found;
+}
+
+long FaceIntersections::count(int *f_cnt) const
+{
+  long cnt = 0;
+  vector<bool> f_hit(f_data.size(), false);
+  for_each_pair([&](int f0, int f1) {
+    cnt++;
+    f_hit[f0] = true;
+    f_hit[f1] = true;
+    return true;
+  });
+  if (f_cnt)
+    *f_cnt = std::count(f_hit.begin(), f_hit.end(), true);
+  return cnt;
+}
+
+} // namespace anti
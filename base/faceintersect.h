@@ -0,0 +1,110 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*!\file faceintersect.h
+ * \brief Find the faces of a model that intersect each other
+ */
+
+#ifndef FACEINTERSECT_H
+#define FACEINTERSECT_H
+
+#include <functional>
+#include <vector>
+
+#include "geometry.h"
+
+namespace anti {
+
+/// Find intersections between the faces of a model
+/**The face planes and bounding boxes are calculated once, and a tree of
+ * the bounding boxes limits the face pairs that are tested to those that
+ * are close together. Faces intersect if the interiors of both faces
+ * share more than a single point. Faces that only meet along their edges,
+ * or at a vertex, do not intersect. Winding numbers are used to find the
+ * interior of a face, so star polygons include their central regions.
+ * Faces with fewer than three vertices are not tested.*/
+class FaceIntersections {
+private:
+  struct FaceData {
+    Vec3d norm;     // unit normal, unset if the face is not tested
+    double offset;  // distance of plane from origin along the normal
+    Vec3d min, max; // bounding box, expanded by eps
+  };
+
+  struct Node {
+    Vec3d min, max;
+    int left;  // index of first child node, or -1 for a leaf
+    int right; // index of second child node
+    int start; // first position of the leaf faces in the face order
+    int end;   // one past the last position of the leaf faces
+  };
+
+  const Geometry &geom;
+  double eps;
+  std::vector<FaceData> f_data;
+  std::vector<Node> nodes;
+  std::vector<int> order; // face indexes, in tree leaf order
+
+  int build(int start, int end);
+  bool crossing_intersect(int f0, int f1, const Vec3d &dir) const;
+  bool coplanar_intersect(int f0, int f1) const;
+
+public:
+  /// Constructor
+  /**\param geom geometry to test, which must not be changed or destroyed
+   *  while the object is being used.
+   * \param eps value for controlling the limit of precision. */
+  FaceIntersections(const Geometry &geom, double eps = epsilon);
+
+  /// Check whether two faces intersect
+  /**\param f0 index of a face.
+   * \param f1 index of another face.
+   * \return \c true if the faces intersect, otherwise \c false. */
+  bool faces_intersect(int f0, int f1) const;
+
+  /// Find the faces whose bounding boxes overlap a box
+  /**\param min_coords the minimum coordinates of the box.
+   * \param max_coords the maximum coordinates of the box.
+   * \param f_idxs to return the face indexes. */
+  void faces_near(const Vec3d &min_coords, const Vec3d &max_coords,
+                  std::vector<int> &f_idxs) const;
+
+  /// Call a function for each pair of intersecting faces
+  /**\param func function called with the indexes of the faces, lower
+   *  index first, and which returns \c false to stop the search. */
+  void for_each_pair(const std::function<bool(int, int)> &func) const;
+
+  /// Check whether any faces intersect
+  /**\return \c true if any pair of faces intersect, otherwise \c false. */
+  bool any() const;
+
+  /// Count the pairs of faces that intersect
+  /**\param f_cnt if not \c nullptr, to return the number of faces that
+   *  intersect another face.
+   * \return The number of pairs of intersecting faces. */
+  long count(int *f_cnt = nullptr) const;
+};
+
+} // namespace anti
+
+#endif // FACEINTERSECT_H
@@ -28,6 +28,7 @@
 
 #include "geometryutils.h"
 #include "mathutils.h"
+#include "parallel.h"
 #include "private_geodesic.h"
 #include "private_misc.h"
 
@@ -138,12 +139,11 @@ inline int Geodesic::index_map(int i, int j, const vector<int> &indx, int p_idx)
   // polyhedron face interior
   if (pos.is_face()) {
     if (p_idx == noindex) {
-      auto mi = grid_idxs.find(int_pr(i, j));
-      if (mi == grid_idxs.end()) {
-        // fprintf(stderr, "not found in grid_idxs i=%d, j=%d\n", i, j);
+      if (i < 0 || j < 0 || i >= grid_sz || j >= grid_sz)
+        return noindex;
+      p_idx = grid_idxs[i * grid_sz + j];
+      if (p_idx == noindex)
         return noindex;
-      }
-      p_idx = mi->second;
     }
     int indx_no = V_sz + (F - 1) * base.edges().size() +
                   (F * F * (m * m + m * n + n * n) - F * 3 + 2) / 2 * indx[6] +
@@ -152,29 +152,16 @@ inline int Geodesic::index_map(int i, int j, const vector<int> &indx, int p_idx)
   }
 
   if (pos.is_out()) {
-    vector<int> edge(2);
-    if (y < 0) {
-      edge[0] = indx[0];
-      edge[1] = indx[1];
-    }
-    else if (x + y > freq) {
-      edge[0] = indx[1];
-      edge[1] = indx[2];
-    }
-    else { // x<0
-      edge[0] = indx[2];
-      edge[1] = indx[0];
-    }
-
-    int nf_pos = 1;
-    if (edge[0] > edge[1]) {
-      swap(edge[0], edge[1]);
-      nf_pos = 0;
-    }
-
-    auto mi_ef = edge_faces.find(edge);
-    int nf_idx = mi_ef->second[nf_pos]; // index of neighbouring face
-    if (nf_idx == -1)                   // no neighbouring face
+    int f_edge;
+    if (y < 0)
+      f_edge = 0;
+    else if (x + y > freq)
+      f_edge = 1;
+    else // x<0
+      f_edge = 2;
+
+    int nf_idx = face_nbrs[3 * indx[6] + f_edge]; // index of neighbouring face
+    if (nf_idx == -1)                             // no neighbouring face
       return noindex;
 
     const vector<int> &nface = base.faces()[nf_idx];
@@ -195,8 +182,7 @@ inline int Geodesic::index_map(int i, int j, const vector<int> &indx, int p_idx)
     // if(n_crds.second < n/2)
     //   return noindex;
 
-    vector<int> n_indx = make_face_indexes(nf_idx, nface);
-    return index_map(coord_i(n_crds), coord_j(n_crds), n_indx);
+    return index_map(coord_i(n_crds), coord_j(n_crds), face_indxs[nf_idx]);
   }
 
   return noindex; // should never get here!
@@ -231,23 +217,38 @@ void Geodesic::init()
   edge_faces = base.get_edge_face_pairs();
   map<vector<int>, vector<int>>::iterator mi;
 
+  int f_sz = base.faces().size();
+  face_indxs.resize(f_sz);
+  for (int i = 0; i < f_sz; i++)
+    face_indxs[i] = make_face_indexes(i, base.faces(i));
+
+  // neighbouring face across each face edge
+  face_nbrs.resize(3 * f_sz);
+  for (int i = 0; i < f_sz; i++) {
+    for (int j = 0; j < 3; j++) {
+      vector<int> edge = {base.faces(i, j), base.faces(i, (j + 1) % 3)};
+      int nf_pos = 1;
+      if (edge[0] > edge[1]) {
+        swap(edge[0], edge[1]);
+        nf_pos = 0;
+      }
+      face_nbrs[3 * i + j] = edge_faces.find(edge)->second[nf_pos];
+    }
+  }
+
+  // points on an edge are calculated by both faces, keep the last values
+  edge_last_face.assign(base.edges().size(), noindex);
+  for (int i = 0; i < f_sz; i++)
+    for (int e = 3; e < 6; e++)
+      edge_last_face[face_indxs[i][e]] = i;
+
   F = freq / (m * m + m * n + n * n);
   make_grid_idxs();
 }
 
-void clear_def_edges(Geometry &geom)
-{
-  vector<int> del_edges;
-  int e_sz = geom.edges().size();
-  for (int i = 0; i < e_sz; i++) {
-    if (!geom.colors(EDGES).get(i).is_set())
-      del_edges.push_back(i);
-  }
-  geom.del(EDGES, del_edges);
-}
-
 void Geodesic::make_geo(Geometry &geo)
 {
+  geo.clear_all();
   vector<Vec3d> &gverts = geo.raw_verts();
 
   gverts = base.verts();
@@ -266,37 +267,46 @@ void Geodesic::make_geo(Geometry &geo)
 
   gverts.resize(num_verts);
 
-  vector<vector<int>> orig_edges;
-  for (unsigned int i = 0; i < base.faces().size(); i++) {
-    vector<int> indx = make_face_indexes(i, base.faces(i));
-    grid_to_points(indx, gverts);
-    vector<vector<int>> new_face_tris;
-    grid_to_tris(indx, new_face_tris, orig_edges);
-    vector<vector<int>> &gfaces = geo.raw_faces();
-    gfaces.insert(gfaces.end(), new_face_tris.begin(), new_face_tris.end());
-    Color f_col = base.colors(FACES).get(int(i));
-    for (unsigned int f = gfaces.size() - new_face_tris.size();
-         f < gfaces.size(); f++)
-      geo.colors(FACES).set(int(f), f_col);
+  // base faces set separate vertices, and only the last face with an edge
+  // sets its points, so the faces can be processed in any order
+  int f_sz = base.faces().size();
+  vector<vector<int>> face_tris(f_sz); // triangles as flat index triples
+  vector<vector<vector<int>>> face_orig_edges(f_sz);
+  parallel_for(f_sz, [&](size_t i) {
+    grid_to_points(face_indxs[i], gverts);
+    grid_to_tris(face_indxs[i], face_tris[i], face_orig_edges[i]);
+  });
+
+  size_t tris_sz = 0;
+  for (const auto &tris : face_tris)
+    tris_sz += tris.size() / 3;
+
+  vector<vector<int>> &gfaces = geo.raw_faces();
+  gfaces.reserve(tris_sz);
+  for (int i = 0; i < f_sz; i++) {
+    Color f_col = base.colors(FACES).get(i);
+    const vector<int> &tris = face_tris[i];
+    for (size_t t = 0; t < tris.size(); t += 3) {
+      gfaces.push_back({tris[t], tris[t + 1], tris[t + 2]});
+      geo.colors(FACES).set(int(gfaces.size() - 1), f_col);
+    }
+    vector<int>().swap(face_tris[i]); // release memory as we go
   }
 
-  geo.add_missing_impl_edges();
-  // fprintf(stderr, "orig_edges.size()= %d\n", orig_edges.size());
-  for (auto &orig_edge : orig_edges) {
-    vector<int> edge(2);
-    edge[0] = orig_edge[0];
-    edge[1] = orig_edge[1];
-    const vector<vector<int>> &gedges = geo.edges();
-    int e_idx = find(gedges.begin(), gedges.end(), edge) - gedges.begin();
-    Color e_col = base.colors(EDGES).get(orig_edge[2]);
-    geo.colors(EDGES).set(e_idx, e_col);
-    // fprintf(stderr, "adding edge (%d, %d) col=%s\n", edge[0], edge[1],
-    // e_col.get_Vec4d().to_str());
-  }
-  clear_def_edges(geo);
+  // keep only edges along the original edges, if these are colored. A map
+  // gives the same order as the sorted implicit edges
+  map<vector<int>, Color> orig_cols;
+  for (const auto &orig_edges : face_orig_edges)
+    for (const auto &orig_edge : orig_edges)
+      orig_cols[{orig_edge[0], orig_edge[1]}] =
+          base.colors(EDGES).get(orig_edge[2]);
+
+  for (const auto &kp : orig_cols)
+    if (kp.second.is_set())
+      geo.add_edge(kp.first, kp.second);
 }
 
-void Geodesic::grid_to_points(vector<int> indx, vector<Vec3d> &gverts)
+void Geodesic::grid_to_points(const vector<int> &indx, vector<Vec3d> &gverts)
 {
   const vector<int> face = base.faces(indx[6]);
   // fprintf(stderr, "\n+++++++\t\t\t\tface %d = (%d, %d, %d)\n", indx[6],
@@ -344,6 +354,14 @@ void Geodesic::grid_to_points(vector<int> indx, vector<Vec3d> &gverts)
       if (pos.is_out() || pos.is_vert())
         continue;
 
+      if (pos.is_edge()) {
+        int e_idx = (pos == IJPos::e0) ? indx[3]
+                    : (pos == IJPos::e1) ? indx[4]
+                                         : indx[5];
+        if (edge_last_face[e_idx] != indx[6])
+          continue;
+      }
+
       int x = grid_x(i, j);
       int y = grid_y(i, j);
       int n[] = {x, y, freq - x - y};
@@ -375,26 +393,25 @@ void Geodesic::grid_to_points(vector<int> indx, vector<Vec3d> &gverts)
 
 void Geodesic::make_grid_idxs()
 {
-  int test_val = 2 * freq / (m + n);
+  grid_sz = 2 * freq / (m + n);
+  grid_idxs.assign((size_t)grid_sz * grid_sz, noindex);
   int idx = 0;
   // i and j at twice the corner angle (which lies inside the axes)
-  for (int i = 0; i < test_val - 1; i++)
-    for (int j = 0; j < test_val - 1; j++)
+  for (int i = 0; i < grid_sz - 1; i++)
+    for (int j = 0; j < grid_sz - 1; j++)
       if (get_pos(i, j).is_face())
-        grid_idxs[int_pr(i, j)] = idx++;
+        grid_idxs[i * grid_sz + j] = idx++;
 }
 
-inline vector<int> make_tri(int v0, int v1, int v2)
+inline void add_tri(vector<int> &tris, int v0, int v1, int v2)
 {
-  vector<int> tri(3);
-  tri[0] = v0;
-  tri[1] = v1;
-  tri[2] = v2;
-  return tri;
+  tris.push_back(v0);
+  tris.push_back(v1);
+  tris.push_back(v2);
 }
 
 int orig_edge(IJPos p0_pos, int p0_idx, IJPos p1_pos, int p1_idx,
-              vector<int> &indx, vector<int> &e_col)
+              const vector<int> &indx, vector<int> &e_col)
 {
   const int e_to_indx[] = {0, 5, 3, 1, 4, 3, 2, 7};
   int e_no = 0;
@@ -428,7 +445,7 @@ int orig_edge(IJPos p0_pos, int p0_idx, IJPos p1_pos, int p1_idx,
 }
 
 void add_orig_edges(IJPos p0_pos, int p0_idx, IJPos p1_pos, int p1_idx,
-                    IJPos p2_pos, int p2_idx, vector<int> &indx,
+                    IJPos p2_pos, int p2_idx, const vector<int> &indx,
                     vector<vector<int>> &e_cols)
 {
   vector<int> e_col;
@@ -468,7 +485,7 @@ inline bool Geodesic::tri_test(int i, int j, int di, int dj)
     return dj;
 }
 
-void Geodesic::grid_to_tris(vector<int> indx, vector<vector<int>> &new_tris,
+void Geodesic::grid_to_tris(const vector<int> &indx, vector<int> &new_tris,
                             vector<vector<int>> &orig_edges)
 {
   int p0_idx, p1_idx, p2_idx, p3_idx;
@@ -476,6 +493,12 @@ void Geodesic::grid_to_tris(vector<int> indx, vector<vector<int>> &new_tris,
   int test_val = 2 * freq / (m + n);
   for (int i = 0; i < test_val - 1; i++)
     for (int j = 0; j < test_val - 1; j++) {
+      // test first, as index_map is slow for points outside the face
+      bool tri0 = tri_test(i, j, 1, 0);
+      bool tri1 = tri_test(i, j, 0, 1);
+      if (!tri0 && !tri1)
+        continue;
+
       IJPos p0_pos = get_pos(i, j);
       IJPos p1_pos = get_pos(i + 1, j + 1);
       IJPos p2_pos = get_pos(i + 1, j);
@@ -484,20 +507,20 @@ void Geodesic::grid_to_tris(vector<int> indx, vector<vector<int>> &new_tris,
       p0_idx = index_map(i, j, indx);
       p1_idx = index_map(i + 1, j + 1, indx);
       if (p0_idx != noindex && p1_idx != noindex) {
-        if (tri_test(i, j, 1, 0)) {
+        if (tri0) {
           p2_idx = index_map(i + 1, j, indx);
           if (p2_idx != noindex) {
-            new_tris.push_back(make_tri(p0_idx, p1_idx, p2_idx));
+            add_tri(new_tris, p0_idx, p1_idx, p2_idx);
             if (m * n == 0)
               add_orig_edges(p0_pos, p0_idx, p1_pos, p1_idx, p2_pos, p2_idx,
                              indx, orig_edges);
           }
         }
 
-        if (tri_test(i, j, 0, 1)) {
+        if (tri1) {
           p3_idx = index_map(i, j + 1, indx);
           if (p3_idx != noindex) {
-            new_tris.push_back(make_tri(p1_idx, p0_idx, p3_idx));
+            add_tri(new_tris, p1_idx, p0_idx, p3_idx);
             if (m * n == 0)
               add_orig_edges(p1_pos, p1_idx, p0_pos, p0_idx, p3_pos, p3_idx,
                              indx, orig_edges);
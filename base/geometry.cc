@@ -517,9 +517,22 @@ void Geometry::add_missing_impl_edges(const Color &col)
       colors(EDGES).set(i, col);
   }
 
-  // restore original edges and colours
-  for (unsigned int e = 0; e < e_edges.size(); ++e)
-    add_edge(e_edges[e], cols.get(e));
+  // restore original edges and colours, as add_edge() but with the edges
+  // indexed so that many edges can be restored without repeated searches
+  map<vector<int>, int> edge_idx;
+  for (unsigned int i = 0; i < edges().size(); i++)
+    edge_idx.insert(std::make_pair(edges(i), (int)i));
+  for (unsigned int e = 0; e < e_edges.size(); ++e) {
+    vector<int> edge = e_edges[e];
+    if (edge[0] > edge[1])
+      swap(edge[0], edge[1]);
+    Color e_col = cols.get(e);
+    auto ei = edge_idx.find(edge);
+    if (ei != edge_idx.end())
+      colors(EDGES).set(ei->second, e_col);
+    else
+      edge_idx[edge] = add_edge_raw(edge, e_col);
+  }
 }
 
 } // namespace anti
@@ -30,6 +30,7 @@
 #include "geometryutils.h"
 #include "mathutils.h"
 #include "private_misc.h"
+#include "profile.h"
 
 #include <algorithm>
 #include <cstring>
@@ -547,6 +548,7 @@ void GeometryInfo::find_edge_face_pairs()
 
 void GeometryInfo::find_connectivity()
 {
+  ANTI_PROFILE_SCOPE("info: connectivity");
   // get a copy of edge face pairs with all faces around an edge
   map<vector<int>, vector<int>> tmp_efpairs;
   if (is_oriented())
@@ -601,6 +603,7 @@ static double face_vol(const Geometry &geom, int f_no, Vec3d *face_vol_cent)
 
 void GeometryInfo::find_f_areas()
 {
+  ANTI_PROFILE_SCOPE("info: face areas");
   int fsz = geom.faces().size();
   f_areas.resize(fsz);
   area.init();
@@ -641,6 +644,7 @@ void GeometryInfo::find_f_perimeters()
 
 void GeometryInfo::find_face_angles()
 {
+  ANTI_PROFILE_SCOPE("info: face angles");
   ang.init();
   num_angs = 0;
   map<vector<double>, int, AngleVectLess>::iterator fi;
@@ -685,6 +689,7 @@ void GeometryInfo::find_face_angles()
 
 void GeometryInfo::find_dihedral_angles()
 {
+  ANTI_PROFILE_SCOPE("info: dihedral angles");
   if (efpairs.size() == 0)
     find_edge_face_pairs();
   edge_dihedrals.resize(efpairs.size());
@@ -829,6 +834,7 @@ void GeometryInfo::find_vert_cons_orig()
 
 void GeometryInfo::find_vert_cons()
 {
+  ANTI_PROFILE_SCOPE("info: vertex connections");
   vert_cons.resize(num_verts(), vector<int>());
   vector<vector<int>> es = geom.edges();
   geom.get_impl_edges(es);
@@ -873,6 +879,7 @@ void GeometryInfo::find_face_cons()
 
 void GeometryInfo::find_vert_figs()
 {
+  ANTI_PROFILE_SCOPE("info: vertex figures");
   vert_figs.resize(num_verts());
   get_vert_cons();
   auto ef_pairs = geom.get_edge_face_pairs(false);
@@ -1028,6 +1035,7 @@ static double sph_tri_area(Vec3d u0, Vec3d u1, Vec3d u2)
 
 void GeometryInfo::find_solid_angles()
 {
+  ANTI_PROFILE_SCOPE("info: solid angles");
   if (!vert_cons_orig.size())
     find_vert_cons_orig();
 
@@ -1082,6 +1090,7 @@ void GeometryInfo::find_e_lengths(
     map<double, double_range_cnt, AngleLess> &e_lens,
     const vector<vector<int>> &edges, ElementLimits &lens)
 {
+  ANTI_PROFILE_SCOPE("info: edge lengths");
   lens.init();
   map<double, double_range_cnt, AngleLess>::iterator ei;
   for (const auto &edge : edges) {
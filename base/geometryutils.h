@@ -56,6 +56,54 @@ Status get_voronoi_cells(const std::vector<Vec3d> &verts,
                          std::vector<Geometry> *cells,
                          std::string qh_args = "");
 
+/// Get Voronoi cells, calculating each cell locally.
+/**Each cell is calculated independently, as the intersection of the
+ * half-spaces bounded by the planes bisecting its point and the nearby
+ * points, which are found with a spatial grid. The cells are calculated
+ * in parallel. The cells match those of \c get_voronoi_cells() to within
+ * \c eps, although the order of the vertices within a cell may differ.
+ * \param verts the vertices to find the Voronoi cells for
+ * \param cells to return the finite Voronoi cells, in vertex order
+ * \param eps a small number, coordinates differing by less than eps are
+ *  the same.
+ * \param num_threads the maximum number of threads to use, \c 0 for
+ *  the default.
+ * \param idxs the index numbers of the vertices to calculate the cells
+ *  for, in the order to return them, or \c nullptr for all the vertices.
+ * \return status, evaluates to \c true if the cells were calculated,
+ * otherwise false.*/
+Status get_voronoi_cells_local(const std::vector<Vec3d> &verts,
+                               std::vector<Geometry> *cells,
+                               double eps = epsilon, int num_threads = 0,
+                               const std::vector<int> *idxs = nullptr);
+
+/// Add the faces of the convex hull to each of a list of geometries.
+/**The hulls are calculated in parallel, each thread
+ * keeping its own qhull session.
+ * \param geoms the geometries.
+ * \param qh_args additional arguments to pass to qhull (unsupported,
+ *  may not work, check output.)
+ * \param num_threads the maximum number of threads to use, \c 0 for
+ *  the default.
+ * \return status, the first error, otherwise the first warning, with the
+ *  index number of the geometry that it applies to. */
+Status add_hulls(std::vector<Geometry> &geoms,
+                 const std::string &qh_args = "", int num_threads = 0);
+
+/// Set each of a list of geometries to its convex hull.
+/**The hulls are calculated in parallel, each thread
+ * keeping its own qhull session. A geometry is cleared if its hull could not be
+ * calculated.
+ * \param geoms the geometries.
+ * \param qh_args additional arguments to pass to qhull (unsupported,
+ *  may not work, check output.)
+ * \param num_threads the maximum number of threads to use, \c 0 for
+ *  the default.
+ * \return status, the first error, otherwise the first warning, with the
+ *  index number of the geometry that it applies to. */
+Status set_hulls(std::vector<Geometry> &geoms,
+                 const std::string &qh_args = "", int num_threads = 0);
+
 /// Get a star of vectors to use for making a zonohedron.
 /**\param geom geometry to get the star from
  * \param type the type of star to make can be
@@ -179,6 +227,26 @@ void sym_repeat(Geometry &geom, const Geometry &part, const Transformations &ts,
 bool sym_repeat(Geometry &geom, const Geometry &part, const Symmetry &sym,
                 char col_part_elems = ELEM_NONE, Coloring *clrngs = nullptr);
 
+/// Repeat a part by symmetry transformations, merging coincident elements
+/** Coincident vertices are identified from the vertex orbits of the part
+ *  under the symmetry group, rather than by comparing vertex positions
+ *  across the whole model. Edges and faces coincide when their vertices
+ *  coincide. Elements keep the colour of the first copy they occur in.
+ * \param geom geometry to return the final model.
+ * \param part geometry to be repeated.
+ * \param ts transformations to be used for the repeats, all elements of grp.
+ * \param grp the symmetry group transformations.
+ * \param col_part_elems element types, combining flags ELEM_VERTS,
+ *   ELEM_EDGES an ELEM_FACES, to be coloured, based on the
+ *   order position of the transformation that produced them.
+ * \param clrngs an array of three Colorings applied, correspondingly, to the
+ *  index coloured vertices, edges and faces.
+ * \return \c true if grp was a group containing ts, otherwise \c false. */
+bool sym_repeat_merged(Geometry &geom, const Geometry &part,
+                       const Transformations &ts, const Transformations &grp,
+                       char col_part_elems = ELEM_NONE,
+                       Coloring *clrngs = nullptr);
+
 /// Repeat a part by a set of symmetry transformations
 /**\param geom geometry to return the final model.
  * \param sym_to target symmetry.
@@ -29,10 +29,15 @@
 #include "../base/iteration.h"
 #include "../base/utils.h"
 
+#include <cerrno>
+#include <cmath>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace anti {
@@ -123,6 +128,335 @@ Status IterationControl::set_sig_digits(int digits)
   return stat;
 }
 
+Status IterationControl::check_solved(bool solved)
+{
+  if (solved) {
+    set_finished();
+    return Status::ok("solved, test value achieved");
+  }
+  else if (is_last_iter()) {
+    // reached last iteration without solving
+    set_finished();
+    return Status::warning("not solved, test value not achieved");
+  }
+  return Status::ok();
+}
+
+// Progress record file, closed when the last copy of the control goes
+struct IterationControl::RecordFile {
+  FILE *file = nullptr;
+  bool csv = false;
+  std::string header; // last CSV header written
+
+  ~RecordFile()
+  {
+    if (file != nullptr)
+      fclose(file);
+  }
+};
+
+Status IterationControl::set_record_file(const std::string &fname)
+{
+  auto rec = std::make_shared<RecordFile>();
+  rec->file = fopen(fname.c_str(), "w");
+  if (rec->file == nullptr)
+    return Status::error(msg_str("could not open record file '%s': %s",
+                                 fname.c_str(), strerror(errno)));
+
+  const std::string csv_ext = ".csv";
+  rec->csv = fname.size() > csv_ext.size() &&
+             fname.compare(fname.size() - csv_ext.size(), csv_ext.size(),
+                           csv_ext) == 0;
+  rec_file = rec;
+  return Status::ok();
+}
+
+namespace {
+
+// Write a number, JSON has no representation for inf or nan
+void write_number(FILE *file, double val, bool csv)
+{
+  if (!csv && !std::isfinite(val))
+    fprintf(file, "null");
+  else
+    fprintf(file, "%.17g", val);
+}
+
+// Write a string as a quoted CSV or JSON string
+void write_string(FILE *file, const std::string &str, bool csv)
+{
+  fputc('"', file);
+  for (char c : str) {
+    if (csv) {
+      if (c == '"')
+        fputc('"', file);
+      fputc(c, file);
+    }
+    else if (c == '"' || c == '\\')
+      fprintf(file, "\\%c", c);
+    else if ((unsigned char)c < 0x20)
+      fprintf(file, "\\u%04x", c);
+    else
+      fputc(c, file);
+  }
+  fputc('"', file);
+}
+
+} // namespace
+
+void IterationControl::record(
+    double residual,
+    std::initializer_list<std::pair<const char *, double>> fields,
+    const std::string &msg)
+{
+  if (!rec_file)
+    return;
+
+  // write on periodic status report iterations and the final iteration
+  bool is_final = finished || is_last_iter();
+  bool periodic = status_check_and_report_iters > 0 &&
+                  (current_iter == 1 ||
+                   current_iter % status_check_and_report_iters == 0);
+  if (!is_final && !periodic)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  double time = std::chrono::duration<double>(now - start_time).count();
+
+  // a final record gives the rate over the whole iteration
+  long iters;
+  double secs;
+  if (is_final) {
+    iters = (long)current_iter - start_rec_iter;
+    secs = time;
+  }
+  else {
+    iters = (long)current_iter - last_rec_iter;
+    secs = std::chrono::duration<double>(now - last_rec_time).count();
+  }
+  double rate = (secs > 0) ? iters / secs : 0.0;
+  const char *type = (is_final) ? "final" : "iter";
+
+  FILE *file = rec_file->file;
+  bool csv = rec_file->csv;
+  if (csv) {
+    // write a header when the fields change
+    std::string header = "type,iter,time,iters_per_sec,residual";
+    for (const auto &field : fields)
+      header += std::string(",") + field.first;
+    header += ",message";
+    if (header != rec_file->header) {
+      fprintf(file, "%s\n", header.c_str());
+      rec_file->header = header;
+    }
+    fprintf(file, "%s,%u,%.6f,%.6g,", type, current_iter, time, rate);
+    write_number(file, residual, csv);
+    for (const auto &field : fields) {
+      fputc(',', file);
+      write_number(file, field.second, csv);
+    }
+    fputc(',', file);
+    write_string(file, msg, csv);
+  }
+  else {
+    fprintf(file,
+            "{\"type\":\"%s\",\"iter\":%u,\"time\":%.6f,"
+            "\"iters_per_sec\":%.6g,\"residual\":",
+            type, current_iter, time, rate);
+    write_number(file, residual, csv);
+    for (const auto &field : fields) {
+      fputc(',', file);
+      write_string(file, field.first, csv);
+      fputc(':', file);
+      write_number(file, field.second, csv);
+    }
+    if (!msg.empty()) {
+      fprintf(file, ",\"message\":");
+      write_string(file, msg, csv);
+    }
+    fputc('}', file);
+  }
+  fputc('\n', file);
+  if (is_final)
+    fflush(file);
+
+  last_rec_time = now;
+  last_rec_iter = current_iter;
+}
+
+// Checkpoint read from a file, resumed only once
+struct IterationControl::Checkpoint {
+  std::string stage;
+  unsigned int iter = 0;
+  std::vector<Vec3d> verts;
+  std::vector<double> state;
+  bool pending = true;
+};
+
+namespace {
+
+// Checkpoint file layout, in native byte order: the magic string, then
+// the stage name length and characters, the iteration number, the
+// number of vertices and the number of state values as 32-bit unsigned
+// integers, then the vertex coordinates and the state values as doubles
+const char ckpt_magic[] = "ANTICKP1";
+const size_t ckpt_magic_len = sizeof(ckpt_magic) - 1;
+
+bool write_uint32(FILE *file, uint32_t val)
+{
+  return fwrite(&val, sizeof(val), 1, file) == 1;
+}
+
+bool read_uint32(FILE *file, uint32_t *val)
+{
+  return fread(val, sizeof(*val), 1, file) == 1;
+}
+
+} // namespace
+
+Status IterationControl::set_checkpoint_file(const std::string &fname)
+{
+  // checkpoints are written to a temporary file which then replaces the
+  // checkpoint file, check that a temporary file can be written alongside
+  // it without creating or changing the checkpoint file itself
+  std::string tmp_fname = get_tmp_file_name(fname);
+  FILE *file = fopen(tmp_fname.c_str(), "wb");
+  if (file == nullptr)
+    return Status::error(msg_str("could not write checkpoint file '%s': %s",
+                                 fname.c_str(), strerror(errno)));
+  fclose(file);
+  remove(tmp_fname.c_str());
+  ckpt_fname = fname;
+  return Status::ok();
+}
+
+Status IterationControl::set_resume_file(const std::string &fname)
+{
+  FILE *file = fopen(fname.c_str(), "rb");
+  if (file == nullptr)
+    return Status::error(msg_str("could not open checkpoint file '%s': %s",
+                                 fname.c_str(), strerror(errno)));
+
+  auto ckpt = std::make_shared<Checkpoint>();
+  char magic[ckpt_magic_len];
+  uint32_t stage_len, iter, num_verts, num_state;
+  bool valid =
+      fread(magic, 1, ckpt_magic_len, file) == ckpt_magic_len &&
+      memcmp(magic, ckpt_magic, ckpt_magic_len) == 0 &&
+      read_uint32(file, &stage_len) && stage_len < 1024;
+  if (valid) {
+    ckpt->stage.resize(stage_len);
+    valid = fread(&ckpt->stage[0], 1, stage_len, file) == stage_len &&
+            read_uint32(file, &iter) && read_uint32(file, &num_verts) &&
+            read_uint32(file, &num_state);
+  }
+  if (valid) {
+    ckpt->iter = iter;
+    ckpt->verts.resize(num_verts);
+    ckpt->state.resize(num_state);
+    double coords[3];
+    for (auto &v : ckpt->verts) {
+      valid = valid && fread(coords, sizeof(double), 3, file) == 3;
+      v = Vec3d(coords[0], coords[1], coords[2]);
+    }
+    valid = valid && fread(ckpt->state.data(), sizeof(double), num_state,
+                           file) == num_state;
+  }
+  fclose(file);
+
+  if (!valid)
+    return Status::error(
+        msg_str("invalid or truncated checkpoint file '%s'", fname.c_str()));
+
+  resume_ckpt = ckpt;
+  return Status::ok();
+}
+
+std::string IterationControl::get_resume_stage() const
+{
+  return (is_resume_pending()) ? resume_ckpt->stage : std::string();
+}
+
+bool IterationControl::is_resume_pending() const
+{
+  return resume_ckpt && resume_ckpt->pending;
+}
+
+bool IterationControl::is_checkpoint_iter() const
+{
+  return !ckpt_fname.empty() && !is_setup_iter() && !finished &&
+         !is_last_iter() && status_check_and_report_iters > 0 &&
+         current_iter % status_check_and_report_iters == 0;
+}
+
+Status IterationControl::checkpoint(const std::vector<Vec3d> &verts,
+                                    std::initializer_list<double> state)
+{
+  // write to a temporary file so an interrupted write leaves the previous
+  // checkpoint intact
+  Status stat;
+  std::string tmp_fname = get_tmp_file_name(ckpt_fname);
+  FILE *file = fopen(tmp_fname.c_str(), "wb");
+  if (file == nullptr)
+    stat.set_error(msg_str("could not open checkpoint file '%s': %s",
+                           tmp_fname.c_str(), strerror(errno)));
+  else {
+    bool ok =
+        fwrite(ckpt_magic, 1, ckpt_magic_len, file) == ckpt_magic_len &&
+        write_uint32(file, stage.size()) &&
+        fwrite(stage.data(), 1, stage.size(), file) == stage.size() &&
+        write_uint32(file, current_iter) && write_uint32(file, verts.size()) &&
+        write_uint32(file, state.size());
+    for (const auto &v : verts)
+      ok = ok && fwrite(v.get_v(), sizeof(double), 3, file) == 3;
+    for (double val : state)
+      ok = ok && fwrite(&val, sizeof(val), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+      stat.set_error(
+          msg_str("could not write checkpoint file '%s'", tmp_fname.c_str()));
+    else if (rename(tmp_fname.c_str(), ckpt_fname.c_str()) != 0)
+      stat.set_error(msg_str("could not replace checkpoint file '%s': %s",
+                             ckpt_fname.c_str(), strerror(errno)));
+    if (stat.is_error())
+      remove(tmp_fname.c_str());
+  }
+
+  if (stat.is_error())
+    print("warning: %s\n", stat.c_msg());
+  return stat;
+}
+
+Status IterationControl::resume(std::vector<Vec3d> &verts,
+                                std::initializer_list<double *> state)
+{
+  if (!is_resume_pending() || resume_ckpt->stage != stage)
+    return Status::ok();
+
+  const Checkpoint &ckpt = *resume_ckpt;
+  if (ckpt.verts.size() != verts.size())
+    return Status::error(
+        msg_str("checkpoint has %d vertices, but the model has %d",
+                (int)ckpt.verts.size(), (int)verts.size()));
+  if (ckpt.state.size() != state.size())
+    return Status::error("checkpoint was not written by this solver");
+  if (ckpt.iter >= max_iters)
+    return Status::error(
+        msg_str("checkpoint iteration %u is not less than the maximum "
+                "number of iterations",
+                ckpt.iter));
+
+  verts = ckpt.verts;
+  auto val = ckpt.state.begin();
+  for (double *var : state)
+    *var = *val++;
+  resume_iter = ckpt.iter + 1;
+  resume_ckpt->pending = false;
+
+  print("Resuming from checkpoint at iteration %u\n", ckpt.iter);
+  return Status::ok();
+}
+
 int IterationControl::print(const char *fmt, ...) const
 {
   int ret = 0;
@@ -29,10 +29,18 @@
 #ifndef ITERATION_H
 #define ITERATION_H
 
+#include <chrono>
 #include <cmath>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "const.h"
+#include "profile.h"
 #include "status.h"
+#include "vec3d.h"
 
 namespace anti {
 
@@ -106,14 +114,22 @@ public:
   FILE *get_stream() const { return stream; }
 
   /// Set iteration counter to start, with initial loop to setup variables
-  /**Test for the initial setup loop with \c is_iterating() */
+  /**Test for the initial setup loop with \c is_iterating(). If \c resume()
+   * has restored a checkpoint then the counter starts at the iteration
+   * following the checkpoint. */
   void start_iter_with_setup() { set_current_iter(0); }
 
   /// Set iteration counter to start
+  /**If \c resume() has restored a checkpoint then the counter starts at
+   * the iteration following the checkpoint. */
   void start_iter() { set_current_iter(1); }
 
   /// Increment iteration counter
-  void next_iter() { current_iter++; }
+  void next_iter()
+  {
+    current_iter++;
+    ANTI_PROFILE_COUNT("solver iterations", 1);
+  }
 
   /// Indicate iteration loop should finish
   bool is_done() { return is_end_iter() || is_finished(); }
@@ -138,6 +154,12 @@ public:
   /**\param finishd \c true to set finished, \c false to set not finished */
   void set_finished(bool finishd = true) { finished = finishd; }
 
+  /// Finish if a test value has been achieved, or on the last iteration
+  /**\param solved \c true if the test value has been achieved
+   * \return If finished, \c ok with a message if solved, otherwise
+   *  \c warning with a message. If not finished, \c ok with no message. */
+  Status check_solved(bool solved);
+
   /// Is the current iteration just setting up variable
   /**\return \c true a variable setup iteration, \c false a normal
    *         model-modifying iteration. */
@@ -184,14 +206,123 @@ public:
    * \return number of characters printed */
   int print(const char *fmt, ...) const;
 
+  /// Set a file for writing progress records
+  /**Solvers write a record on each periodic status report iteration,
+   * and a final record, even if no status reports are printed. The
+   * records are written as CSV if the file name ends in \c .csv,
+   * otherwise as JSON lines, one object per record.
+   * \param fname the file name
+   * \return status, evaluates to \c true if the file was opened,
+   *  otherwise \c false.*/
+  Status set_record_file(const std::string &fname);
+
+  /// Are progress records being written
+  /**\return \c true if progress records are being written. */
+  bool is_recording() const { return rec_file != nullptr; }
+
+  /// Write a progress record, if progress records are being written
+  /**Call on status check iterations, a record is only written on a
+   * periodic status report iteration or the final iteration. A record
+   * holds the record type, the iteration number, the time in seconds
+   * since the iteration started, the iterations per second since the
+   * previous record, the residual, the solver fields and a message.
+   * The record type is \c iter, or \c final when the iteration has
+   * finished or is the last iteration, and a final record gives the
+   * iterations per second over the whole iteration.
+   * \param residual the value that is tested for completion
+   * \param fields names and values of solver-specific fields
+   * \param msg a message, usually the reason for finishing */
+  void record(double residual,
+              std::initializer_list<std::pair<const char *, double>> fields =
+                  {},
+              const std::string &msg = std::string());
+
+  /// Set a file for writing checkpoints
+  /**Solvers write a checkpoint on each periodic status report iteration,
+   * replacing the previous checkpoint. A checkpoint holds the stage, the
+   * iteration number, the vertex coordinates and the solver state, in a
+   * binary file for resuming on the same kind of machine.
+   * \param fname the file name
+   * \return status, evaluates to \c true if the file can be written,
+   *  otherwise \c false.*/
+  Status set_checkpoint_file(const std::string &fname);
+
+  /// Get the file for writing checkpoints
+  /**\return the file name, or an empty string if checkpoints are not
+   *  being written. */
+  const std::string &get_checkpoint_file() const { return ckpt_fname; }
+
+  /// Set a checkpoint file to resume from
+  /**The checkpoint is read immediately, and the first solver that calls
+   * \c resume() in the same stage continues from it. The solver should
+   * be run on the same model with the same options.
+   * \param fname the file name
+   * \return status, evaluates to \c true if a checkpoint was read,
+   *  otherwise \c false.*/
+  Status set_resume_file(const std::string &fname);
+
+  /// Set the stage
+  /**The stage distinguishes checkpoints from programs that run more than
+   * one solver, a solver only resumes a checkpoint from the same stage.
+   * \param stage_name the stage name */
+  void set_stage(const std::string &stage_name) { stage = stage_name; }
+
+  /// Get the stage of the checkpoint waiting to be resumed
+  /**\return the stage name, or an empty string if there is no checkpoint
+   *  waiting to be resumed. */
+  std::string get_resume_stage() const;
+
+  /// Is there a checkpoint waiting to be resumed
+  /**\return \c true if a checkpoint was read and has not been resumed. */
+  bool is_resume_pending() const;
+
+  /// Should a checkpoint be written on the current iteration
+  /**\return \c true on a periodic status report iteration, if
+   *  checkpoints are being written and the iteration has not finished.*/
+  bool is_checkpoint_iter() const;
+
+  /// Write a checkpoint
+  /**Call at the end of an iteration, a failure to write the checkpoint
+   * is reported on the report stream and does not stop the iteration.
+   * \param verts the vertex coordinates
+   * \param state values of the solver variables that are carried from one
+   *  iteration to the next
+   * \return status, evaluates to \c true if the checkpoint was written,
+   *  otherwise \c false.*/
+  Status checkpoint(const std::vector<Vec3d> &verts,
+                    std::initializer_list<double> state = {});
+
+  /// Resume from a checkpoint
+  /**If a checkpoint from the current stage is waiting to be resumed then
+   * restore the vertex coordinates and the solver state, and start the
+   * next iteration loop after the checkpoint iteration. A message is
+   * printed on the report stream when resuming. Call before the
+   * iteration loop.
+   * \param verts the vertex coordinates, replaced if resuming
+   * \param state pointers to the solver variables, in the order they
+   *  were passed to \c checkpoint(), set if resuming
+   * \return status, evaluates to \c false if the checkpoint does not
+   *  match the model or the solver, otherwise \c true.*/
+  Status resume(std::vector<Vec3d> &verts,
+                std::initializer_list<double *> state = {});
+
 private:
   void set_current_iter(unsigned int iter)
   {
-    current_iter = iter;
+    // continue after a resumed checkpoint
+    current_iter = (resume_iter) ? resume_iter : iter;
+    resume_iter = 0;
     finished = false;
+    start_time = std::chrono::steady_clock::now();
+    last_rec_time = start_time;
+    start_rec_iter = (long)current_iter - 1;
+    last_rec_iter = start_rec_iter;
   }
   Status check_reporting();
 
+  struct RecordFile;
+  struct Checkpoint;
+
   static const unsigned unlimited;
   unsigned int current_iter = 0;
   unsigned int max_iters = 10000;
@@ -200,6 +331,20 @@ private:
   int sig_digits = 13;
   FILE *stream = stderr;
   bool finished = false;
+
+  // progress records, the file is shared by copies
+  std::shared_ptr<RecordFile> rec_file;
+  std::chrono::steady_clock::time_point start_time;
+  std::chrono::steady_clock::time_point last_rec_time;
+  long start_rec_iter = 0; // iteration before the first iteration
+  long last_rec_iter = 0;
+
+  // checkpoints, a checkpoint to resume is shared by copies and only
+  // resumed once
+  std::string stage;
+  std::string ckpt_fname;
+  std::shared_ptr<Checkpoint> resume_ckpt;
+  unsigned int resume_iter = 0;
 };
 
 }; // namespace anti
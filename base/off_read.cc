@@ -29,6 +29,7 @@
 #include "polygon.h"
 #include "private_off_file.h"
 #include "private_std_polys.h"
+#include "profile.h"
 #include "utils.h"
 
 #include <algorithm>
@@ -179,6 +180,7 @@ Status add_face(Geometry &geom, vector<char *> vals, Geometry &alt_cols,
 
 Status off_file_read(FILE *ifile, Geometry &geom)
 {
+  ANTI_PROFILE_SCOPE("off_read");
   int file_line_no = 0; // line number in the file
 
   // read OFF type
@@ -27,6 +27,8 @@
 */
 
 #include "private_off_file.h"
+#include "profile.h"
+#include "textwriter.h"
 #include "utils.h"
 
 #include <algorithm>
@@ -37,7 +39,6 @@
 #include <cstring>
 #include <vector>
 
-using std::map;
 using std::string;
 using std::vector;
 
@@ -60,11 +61,18 @@ void file_close_w(FILE *ofile)
     fclose(ofile);
 }
 
+static void crds_write(TextWriter &out, const Geometry &geom, const char *sep,
+                       int sig_dgts)
+{
+  for (const auto &v : geom.verts())
+    out.put_vec(v, sep, sig_dgts).put('\n');
+}
+
 void crds_write(FILE *ofile, const Geometry &geom, const char *sep,
                 int sig_dgts)
 {
-  for (unsigned int i = 0; i < geom.verts().size(); i++)
-    fprintf(ofile, "%s\n", geom.verts(i).to_str(sep, sig_dgts).c_str());
+  TextWriter out(ofile);
+  crds_write(out, geom, sep, sig_dgts);
 }
 
 Status crds_write(string file_name, const Geometry &geom, const char *sep,
@@ -109,22 +117,21 @@ public:
   }
 };
 
-} // namespace
-
-string off_col(Color col)
+// write a colour as its values, or as an index with a leading space
+void put_off_col(TextWriter &out, const Color &col)
 {
   if (col.is_index())
-    return msg_str(" %d", col.get_index());
+    out.put(' ').put_int(col.get_index());
   else if (col.is_value()) {
     if (col.get_transparency())
-      return col.get_vec4d().to_str(" ", -5);
+      out.put_vec(col.get_vec4d(), " ", -5);
     else
-      return col.get_vec3d().to_str(" ", -5);
+      out.put_vec(col.get_vec3d(), " ", -5);
   }
-  else
-    return string();
 }
 
+} // namespace
+
 void write_mtl_color(FILE *mfile, Color c)
 {
   fprintf(mfile, "newmtl color_%02x%02x%02x%02x\n", c[0], c[1], c[2], c[3]);
@@ -165,12 +172,13 @@ void obj_write(FILE *ofile, FILE *mfile, string mtl_file, const Geometry &geom,
   int offset = 1; // obj files start indexes from 1
 
   vector<Color> cols;
+  TextWriter out(ofile);
 
-  fprintf(ofile, "# File type: ASCII OBJ\n");
+  out.put("# File type: ASCII OBJ\n");
 
   // materials file reference as string
   if (mfile)
-    fprintf(ofile, "mtllib %s\n", mtl_file.c_str());
+    out.put("mtllib ").put(mtl_file).put('\n');
 
   // v entries
   for (unsigned int i = 0; i < geom.verts().size(); i++) {
@@ -181,8 +189,9 @@ void obj_write(FILE *ofile, FILE *mfile, string mtl_file, const Geometry &geom,
     else if (!c.is_invisible()) {
       c.set_alpha(255); // future transparency possible?
     }
-    fprintf(ofile, "v %s %s\n", geom.verts(i).to_str(sep, sig_dgts).c_str(),
-            off_col(c).c_str());
+    out.put("v ").put_vec(geom.verts(i), sep, sig_dgts).put(' ');
+    put_off_col(out, c);
+    out.put('\n');
   }
 
   Color last_color = Color();
@@ -199,17 +208,17 @@ void obj_write(FILE *ofile, FILE *mfile, string mtl_file, const Geometry &geom,
       // first color might be unset
       if (c != last_color || i == 0) {
         if (c.is_value() && !c.is_invisible())
-          fprintf(ofile, "usemtl color_%02x%02x%02x%02x\n", c[0], c[1], c[2],
-                  c[3]);
+          out.printf("usemtl color_%02x%02x%02x%02x\n", c[0], c[1], c[2],
+                     c[3]);
         else
-          fprintf(ofile, "usemtl color_face_default\n");
+          out.put("usemtl color_face_default\n");
       }
       last_color = c;
     }
-    fprintf(ofile, "f");
-    for (unsigned int j = 0; j < geom.faces(i).size(); j++)
-      fprintf(ofile, " %d", geom.faces(i, j) + offset);
-    fprintf(ofile, "\n");
+    out.put('f');
+    for (int idx : geom.faces(i))
+      out.put(' ').put_int(idx + offset);
+    out.put('\n');
   }
 
   last_color = Color();
@@ -233,8 +242,8 @@ void obj_write(FILE *ofile, FILE *mfile, string mtl_file, const Geometry &geom,
           last_color = c;
         }
     */
-    fprintf(ofile, "l %d %d\n", geom.edges(i, 0) + offset,
-            geom.edges(i, 1) + offset);
+    out.put("l ").put_int(geom.edges(i, 0) + offset);
+    out.put(' ').put_int(geom.edges(i, 1) + offset).put('\n');
   }
 
   if (mfile)
@@ -284,35 +293,37 @@ Status off_file_write(string file_name, const vector<const Geometry *> &geoms,
   return Status::ok();
 }
 
-void off_polys_write(FILE *ofile, const Geometry &geom, int offset)
+static void off_polys_write(TextWriter &out, const Geometry &geom, int offset)
 {
+  const auto &f_cols = geom.colors(FACES);
   for (unsigned int i = 0; i < geom.faces().size(); i++) {
-    fprintf(ofile, "%lu", (unsigned long)geom.faces(i).size());
-    for (unsigned int j = 0; j < geom.faces(i).size(); j++) {
-      fprintf(ofile, " %d", geom.faces(i, j) + offset);
-    }
-    fprintf(ofile, " %s", off_col(geom.colors(FACES).get(i)).c_str());
-    fprintf(ofile, "\n");
+    out.put_int(geom.faces(i).size());
+    for (int idx : geom.faces(i))
+      out.put(' ').put_int(idx + offset);
+    out.put(' ');
+    put_off_col(out, f_cols.get(i));
+    out.put('\n');
   }
 
+  const auto &e_cols = geom.colors(EDGES);
   for (unsigned int i = 0; i < geom.edges().size(); i++) {
-    fprintf(ofile, "2 %d %d", geom.edges(i, 0) + offset,
-            geom.edges(i, 1) + offset);
-    fprintf(ofile, " %s", off_col(geom.colors(EDGES).get(i)).c_str());
-    fprintf(ofile, "\n");
+    out.put("2 ").put_int(geom.edges(i, 0) + offset);
+    out.put(' ').put_int(geom.edges(i, 1) + offset).put(' ');
+    put_off_col(out, e_cols.get(i));
+    out.put('\n');
   }
   // print coloured vertex elements
-  map<int, Color>::const_iterator mi;
-  for (mi = geom.colors(VERTS).get_properties().begin();
-       mi != geom.colors(VERTS).get_properties().end(); mi++) {
-    fprintf(ofile, "1 %d %s\n", (mi->first) + offset,
-            off_col(mi->second).c_str());
+  for (const auto &kp : geom.colors(VERTS).get_properties()) {
+    out.put("1 ").put_int(kp.first + offset).put(' ');
+    put_off_col(out, kp.second);
+    out.put('\n');
   }
 }
 
 void off_file_write(FILE *ofile, const vector<const Geometry *> &geoms,
                     int sig_dgts)
 {
+  ANTI_PROFILE_SCOPE("off_write");
   int vert_cnt = 0, face_cnt = 0, edge_cnt = 0;
   for (auto geom : geoms) {
     int num_v_col_elems = geom->colors(VERTS).get_properties().size();
@@ -321,16 +332,16 @@ void off_file_write(FILE *ofile, const vector<const Geometry *> &geoms,
     face_cnt += geom->faces().size() + num_v_col_elems + edge_cnt;
   }
 
-  fprintf(ofile, "OFF\n%d %d 0\n", vert_cnt, face_cnt);
+  TextWriter out(ofile);
+  out.printf("OFF\n%d %d 0\n", vert_cnt, face_cnt);
 
   for (auto geom : geoms)
-    crds_write(ofile, *geom, " ", sig_dgts);
+    crds_write(out, *geom, " ", sig_dgts);
 
   int last_offset = 0;
   vert_cnt = 0;
   for (auto geom : geoms) {
-    off_polys_write(ofile, *geom,
-                    geom->verts().size() ? vert_cnt : last_offset);
+    off_polys_write(out, *geom, geom->verts().size() ? vert_cnt : last_offset);
     last_offset = vert_cnt;
     vert_cnt += geom->verts().size();
   }
@@ -0,0 +1,395 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file parallel.cc
+   \brief Support for running independent work in parallel
+*/
+
+#include "parallel.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::thread;
+using std::vector;
+
+namespace anti {
+
+namespace {
+
+// blocks per thread for parallel_for, so that uneven blocks can be balanced
+const size_t blocks_per_thread = 4;
+// blocks for a deterministic reduction, which must not depend on the threads
+const size_t reduce_blocks = 64;
+// a reduction block has at least this many indices, unless there is only
+// one block, so that small reductions run in the calling thread
+const size_t min_reduce_block = 1024;
+
+int max_threads = 0; // 0 until set, or read from the environment
+bool deterministic_reduce = true;
+std::once_flag env_once;
+
+int get_hardware_threads()
+{
+  int num = (int)thread::hardware_concurrency();
+  return (num > 0) ? num : 1;
+}
+
+Status apply_setting(const string &setting)
+{
+  Split parts(setting, ",");
+  if (parts.size() < 1 || parts.size() > 2)
+    return Status::error(
+        "threads setting must be a number, optionally followed by ',f'");
+
+  int num;
+  Status stat = read_int(parts[0], &num);
+  if (stat.is_error())
+    return Status::error("number of threads: " + stat.msg());
+  if (num < 0)
+    return Status::error("number of threads cannot be negative");
+
+  bool deterministic = true;
+  if (parts.size() == 2) {
+    if (strcmp(parts[1], "f") != 0)
+      return Status::error(
+          msg_str("reduction mode '%s' is not 'f'", parts[1]));
+    deterministic = false;
+  }
+
+  max_threads = (num > 0) ? num : get_hardware_threads();
+  deterministic_reduce = deterministic;
+  return Status::ok();
+}
+
+// Apply ANTIPRISM_THREADS, if it is set and valid, before any other setting
+void read_env_setting()
+{
+  std::call_once(env_once, []() {
+    const char *env = getenv("ANTIPRISM_THREADS");
+    if (env)
+      apply_setting(env); // an invalid setting is ignored
+  });
+}
+
+// A range of blocks for a parallel operation
+struct Job {
+  const std::function<void(size_t, size_t, size_t)> *func;
+  size_t num;
+  size_t num_blocks;
+  size_t remaining;             // blocks not finished, guarded by mtx
+  std::exception_ptr exception; // first exception thrown, guarded by mtx
+  std::mutex mtx;
+  std::condition_variable done;
+};
+
+struct Task {
+  Job *job;
+  size_t block;
+};
+
+// Tasks are pushed and popped at the back by the owning thread, and
+// stolen from the front by other threads
+struct TaskQueue {
+  std::mutex mtx;
+  std::deque<Task> tasks;
+};
+
+// Queue 0 is shared by threads outside the pool, the workers have
+// queues 1 to num_workers
+thread_local size_t this_queue = 0;
+
+class ThreadPool {
+private:
+  vector<std::unique_ptr<TaskQueue>> queues;
+  vector<thread> workers;
+  std::atomic<size_t> queued;
+  std::atomic<int> active_jobs;
+  std::mutex mtx;
+  std::condition_variable work_available;
+  bool stopping = false;
+
+  bool pop_back(size_t q, Task &task);
+  bool steal_front(size_t q, Task &task);
+  bool take_task(size_t q, Task &task);
+  void execute(const Task &task);
+  void worker_loop(size_t q);
+
+public:
+  ThreadPool(int num_workers);
+  ~ThreadPool();
+
+  int get_num_workers() const { return (int)workers.size(); }
+  bool is_idle() const { return active_jobs == 0; }
+  void add_job() { active_jobs++; }
+  void run(Job &job); // for a job counted by add_job()
+};
+
+ThreadPool::ThreadPool(int num_workers) : queued(0), active_jobs(0)
+{
+  for (int i = 0; i <= num_workers; i++)
+    queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue));
+  for (int i = 1; i <= num_workers; i++)
+    workers.emplace_back(&ThreadPool::worker_loop, this, (size_t)i);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  work_available.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+}
+
+bool ThreadPool::pop_back(size_t q, Task &task)
+{
+  std::lock_guard<std::mutex> lock(queues[q]->mtx);
+  auto &tasks = queues[q]->tasks;
+  if (tasks.empty())
+    return false;
+  task = tasks.back();
+  tasks.pop_back();
+  queued--;
+  return true;
+}
+
+bool ThreadPool::steal_front(size_t q, Task &task)
+{
+  std::lock_guard<std::mutex> lock(queues[q]->mtx);
+  auto &tasks = queues[q]->tasks;
+  if (tasks.empty())
+    return false;
+  task = tasks.front();
+  tasks.pop_front();
+  queued--;
+  return true;
+}
+
+bool ThreadPool::take_task(size_t q, Task &task)
+{
+  if (queued == 0)
+    return false;
+  if (pop_back(q, task))
+    return true;
+  for (size_t i = 1; i < queues.size(); i++)
+    if (steal_front((q + i) % queues.size(), task))
+      return true;
+  return false;
+}
+
+void ThreadPool::execute(const Task &task)
+{
+  Job &job = *task.job;
+  std::exception_ptr exception;
+  try {
+    const size_t begin = task.block * job.num / job.num_blocks;
+    const size_t end = (task.block + 1) * job.num / job.num_blocks;
+    (*job.func)(task.block, begin, end);
+  } catch (...) {
+    exception = std::current_exception();
+  }
+
+  // the waiting thread may destroy the job once the lock is released
+  std::lock_guard<std::mutex> lock(job.mtx);
+  if (exception && !job.exception)
+    job.exception = exception;
+  if (--job.remaining == 0)
+    job.done.notify_all();
+}
+
+void ThreadPool::worker_loop(size_t q)
+{
+  this_queue = q;
+  Task task;
+  while (true) {
+    if (take_task(q, task)) {
+      execute(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    work_available.wait(lock, [&]() { return stopping || queued > 0; });
+    if (stopping)
+      return;
+  }
+}
+
+void ThreadPool::run(Job &job)
+{
+  const size_t q = this_queue;
+  {
+    // queued so that the owner takes the blocks in increasing order
+    std::lock_guard<std::mutex> lock(queues[q]->mtx);
+    for (size_t b = job.num_blocks; b-- > 0;)
+      queues[q]->tasks.push_back({&job, b});
+    queued += job.num_blocks;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+  }
+  work_available.notify_all();
+
+  // help until the blocks of this job have all been taken, and then wait
+  Task task;
+  while (true) {
+    if (take_task(q, task)) {
+      execute(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(job.mtx);
+    job.done.wait(lock, [&]() { return job.remaining == 0; });
+    break;
+  }
+  active_jobs--;
+
+  if (job.exception)
+    std::rethrow_exception(job.exception);
+}
+
+// The pool is never destroyed, so it is available until the program ends
+std::mutex pool_mtx;
+ThreadPool *pool = nullptr;
+
+// Get the pool, with a job added so that it is not replaced while in use
+ThreadPool *acquire_pool()
+{
+  const int num_workers = get_max_threads() - 1;
+  std::lock_guard<std::mutex> lock(pool_mtx);
+  if (pool && pool->get_num_workers() != num_workers && pool->is_idle() &&
+      this_queue == 0) {
+    delete pool; // the thread limit changed
+    pool = nullptr;
+  }
+  if (!pool)
+    pool = new ThreadPool(num_workers);
+  pool->add_job();
+  return pool;
+}
+
+} // namespace
+
+int get_max_threads()
+{
+  read_env_setting();
+  return (max_threads > 0) ? max_threads : get_hardware_threads();
+}
+
+void set_max_threads(int num)
+{
+  read_env_setting(); // so that it does not override this later
+  max_threads = (num > 0) ? num : get_hardware_threads();
+}
+
+bool get_deterministic_reduce()
+{
+  read_env_setting();
+  return deterministic_reduce;
+}
+
+void set_deterministic_reduce(bool deterministic)
+{
+  read_env_setting();
+  deterministic_reduce = deterministic;
+}
+
+Status set_threads(const string &setting)
+{
+  read_env_setting(); // so that it does not override this later
+  return apply_setting(setting);
+}
+
+void parallel_for_blocks(
+    size_t num, size_t num_blocks,
+    const std::function<void(size_t, size_t, size_t)> &func, int num_threads)
+{
+  num_blocks = std::min(num_blocks, num);
+  if (num_blocks == 0)
+    return;
+
+  const int max_thrds = get_max_threads();
+  if (num_threads < 1 || num_threads > max_thrds)
+    num_threads = max_thrds;
+  auto run_blocks = [&](size_t, size_t begin, size_t end) {
+    for (size_t b = begin; b < end; b++)
+      func(b, b * num / num_blocks, (b + 1) * num / num_blocks);
+  };
+  if (num_threads < 2 || num_blocks < 2) {
+    run_blocks(0, 0, num_blocks);
+    return;
+  }
+
+  // Each pool thread may take a block, so a thread limit below the pool
+  // size is kept by running the blocks in that many groups
+  const std::function<void(size_t, size_t, size_t)> run_group = run_blocks;
+  const bool grouped =
+      num_threads < max_thrds && num_blocks > (size_t)num_threads;
+  Job job;
+  job.func = (grouped) ? &run_group : &func;
+  job.num = (grouped) ? num_blocks : num;
+  job.num_blocks = (grouped) ? num_threads : num_blocks;
+  job.remaining = job.num_blocks;
+  acquire_pool()->run(job);
+}
+
+size_t get_reduce_blocks(size_t num, int num_threads)
+{
+  const size_t max_blocks =
+      std::max((size_t)1, (num + min_reduce_block - 1) / min_reduce_block);
+  if (get_deterministic_reduce())
+    return std::min(max_blocks, reduce_blocks);
+  if (num_threads < 1)
+    num_threads = get_max_threads();
+  return std::min(max_blocks, (size_t)num_threads);
+}
+
+void parallel_for(size_t num, const std::function<void(size_t)> &func,
+                  int num_threads)
+{
+  // with a thread limit below the pool size, one block for each thread
+  const int max_thrds = get_max_threads();
+  size_t num_blocks = (num_threads < 1 || num_threads >= max_thrds)
+                          ? max_thrds * blocks_per_thread
+                          : num_threads;
+  parallel_for_blocks(
+      num, num_blocks,
+      [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+          func(i);
+      },
+      num_threads);
+}
+
+} // namespace anti
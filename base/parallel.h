@@ -0,0 +1,180 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file parallel.h
+ * \brief Support for running independent work in parallel
+ *
+ * Parallel operations share a single pool of worker threads, which is
+ * started when first needed. Work is split into blocks of indices, and
+ * an idle thread takes blocks from the other threads' queues, so nested
+ * parallel operations and uneven blocks are balanced. A thread waiting
+ * for its blocks to finish runs queued blocks itself.
+ *
+ * The thread limit and reduction mode are set for the whole program
+ * with set_threads(), which programs call for \c --threads, or from the
+ * \c ANTIPRISM_THREADS environment variable.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "status.h"
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anti {
+
+/// Get the maximum number of threads for parallel operations
+/**\return The limit set with \c set_max_threads() or \c set_threads(),
+ *  otherwise the number of hardware threads, or \c 1 if this is not known.
+ */
+int get_max_threads();
+
+/// Set the maximum number of threads for parallel operations
+/**\param num the number of threads, \c 0 for the number of hardware
+ *  threads. */
+void set_max_threads(int num);
+
+/// Check whether reductions are deterministic
+/**\return \c true if \c parallel_reduce() combines results in a fixed
+ *  order (the default), otherwise \c false. */
+bool get_deterministic_reduce();
+
+/// Set whether reductions are deterministic
+/**\param deterministic \c true for \c parallel_reduce() to combine
+ *  results in an order that does not depend on the threads, \c false to
+ *  combine them as they finish. */
+void set_deterministic_reduce(bool deterministic);
+
+/// Set the thread limit and reduction mode from a setting
+/**The setting is the number of threads, \c 0 for the number of hardware
+ * threads, optionally followed by \c ,f for fast reductions that combine
+ * results in any order. This is the format of the \c --threads option
+ * and the \c ANTIPRISM_THREADS environment variable.
+ * \param setting the setting.
+ * \return status, which evaluates to \c true if the setting was valid,
+ *  otherwise \c false to indicate an error. */
+Status set_threads(const std::string &setting);
+
+/// Call a function for each index in a range, using several threads
+/**The function must be safe to call concurrently for different indices,
+ * and should write its result to a slot reserved for the index so that
+ * the output does not depend on the number of threads. Each block of
+ * indices is processed in increasing order.
+ * \param num number of indices, \c func is called for \c 0 to \c num-1
+ * \param func function to call with each index.
+ * \param num_threads the maximum number of threads to use, \c 0 to use
+ *  the value of \c get_max_threads() */
+void parallel_for(size_t num, const std::function<void(size_t)> &func,
+                  int num_threads = 0);
+
+/// Call a function for blocks of a range, using several threads
+/**Block \c b covers the indices from <tt>b*num/num_blocks</tt> up to,
+ * but not including, <tt>(b+1)*num/num_blocks</tt>. If there are more
+ * blocks than threads, each thread runs a group of consecutive blocks in
+ * order.
+ * \param num number of indices.
+ * \param num_blocks number of blocks to divide the indices into.
+ * \param func function to call with the block number, and the first and
+ *  one past the last index of the block.
+ * \param num_threads the maximum number of threads to use, \c 0 to use
+ *  the value of \c get_max_threads() */
+void parallel_for_blocks(
+    size_t num, size_t num_blocks,
+    const std::function<void(size_t, size_t, size_t)> &func,
+    int num_threads = 0);
+
+/// Get the number of blocks for a reduction
+/**Blocks are not made smaller than a minimum size, so a small reduction
+ * has a single block and runs in the calling thread.
+ * \param num number of indices.
+ * \param num_threads the maximum number of threads to use, \c 0 to use
+ *  the value of \c get_max_threads()
+ * \return The number of blocks. When reductions are deterministic this
+ *  only depends on \c num. */
+size_t get_reduce_blocks(size_t num, int num_threads = 0);
+
+/// Combine values calculated for each index in a range, using several threads
+/**The values for a block of indices are combined in increasing order,
+ * and the block results are then combined. In deterministic mode the
+ * blocks only depend on \c num and are combined in order, so the result
+ * does not depend on the number of threads, although it may differ
+ * from a sequential calculation if \c combine is not associative.
+ * \param num number of indices.
+ * \param identity value that \c combine leaves other values unchanged with.
+ * \param map function to calculate the value for an index.
+ * \param combine function to combine two values.
+ * \param num_threads the maximum number of threads to use, \c 0 to use
+ *  the value of \c get_max_threads()
+ * \return The combined value, or \c identity if \c num is \c 0. */
+template <typename T>
+T parallel_reduce(size_t num, const T &identity,
+                  const std::function<T(size_t)> &map,
+                  const std::function<T(const T &, const T &)> &combine,
+                  int num_threads = 0)
+{
+  const size_t num_blocks = get_reduce_blocks(num, num_threads);
+  auto reduce_block = [&](size_t begin, size_t end) {
+    T val = identity;
+    for (size_t i = begin; i < end; i++)
+      val = combine(val, map(i));
+    return val;
+  };
+
+  T result = identity;
+  if (get_deterministic_reduce()) {
+    struct Slot { // not a vector<bool> element
+      T val;
+    };
+    std::vector<Slot> partials(num_blocks, Slot{identity});
+    parallel_for_blocks(
+        num, num_blocks,
+        [&](size_t b, size_t begin, size_t end) {
+          partials[b].val = reduce_block(begin, end);
+        },
+        num_threads);
+    for (const auto &partial : partials)
+      result = combine(result, partial.val);
+  }
+  else {
+    std::mutex mtx;
+    parallel_for_blocks(
+        num, num_blocks,
+        [&](size_t, size_t begin, size_t end) {
+          T val = reduce_block(begin, end);
+          std::lock_guard<std::mutex> lock(mtx);
+          result = combine(result, val);
+        },
+        num_threads);
+  }
+  return result;
+}
+
+} // namespace anti
+
+#endif // PARALLEL_H
@@ -29,9 +29,12 @@
 */
 
 #include "planar.h"
+#include "utils.h"
 
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <map>
 #include <set>
 #include <string>
@@ -664,7 +667,7 @@ void split_pinched_faces(Geometry &geom, double eps)
 }
 
 // use diagrams face color indexes to determine inclusion
-vector<vector<int>> lists_full(map<int, Geometry> &diagrams,
+vector<vector<int>> lists_full(const map<int, Geometry> &diagrams,
                                const vector<vector<int>> &idx_lists,
                                bool remove_multiples)
 {
@@ -675,20 +678,19 @@ vector<vector<int>> lists_full(map<int, Geometry> &diagrams,
     vector<int> map_indexes;
     // position 0 is stellation face index
     int stellation_face_idx = idx_lists[i][0];
+    const Geometry &diagram = diagrams.at(stellation_face_idx);
     // collect color map indexes of chosen faces
     for (unsigned int j = 1; j < idx_lists[i].size(); j++) {
       int face_no = idx_lists[i][j];
-      map_indexes.push_back(
-          diagrams[stellation_face_idx].colors(FACES).get(face_no).get_index());
+      map_indexes.push_back(diagram.colors(FACES).get(face_no).get_index());
     }
     // if list is empty, add stellation face at position 0
     if (!lists[stellation_face_idx].size())
       lists[stellation_face_idx].push_back(stellation_face_idx);
     // find all faces with same color map indexes as those selected
-    const vector<vector<int>> &faces = diagrams[stellation_face_idx].faces();
+    const vector<vector<int>> &faces = diagram.faces();
     for (unsigned int j = 0; j < faces.size(); j++) {
-      int face_color_index =
-          diagrams[stellation_face_idx].colors(FACES).get(j).get_index();
+      int face_color_index = diagram.colors(FACES).get(j).get_index();
       vector<int>::iterator it;
       it = find(map_indexes.begin(), map_indexes.end(), face_color_index);
       if (it != map_indexes.end())
@@ -730,19 +732,29 @@ vector<vector<int>> lists_full(map<int, Geometry> &diagrams,
   return idx_lists_full;
 }
 
-// use diagrams and full lists and face color indexes to determine minimal
-// resolved faces
-vector<vector<int>> lists_resolved(const Geometry &geom,
-                                   const string &sym_string,
-                                   map<int, Geometry> &diagrams,
-                                   const vector<vector<int>> &idx_lists,
-                                   const vector<vector<int>> &idx_lists_full,
-                                   bool remove_multiples)
+// color map indexes of a chiral colored diagram, so left and right indexes
+// are different
+static vector<int> chiral_color_indexes(const Geometry &diagram,
+                                        const Geometry &geom,
+                                        const string &sym_string)
 {
-  // make chiral colored diagrams so left and right indexes are different
-  for (unsigned int i = 0; i < diagrams.size(); i++)
-    color_stellation_diagram(diagrams[i], geom, sym_string, true);
+  Geometry chiral_diagram = diagram;
+  color_stellation_diagram(chiral_diagram, geom, sym_string, true);
+
+  vector<int> idxs(chiral_diagram.faces().size());
+  for (unsigned int i = 0; i < idxs.size(); i++)
+    idxs[i] = chiral_diagram.colors(FACES).get(i).get_index();
+  return idxs;
+}
 
+// use diagrams and full lists and chiral color indexes to determine minimal
+// resolved faces
+static vector<vector<int>>
+resolve_lists(const Geometry &geom, const map<int, Geometry> &diagrams,
+              const map<int, vector<int>> &chiral_idxs,
+              const vector<vector<int>> &idx_lists,
+              const vector<vector<int>> &idx_lists_full, bool remove_multiples)
+{
   map<pair<int, int>, int> resolved_faces;
   for (unsigned int i = 0; i < idx_lists_full.size(); i++) {
     // position 0 is stellation face index
@@ -756,7 +768,7 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
     vector<pair<double, int>> angle_list;
     for (unsigned int j = 1; j < idx_lists_full[i].size(); j++) {
       double angle = angle_around_axis(
-          diagrams[stellation_face_idx].face_cent(idx_lists_full[i][j]),
+          diagrams.at(stellation_face_idx).face_cent(idx_lists_full[i][j]),
           geom.verts(geom.faces(0)[0]), face_normal);
       angle_list.push_back(make_pair(rad2deg(angle), idx_lists_full[i][j]));
     }
@@ -767,8 +779,7 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
     // map resolved faces by color map index, condense by color map indexes
     for (unsigned int j = 0; j < angle_list.size(); j++) {
       int k = angle_list[j].second;
-      int face_color_index =
-          diagrams[stellation_face_idx].colors(FACES).get(k).get_index();
+      int face_color_index = chiral_idxs.at(stellation_face_idx)[k];
       pair<int, int> key = make_pair(stellation_face_idx, face_color_index);
       resolved_faces[key] = k;
     }
@@ -782,10 +793,8 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
     int stellation_face_idx = idx_lists[i][0];
     resolved_list.push_back(stellation_face_idx);
     for (unsigned int j = 1; j < idx_lists[i].size(); j++) {
-      int original_color_index = diagrams[stellation_face_idx]
-                                     .colors(FACES)
-                                     .get(idx_lists[i][j])
-                                     .get_index();
+      int original_color_index =
+          chiral_idxs.at(stellation_face_idx)[idx_lists[i][j]];
       pair<int, int> key = make_pair(stellation_face_idx, original_color_index);
       int resolved_face = resolved_faces[key];
       // zero is a special case, check if really in the map
@@ -808,13 +817,25 @@ vector<vector<int>> lists_resolved(const Geometry &geom,
       idx_lists_resolved.push_back(resolved_list);
   }
 
-  // restore diagrams color
-  for (unsigned int i = 0; i < diagrams.size(); i++)
-    color_stellation_diagram(diagrams[i], geom, sym_string, false);
-
   return idx_lists_resolved;
 }
 
+vector<vector<int>> lists_resolved(const Geometry &geom,
+                                   const string &sym_string,
+                                   map<int, Geometry> &diagrams,
+                                   const vector<vector<int>> &idx_lists,
+                                   const vector<vector<int>> &idx_lists_full,
+                                   bool remove_multiples)
+{
+  map<int, vector<int>> chiral_idxs;
+  for (auto const &key1 : diagrams)
+    chiral_idxs[key1.first] =
+        chiral_color_indexes(key1.second, geom, sym_string);
+
+  return resolve_lists(geom, diagrams, chiral_idxs, idx_lists, idx_lists_full,
+                       remove_multiples);
+}
+
 // face_index is changed
 Geometry faces_to_geom_for_stel(const Geometry &geom, vector<int> face_idxs)
 {
@@ -844,28 +865,21 @@ void rebuild_compound(Geometry &geom)
 }
 
 // index lists contains stellation face number in position 0
-Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
-                         const vector<vector<int>> &idx_lists,
-                         const string &sym_string, bool merge_faces,
-                         bool remove_inline_verts, bool split_pinched,
-                         bool resolve_faces, bool remove_multiples,
-                         string map_string, double eps)
+static Geometry stellation_from_lists(const map<int, Geometry> &diagrams,
+                                      const vector<vector<int>> &lists,
+                                      const string &sym_string,
+                                      bool merge_faces,
+                                      bool remove_inline_verts,
+                                      bool split_pinched,
+                                      const string &map_string, double eps)
 {
   Geometry stellation_full;
 
-  vector<vector<int>> lists = idx_lists;
-  if (resolve_faces) {
-    vector<vector<int>> idx_lists_full =
-        lists_full(diagrams, idx_lists, remove_multiples);
-    lists = lists_resolved(geom, sym_string, diagrams, idx_lists,
-                           idx_lists_full, remove_multiples);
-  }
-
   for (unsigned int i = 0; i < lists.size(); i++) {
     int stellation_face_idx = lists[i][0];
+    const Geometry &diagram = diagrams.at(stellation_face_idx);
 
-    Geometry stellation =
-        faces_to_geom_for_stel(diagrams[stellation_face_idx], lists[i]);
+    Geometry stellation = faces_to_geom_for_stel(diagram, lists[i]);
     stellation.colors(VERTS).clear();
 
     if (merge_faces) {
@@ -882,8 +896,7 @@ Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
       int planar_merge_type = 2;   // merge
       vector<int> nonconvex_faces; // dummy
       fill_in_faces(stellation, planar_merge_type, nonconvex_faces,
-                    face_norm(diagrams[stellation_face_idx].verts(),
-                              diagrams[stellation_face_idx].faces(0)),
+                    face_norm(diagram.verts(), diagram.faces(0)),
                     eps);
 
       // re-apply color map indexes (approximation)
@@ -957,6 +970,293 @@ Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
   return stellation_full;
 }
 
+Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
+                         const vector<vector<int>> &idx_lists,
+                         const string &sym_string, bool merge_faces,
+                         bool remove_inline_verts, bool split_pinched,
+                         bool resolve_faces, bool remove_multiples,
+                         string map_string, double eps)
+{
+  vector<vector<int>> lists = idx_lists;
+  if (resolve_faces) {
+    vector<vector<int>> idx_lists_full =
+        lists_full(diagrams, idx_lists, remove_multiples);
+    lists = lists_resolved(geom, sym_string, diagrams, idx_lists,
+                           idx_lists_full, remove_multiples);
+  }
+
+  return stellation_from_lists(diagrams, lists, sym_string, merge_faces,
+                               remove_inline_verts, split_pinched, map_string,
+                               eps);
+}
+
+// FNV-1a hash, used to key the diagram cache
+static void hash_bytes(uint64_t &hash, const void *data, size_t len)
+{
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < len; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+// cells sharing an edge with each cell of a diagram
+static vector<vector<int>> diagram_cell_neighbours(const Geometry &diagram)
+{
+  const vector<vector<int>> &faces = diagram.faces();
+  map<pair<int, int>, vector<int>> edge_faces;
+  for (unsigned int i = 0; i < faces.size(); i++) {
+    unsigned int fsz = faces[i].size();
+    for (unsigned int j = 0; j < fsz; j++) {
+      int v0 = faces[i][j];
+      int v1 = faces[i][(j + 1) % fsz];
+      edge_faces[make_pair(std::min(v0, v1), std::max(v0, v1))].push_back(i);
+    }
+  }
+
+  vector<vector<int>> nbrs(faces.size());
+  for (auto const &key1 : edge_faces) {
+    const vector<int> &f_idxs = key1.second;
+    for (unsigned int j = 0; j < f_idxs.size(); j++)
+      for (unsigned int k = 0; k < f_idxs.size(); k++)
+        if (f_idxs[j] != f_idxs[k])
+          nbrs[f_idxs[j]].push_back(f_idxs[k]);
+  }
+
+  for (auto &nbr : nbrs) {
+    sort(nbr.begin(), nbr.end());
+    nbr.erase(unique(nbr.begin(), nbr.end()), nbr.end());
+  }
+
+  return nbrs;
+}
+
+void StellationDiagrams::init(const Geometry &model, const string &sym,
+                              int proj_width, double lim)
+{
+  geom = model;
+  sym_string = sym;
+  if (!sym_string.length())
+    sym_string = Symmetry(geom).get_symbol();
+  projection_width = proj_width;
+  eps = lim;
+
+  diagrams.clear();
+  chiral_idxs.clear();
+  cell_nbrs.clear();
+
+  // key includes everything the diagrams depend on
+  uint64_t hash = 14695981039346656037ULL;
+  const int format_version = 1;
+  hash_bytes(hash, &format_version, sizeof(format_version));
+  for (const auto &vert : geom.verts())
+    hash_bytes(hash, vert.get_v(), 3 * sizeof(double));
+  for (const auto &face : geom.faces()) {
+    int fsz = face.size();
+    hash_bytes(hash, &fsz, sizeof(fsz));
+    hash_bytes(hash, face.data(), fsz * sizeof(int));
+  }
+  hash_bytes(hash, sym_string.data(), sym_string.size());
+  hash_bytes(hash, &projection_width, sizeof(projection_width));
+  hash_bytes(hash, &eps, sizeof(eps));
+  model_key = msg_str("%016llx", (unsigned long long)hash);
+}
+
+string StellationDiagrams::cache_path(int f_idx, const char *suffix) const
+{
+  string path = cache_dir;
+  if (path.size() && !strchr("/\\", path.back()))
+    path += "/";
+  return path + msg_str("stel_%s_f%d.%s", model_key.c_str(), f_idx, suffix);
+}
+
+// read a diagram and its cell data, returns false if not cached or invalid
+bool StellationDiagrams::cache_read(int f_idx)
+{
+  Geometry diagram;
+  if (!diagram.read(cache_path(f_idx, "off")))
+    return false;
+
+  FILE *ifile = fopen(cache_path(f_idx, "cells").c_str(), "r");
+  if (!ifile)
+    return false;
+
+  // line format: chiral_color_index num_neighbours neighbour_idx...
+  unsigned int fsz = diagram.faces().size();
+  vector<int> idxs;
+  vector<vector<int>> nbrs;
+  bool valid = true;
+  char *line = nullptr;
+  while (valid && read_line(ifile, &line) == 0) {
+    Split parts(line);
+    free(line);
+    line = nullptr;
+    if (!parts.size() || parts[0][0] == '#')
+      continue;
+
+    int vals[2];
+    valid = parts.size() >= 2 && read_int(parts[0], &vals[0]) &&
+            read_int(parts[1], &vals[1]) && vals[1] >= 0 &&
+            (int)parts.size() == vals[1] + 2;
+    vector<int> nbr(valid ? vals[1] : 0);
+    for (unsigned int i = 0; valid && i < nbr.size(); i++)
+      valid = read_int(parts[i + 2], &nbr[i]) && nbr[i] >= 0 &&
+              nbr[i] < (int)fsz;
+    if (valid) {
+      idxs.push_back(vals[0]);
+      nbrs.push_back(nbr);
+    }
+  }
+  fclose(ifile);
+
+  if (!valid || idxs.size() != fsz)
+    return false;
+
+  diagrams[f_idx] = diagram;
+  chiral_idxs[f_idx] = idxs;
+  cell_nbrs[f_idx] = nbrs;
+  return true;
+}
+
+// write through temporary files, so concurrent runs never see partial data
+Status StellationDiagrams::cache_write(int f_idx) const
+{
+  string off_path = cache_path(f_idx, "off");
+  string cells_path = cache_path(f_idx, "cells");
+  string off_tmp = get_tmp_file_name(off_path);
+  string cells_tmp = get_tmp_file_name(cells_path);
+
+  // enough digits for the coordinates to be read back exactly
+  Status stat = diagrams.at(f_idx).write(off_tmp, 17);
+  if (stat.is_error()) {
+    remove(off_tmp.c_str());
+    return stat;
+  }
+
+  FILE *ofile = fopen(cells_tmp.c_str(), "w");
+  if (!ofile) {
+    remove(off_tmp.c_str());
+    return Status::error(
+        msg_str("could not open cache file '%s'", cells_path.c_str()));
+  }
+
+  fprintf(ofile, "# stellation diagram cells for face %d, symmetry %s\n",
+          f_idx, sym_string.c_str());
+  fprintf(ofile, "# chiral_color_index num_neighbours neighbour_idx...\n");
+  const vector<int> &idxs = chiral_idxs.at(f_idx);
+  const vector<vector<int>> &nbrs = cell_nbrs.at(f_idx);
+  for (unsigned int i = 0; i < idxs.size(); i++) {
+    fprintf(ofile, "%d %d", idxs[i], (int)nbrs[i].size());
+    for (int nbr : nbrs[i])
+      fprintf(ofile, " %d", nbr);
+    fprintf(ofile, "\n");
+  }
+  bool write_ok = !ferror(ofile);
+  if (fclose(ofile) != 0 || !write_ok) {
+    remove(off_tmp.c_str());
+    remove(cells_tmp.c_str());
+    return Status::error(
+        msg_str("could not write cache file '%s'", cells_path.c_str()));
+  }
+
+  // cells file is moved last, as its presence marks a complete entry
+  if (rename(off_tmp.c_str(), off_path.c_str()) != 0 ||
+      rename(cells_tmp.c_str(), cells_path.c_str()) != 0) {
+    remove(off_tmp.c_str());
+    remove(cells_tmp.c_str());
+    return Status::error(
+        msg_str("could not rename cache files for '%s'", off_path.c_str()));
+  }
+
+  return Status::ok();
+}
+
+Status StellationDiagrams::add_diagram(int f_idx)
+{
+  if (f_idx < 0 || f_idx >= (int)geom.faces().size())
+    return Status::error(msg_str("face number %d is out of range", f_idx));
+
+  if (diagrams.find(f_idx) != diagrams.end())
+    return Status::ok();
+
+  if (cache_dir.size() && cache_read(f_idx))
+    return Status::ok();
+
+  diagrams[f_idx] =
+      make_stellation_diagram(geom, f_idx, sym_string, projection_width, eps);
+  chiral_idxs[f_idx] = chiral_color_indexes(diagrams[f_idx], geom, sym_string);
+  cell_nbrs[f_idx] = diagram_cell_neighbours(diagrams[f_idx]);
+
+  if (cache_dir.size()) {
+    Status stat = cache_write(f_idx);
+    if (stat.is_error())
+      return Status::warning(msg_str("diagram not cached: %s", stat.c_msg()));
+  }
+
+  return Status::ok();
+}
+
+vector<vector<int>> StellationDiagrams::get_cell_classes(int f_idx) const
+{
+  const Geometry &diagram = diagrams.at(f_idx);
+  map<int, vector<int>> classes;
+  for (unsigned int i = 0; i < diagram.faces().size(); i++)
+    classes[diagram.colors(FACES).get(i).get_index()].push_back(i);
+
+  vector<vector<int>> cell_classes;
+  for (auto const &key1 : classes)
+    cell_classes.push_back(key1.second);
+  return cell_classes;
+}
+
+vector<int>
+StellationDiagrams::get_adjacent_cells(int f_idx,
+                                       const vector<int> &cells) const
+{
+  const vector<vector<int>> &nbrs = cell_nbrs.at(f_idx);
+  set<int> cell_set(cells.begin(), cells.end());
+  set<int> adjacent;
+  for (int cell : cells)
+    for (int nbr : nbrs[cell])
+      if (cell_set.find(nbr) == cell_set.end())
+        adjacent.insert(nbr);
+
+  return vector<int>(adjacent.begin(), adjacent.end());
+}
+
+vector<vector<int>>
+StellationDiagrams::lists_full(const vector<vector<int>> &idx_lists,
+                               bool remove_multiples) const
+{
+  return anti::lists_full(diagrams, idx_lists, remove_multiples);
+}
+
+vector<vector<int>>
+StellationDiagrams::lists_resolved(const vector<vector<int>> &idx_lists,
+                                   const vector<vector<int>> &idx_lists_full,
+                                   bool remove_multiples) const
+{
+  return resolve_lists(geom, diagrams, chiral_idxs, idx_lists, idx_lists_full,
+                       remove_multiples);
+}
+
+Geometry StellationDiagrams::make_stellation(
+    const vector<vector<int>> &idx_lists, bool merge_faces,
+    bool remove_inline_verts, bool split_pinched, bool resolve_faces,
+    bool remove_multiples, string map_string) const
+{
+  vector<vector<int>> lists = idx_lists;
+  if (resolve_faces) {
+    vector<vector<int>> idx_lists_full =
+        lists_full(idx_lists, remove_multiples);
+    lists = lists_resolved(idx_lists, idx_lists_full, remove_multiples);
+  }
+
+  return stellation_from_lists(diagrams, lists, sym_string, merge_faces,
+                               remove_inline_verts, split_pinched, map_string,
+                               eps);
+}
+
 // RK - functions for winding number
 
 // Copyright 2001, softSurfer (www.softsurfer.com)
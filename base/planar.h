@@ -123,7 +123,7 @@ void split_pinched_faces(Geometry &geom, double eps = epsilon);
 /**\param diagrams a map of stellation diagrams.
  * \param idx_lists the partial lists.
  * \param remove_multiples if true any duplicates in lists are removed */
-vector<vector<int>> lists_full(map<int, Geometry> &diagrams,
+vector<vector<int>> lists_full(const map<int, Geometry> &diagrams,
                                const vector<vector<int>> &idx_lists,
                                bool remove_multiples = true);
 
@@ -172,6 +172,127 @@ Geometry make_stellation(const Geometry &geom, map<int, Geometry> &diagrams,
                          bool remove_multiples = false,
                          string map_string = "compound", double eps = epsilon);
 
+/// Stellation diagrams of a model, made once and reused for many stellations
+/** A diagram is made the first time its face is added, along with the
+ *  chiral colour map indexes and edge neighbours of its cells. If a cache
+ *  directory is set the diagram data is also stored there, keyed by a hash of
+ *  the model, symmetry and diagram settings, and read back on later runs.
+ *  Once the diagrams are added, the const members may be called from several
+ *  threads at once.
+ *  Note: index lists first position is reference to the diagram face */
+class StellationDiagrams {
+private:
+  Geometry geom;
+  string sym_string;
+  int projection_width = 500;
+  double eps = epsilon;
+  string cache_dir;
+  string model_key;
+
+  map<int, Geometry> diagrams;
+  map<int, vector<int>> chiral_idxs;
+  map<int, vector<vector<int>>> cell_nbrs;
+
+  string cache_path(int f_idx, const char *suffix) const;
+  bool cache_read(int f_idx);
+  Status cache_write(int f_idx) const;
+
+public:
+  /// Initialise with a model, clearing any diagrams
+  /**\param model the geometry.
+   * \param sym is sub-symmetry of stellation, if empty use the full
+   *  symmetry of \p model.
+   * \param proj_width is length of line extents of diagram.
+   * \param lim value for contolling the limit of precision. */
+  void init(const Geometry &model, const string &sym = "",
+            int proj_width = 500, double lim = epsilon);
+
+  /// Set the directory used to store and read diagrams
+  /**\param dir the directory, which must exist, or empty for no disk cache. */
+  void set_cache_dir(const string &dir) { cache_dir = dir; }
+
+  /// Get the model geometry
+  /**\return The geometry. */
+  const Geometry &get_geom() const { return geom; }
+
+  /// Get the symmetry of the stellations
+  /**\return The Schoenflies symbol. */
+  const string &get_sym_string() const { return sym_string; }
+
+  /// Get the key identifying the model and diagram settings in the cache
+  /**\return The key, as hexadecimal digits. */
+  const string &get_model_key() const { return model_key; }
+
+  /// Add the stellation diagram for a face, if not already added
+  /**\param f_idx is face to make diagram.
+   * \return status, which evaluates to \c true if the diagram was added,
+   *  and may contain a warning if the diagram could not be cached. */
+  Status add_diagram(int f_idx);
+
+  /// Get the diagrams that have been added
+  /**\return A map of face index to stellation diagram. */
+  const map<int, Geometry> &get_diagrams() const { return diagrams; }
+
+  /// Get an added diagram
+  /**\param f_idx the face index of the diagram.
+   * \return The diagram. */
+  const Geometry &get_diagram(int f_idx) const { return diagrams.at(f_idx); }
+
+  /// Get the cells sharing an edge with each cell of an added diagram
+  /**\param f_idx the face index of the diagram.
+   * \return The sorted neighbour cell indexes, for each diagram face. */
+  const vector<vector<int>> &get_cell_neighbours(int f_idx) const
+  {
+    return cell_nbrs.at(f_idx);
+  }
+
+  /// Get the cells of an added diagram grouped by symmetry
+  /**\param f_idx the face index of the diagram.
+   * \return Lists of diagram face indexes with the same colour map index,
+   *  in order of the index. */
+  vector<vector<int>> get_cell_classes(int f_idx) const;
+
+  /// Get the cells adjacent to a set of cells, to extend a stellation
+  /**\param f_idx the face index of the diagram.
+   * \param cells diagram face indexes of the current cells.
+   * \return Sorted indexes of cells which share an edge with \p cells, but
+   *  are not included in it. */
+  vector<int> get_adjacent_cells(int f_idx, const vector<int> &cells) const;
+
+  /// return lists of index for full stellation diagram
+  /**\param idx_lists the partial lists.
+   * \param remove_multiples if true any duplicates in lists are removed */
+  vector<vector<int>> lists_full(const vector<vector<int>> &idx_lists,
+                                 bool remove_multiples = true) const;
+
+  /// return lists which have been standardized
+  /**\param idx_lists the partial lists.
+   * \param idx_lists_full the full lists (from lists_full)
+   * \param remove_multiples if true any duplicates in lists are removed */
+  vector<vector<int>> lists_resolved(const vector<vector<int>> &idx_lists,
+                                     const vector<vector<int>> &idx_lists_full,
+                                     bool remove_multiples = true) const;
+
+  /// make a stellation, all diagrams in the index lists must have been added
+  /**\param idx_lists the index lists used
+   * \param merge_faces try to make full faces from adjacent facelets
+   * \param remove_inline_verts remove vertices which are on a line between
+   *        two other vertices (if merge_faces is true)
+   * \param split_pinched split faces with revisited vertices (if merge_faces
+   *  is true)
+   * \param resolve_faces to standard
+   * \param remove_multiples if true any duplicates in lists are removed (if
+   * resolved_faces is true)
+   * \param map_string color map for coloring from diagrams */
+  Geometry make_stellation(const vector<vector<int>> &idx_lists,
+                           bool merge_faces = true,
+                           bool remove_inline_verts = true,
+                           bool split_pinched = true,
+                           bool resolve_faces = false,
+                           bool remove_multiples = false,
+                           string map_string = "compound") const;
+};
+
 // RK - functions for winding number
 
 /// Get winding number of a point in a polygon
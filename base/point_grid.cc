@@ -0,0 +1,131 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file point_grid.cc
+   \brief Points bucketed in a grid, for finding nearby points.
+*/
+
+#include "private_point_grid.h"
+#include "boundbox.h"
+#include "mathutils.h"
+
+#include <algorithm>
+#include <cmath>
+
+using std::vector;
+
+namespace anti {
+
+PointGrid::PointGrid(const vector<Vec3d> &points) : pts(points)
+{
+  BoundBox bb(pts);
+  origin = bb.get_min();
+  Vec3d width = bb.get_max() - bb.get_min();
+
+  // size the cells for about one point per cell, allowing for point sets
+  // that are planar or linear
+  double vol = 1.0;
+  int num_dims = 0;
+  for (int i = 0; i < 3; i++)
+    if (width[i] > epsilon) {
+      vol *= width[i];
+      num_dims++;
+    }
+  cell_sz = (num_dims) ? pow(vol / pts.size(), 1.0 / num_dims) : 1.0;
+  if (!(cell_sz > epsilon))
+    cell_sz = 1.0;
+
+  for (int i = 0; i < 3; i++)
+    dims[i] = (int)floor(width[i] / cell_sz) + 1;
+
+  vector<int> cell_of(pts.size());
+  offsets.assign((size_t)dims[0] * dims[1] * dims[2] + 1, 0);
+  for (unsigned int i = 0; i < pts.size(); i++) {
+    cell_of[i] =
+        (coord(pts[i], 2) * dims[1] + coord(pts[i], 1)) * dims[0] +
+        coord(pts[i], 0);
+    offsets[cell_of[i] + 1]++;
+  }
+  for (unsigned int i = 1; i < offsets.size(); i++)
+    offsets[i] += offsets[i - 1];
+
+  idxs.resize(pts.size());
+  vector<int> fill_pos(offsets.begin(), offsets.end() - 1);
+  for (unsigned int i = 0; i < pts.size(); i++)
+    idxs[fill_pos[cell_of[i]]++] = i;
+}
+
+int PointGrid::coord(const Vec3d &pt, int i) const
+{
+  // positions outside the grid fall in the nearest boundary cell
+  double c = floor((pt[i] - origin[i]) / cell_sz);
+  return (int)std::max(0.0, std::min(c, (double)dims[i] - 1));
+}
+
+void PointGrid::cell_range(const Vec3d &pt, double dist, int lo[3],
+                           int hi[3]) const
+{
+  Vec3d offset(dist, dist, dist);
+  for (int i = 0; i < 3; i++) {
+    lo[i] = coord(pt - offset, i);
+    hi[i] = coord(pt + offset, i);
+  }
+}
+
+void PointGrid::get_nearby(int idx, double dist, vector<int> &nearby) const
+{
+  nearby.clear();
+  const Vec3d &pt = pts[idx];
+  int lo[3], hi[3];
+  cell_range(pt, dist, lo, hi);
+  double dist2 = dist * dist;
+  for (int z = lo[2]; z <= hi[2]; z++)
+    for (int y = lo[1]; y <= hi[1]; y++)
+      for (int x = lo[0]; x <= hi[0]; x++) {
+        int cell = (z * dims[1] + y) * dims[0] + x;
+        for (int j = offsets[cell]; j < offsets[cell + 1]; j++) {
+          int n_idx = idxs[j];
+          if (n_idx != idx && (pts[n_idx] - pt).len2() <= dist2)
+            nearby.push_back(n_idx);
+        }
+      }
+}
+
+void PointGrid::for_each_near(const Vec3d &pt, double dist,
+                              const std::function<void(int)> &func) const
+{
+  int lo[3], hi[3];
+  cell_range(pt, dist, lo, hi);
+  double dist2 = dist * dist;
+  for (int z = lo[2]; z <= hi[2]; z++)
+    for (int y = lo[1]; y <= hi[1]; y++)
+      for (int x = lo[0]; x <= hi[0]; x++) {
+        int cell = (z * dims[1] + y) * dims[0] + x;
+        for (int j = offsets[cell]; j < offsets[cell + 1]; j++)
+          if ((pts[idxs[j]] - pt).len2() <= dist2)
+            func(idxs[j]);
+      }
+}
+
+} // namespace anti
@@ -63,6 +63,26 @@ string pov_col(const Color &col)
     return string();
 }
 
+void pov_vec(TextWriter &out, const Vec3d &v, int sig_digits)
+{
+  out.put('<').put_double(v[0], sig_digits).put(", ");
+  out.put_double(v[1], sig_digits).put(", ");
+  out.put_double(v[2], sig_digits).put('>');
+}
+
+void pov_col(TextWriter &out, const Color &col)
+{
+  if (col.is_value()) {
+    Vec4d cv = col.get_vec4d();
+    out.put('<').put_double(cv[0], 6).put(", ");
+    out.put_double(cv[1], 6).put(", ");
+    out.put_double(cv[2], 6).put(", ");
+    out.put_double(1 - cv[3], 6).put('>');
+  }
+  else if (col.is_index())
+    out.put('<').put_int(col.get_index()).put(", -1, 0, 0>");
+}
+
 // ------------------------------------------------------------------
 // DisplayPoly_pov
 
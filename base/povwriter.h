@@ -32,6 +32,7 @@
 #define POVWRITER_H
 
 #include "scene.h"
+#include "textwriter.h"
 #include "utils.h"
 
 #include <cstdio>
@@ -48,6 +49,10 @@ inline std::string pov_vec(const Vec3d &v, int sig_digits = 10)
 }
 std::string pov_col(const Color &col);
 
+// buffered output, with the same text as the conversion functions
+void pov_vec(TextWriter &out, const Vec3d &v, int sig_digits = 10);
+void pov_col(TextWriter &out, const Color &col);
+
 class PovWriter : public SceneItem {
 private:
   char o_type;
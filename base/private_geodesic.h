@@ -79,7 +79,11 @@ private:
   std::map<std::vector<int>, int> edge_idx;
   std::map<std::vector<int>, std::vector<int>> edge_faces;
   // std::map<std::vector<int>, int> face_idx;
-  std::map<int_pr, int> grid_idxs;
+  std::vector<std::vector<int>> face_indxs; // from make_face_indexes
+  std::vector<int> face_nbrs;      // face across each face edge, 3 per face
+  std::vector<int> edge_last_face; // face which sets the edge points
+  std::vector<int> grid_idxs;      // face point index, by i * grid_sz + j
+  int grid_sz;
 
   void init();
   void sphere_projection(anti::Geometry &geom);
@@ -105,10 +109,10 @@ private:
     return ((m + n) * crds.first + m * crds.second) / (m * m + m * n + n * n);
   }
 
-  void grid_to_points(std::vector<int> indx, std::vector<anti::Vec3d> &gverts);
+  void grid_to_points(const std::vector<int> &indx,
+                      std::vector<anti::Vec3d> &gverts);
   bool tri_test(int i, int j, int di, int dj);
-  void grid_to_tris(std::vector<int> indx,
-                    std::vector<std::vector<int>> &new_tris,
+  void grid_to_tris(const std::vector<int> &indx, std::vector<int> &new_tris,
                     std::vector<std::vector<int>> &orig_edges);
   std::vector<int> make_face_indexes(int i, const std::vector<int> &face);
   int index_map(int i, int j, const std::vector<int> &indx,
@@ -62,14 +62,14 @@ Status get_voronoi_cells(Geometry &geom, std::vector<Geometry> &cells,
 
 /// Get Delaunay edges.
 /**Get the edges of the Delaunay tesselation.
- * \param geom geometry to find the Dealunay edges for
+ * \param verts the vertices to find the Dealunay edges for
  * \param edges the Delaunay edges, as a pairs of vertex index numbers,
  * mapped to the number of Delaunay tetrahedra the edge was part of
  * \param qh_args additional arguments to pass to qhull (unsupported,
  * may not work, check output.)
  * \return status, evaluates to \c true if the edges were calculated,
  * otherwise false.*/
-Status get_delaunay_edges(const Geometry &geom,
+Status get_delaunay_edges(const std::vector<Vec3d> &verts,
                           std::map<std::pair<int, int>, int> &edges,
                           std::string qh_args);
 
@@ -0,0 +1,73 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: private_point_grid.h
+   Description: points bucketed in a grid, for finding nearby points
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#ifndef PRIVATE_POINT_GRID_H
+#define PRIVATE_POINT_GRID_H
+
+#include "vec3d.h"
+
+#include <functional>
+#include <vector>
+
+namespace anti {
+
+// point_grid.cc
+
+// Points bucketed in a regular grid, for finding the points near a
+// position without comparing against every point
+class PointGrid {
+private:
+  const std::vector<Vec3d> &pts;
+  Vec3d origin;
+  double cell_sz;
+  int dims[3];
+  std::vector<int> offsets; // start of each grid cell in idxs (CSR layout)
+  std::vector<int> idxs;
+
+  int coord(const Vec3d &pt, int i) const;
+  void cell_range(const Vec3d &pt, double dist, int lo[3], int hi[3]) const;
+
+public:
+  PointGrid(const std::vector<Vec3d> &points);
+
+  // typical distance between neighbouring points
+  double get_spacing() const { return cell_sz; }
+
+  // indexes of points, other than point idx, within dist of point idx
+  void get_nearby(int idx, double dist, std::vector<int> &nearby) const;
+
+  // call func with the index of each point within dist of pt
+  void for_each_near(const Vec3d &pt, double dist,
+                     const std::function<void(int)> &func) const;
+};
+
+} // namespace anti
+
+#endif // PRIVATE_POINT_GRID_H
@@ -0,0 +1,208 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file profile.cc
+   \brief Scoped timers and counters for profiling the phases of a program
+*/
+
+#include "profile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace anti {
+
+namespace {
+
+using profile_clock = std::chrono::steady_clock;
+
+struct PhaseData {
+  string name;
+  long calls = 0;
+  double secs = 0.0;
+  long allocs = 0;
+  long bytes = 0;
+};
+
+struct ProfileData {
+  std::mutex mtx;
+  string prog_name;
+  profile_clock::time_point start;
+  vector<PhaseData> phases;
+  map<string, int> phase_idxs;
+  map<string, long> counters;
+};
+
+// Allocated when enabled and never freed, so that it is still available
+// to the report written at exit
+ProfileData *prof_data = nullptr;
+
+std::atomic<long> alloc_cnt(0);
+std::atomic<long> alloc_bytes(0);
+
+// Phases being timed in this thread, so that a phase which is nested
+// in itself is only timed once
+thread_local vector<int> active_phases;
+
+#ifndef ANTI_NO_PROFILE
+void write_report() { Profiler::report(stderr); }
+#endif
+
+double secs_since(profile_clock::time_point start)
+{
+  return std::chrono::duration<double>(profile_clock::now() - start).count();
+}
+
+} // namespace
+
+bool Profiler::enabled = false;
+
+Status Profiler::enable(const string &prog_name)
+{
+#ifdef ANTI_NO_PROFILE
+  (void)prog_name;
+  return Status::error("profiling was disabled when Antiprism was built");
+#else
+  if (!enabled) {
+    prof_data = new ProfileData;
+    prof_data->prog_name = prog_name;
+    prof_data->start = profile_clock::now();
+    enabled = true;
+    atexit(write_report);
+  }
+  return Status::ok();
+#endif
+}
+
+void Profiler::count(const char *name, long num)
+{
+  std::lock_guard<std::mutex> lock(prof_data->mtx);
+  prof_data->counters[name] += num;
+}
+
+void Profiler::add_alloc(size_t bytes)
+{
+  alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+  alloc_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Profiler::get_allocs(long *allocs, long *bytes)
+{
+  if (allocs)
+    *allocs = alloc_cnt.load(std::memory_order_relaxed);
+  if (bytes)
+    *bytes = alloc_bytes.load(std::memory_order_relaxed);
+}
+
+void Profiler::report(FILE *ofile)
+{
+  if (!prof_data)
+    return;
+
+  double total_secs = secs_since(prof_data->start);
+  long total_allocs, total_bytes;
+  get_allocs(&total_allocs, &total_bytes);
+
+  std::lock_guard<std::mutex> lock(prof_data->mtx);
+  vector<const PhaseData *> phases;
+  for (const auto &phase : prof_data->phases)
+    phases.push_back(&phase);
+  std::stable_sort(phases.begin(), phases.end(),
+                   [](const PhaseData *a, const PhaseData *b) {
+                     return a->secs > b->secs;
+                   });
+
+  const char *prog = prof_data->prog_name.c_str();
+  const double mb = 1024.0 * 1024.0;
+  fprintf(ofile, "%s: profile (nested phases are included in their callers)\n",
+          prog);
+  fprintf(ofile, "%s:   %-24s %8s %10s %11s %10s\n", prog, "phase", "calls",
+          "secs", "allocs", "alloc MB");
+  for (const auto *phase : phases)
+    fprintf(ofile, "%s:   %-24s %8ld %10.4f %11ld %10.2f\n", prog,
+            phase->name.c_str(), phase->calls, phase->secs, phase->allocs,
+            phase->bytes / mb);
+  fprintf(ofile, "%s:   %-24s %8s %10.4f %11ld %10.2f\n", prog, "total", "",
+          total_secs, total_allocs, total_bytes / mb);
+
+  if (!prof_data->counters.empty()) {
+    fprintf(ofile, "%s:   %-24s %8s\n", prog, "counter", "count");
+    for (const auto &kp : prof_data->counters)
+      fprintf(ofile, "%s:   %-24s %8ld\n", prog, kp.first.c_str(), kp.second);
+  }
+}
+
+void ProfileScope::begin(const char *name)
+{
+  int idx;
+  {
+    std::lock_guard<std::mutex> lock(prof_data->mtx);
+    auto it = prof_data->phase_idxs.find(name);
+    if (it == prof_data->phase_idxs.end()) {
+      idx = prof_data->phases.size();
+      prof_data->phase_idxs[name] = idx;
+      prof_data->phases.push_back(PhaseData());
+      prof_data->phases.back().name = name;
+    }
+    else
+      idx = it->second;
+    prof_data->phases[idx].calls++;
+  }
+
+  // a nested call is counted, but its time is already being measured
+  if (std::find(active_phases.begin(), active_phases.end(), idx) !=
+      active_phases.end())
+    return;
+
+  active_phases.push_back(idx);
+  phase_idx = idx;
+  Profiler::get_allocs(&start_allocs, &start_bytes);
+  start = profile_clock::now();
+}
+
+void ProfileScope::end()
+{
+  double secs = secs_since(start);
+  long allocs, bytes;
+  Profiler::get_allocs(&allocs, &bytes);
+
+  auto it = std::find(active_phases.rbegin(), active_phases.rend(), phase_idx);
+  active_phases.erase(std::next(it).base());
+
+  std::lock_guard<std::mutex> lock(prof_data->mtx);
+  auto &phase = prof_data->phases[phase_idx];
+  phase.secs += secs;
+  phase.allocs += allocs - start_allocs;
+  phase.bytes += bytes - start_bytes;
+}
+
+} // namespace anti
@@ -0,0 +1,144 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file profile.h
+ * \brief Scoped timers and counters for profiling the phases of a program
+ *
+ * A phase is timed by placing \c ANTI_PROFILE_SCOPE("name") at the start
+ * of the block that runs it, and an event is counted with
+ * \c ANTI_PROFILE_COUNT("name", n). Nothing is recorded unless profiling
+ * has been enabled with Profiler::enable(), which programs do for the
+ * \c --profile option, and a disabled scope only tests a flag. Building
+ * with \c ANTI_NO_PROFILE defined (configure \c --disable-profile)
+ * removes the instrumentation completely.
+ *
+ * Times are inclusive of nested phases. Allocations are the number and
+ * total size of the \c operator \c new calls made, in any thread, while
+ * the phase was running. They are only counted in programs that replace
+ * \c operator \c new to call Profiler::add_alloc(), as the programs in
+ * \c src do, otherwise they are reported as 0.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "status.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace anti {
+
+/// Program-wide profiling data
+class Profiler {
+private:
+  static bool enabled;
+
+public:
+  /// Enable profiling
+  /**A report is written to standard error when the program exits.
+   * \param prog_name program name, to prefix the report lines.
+   * \return status, which evaluates to \c true if profiling is available
+   *  in this build, otherwise \c false to indicate an error. */
+  static Status enable(const std::string &prog_name);
+
+  /// Check whether profiling is enabled
+  /**\return \c true if enabled, otherwise \c false. */
+  static bool is_enabled() { return enabled; }
+
+  /// Add to a counter
+  /**\param name counter name.
+   * \param num the number to add. */
+  static void count(const char *name, long num = 1);
+
+  /// Count an allocation
+  /**Called by a replacement \c operator \c new while profiling is
+   * enabled.
+   * \param bytes the size of the allocation. */
+  static void add_alloc(size_t bytes);
+
+  /// Get the allocation totals
+  /**\param allocs to return the number of allocations.
+   * \param bytes to return the total size of the allocations. */
+  static void get_allocs(long *allocs, long *bytes);
+
+  /// Write the report
+  /**Phases are listed by decreasing time, followed by the counters.
+   * \param ofile file stream to write to. */
+  static void report(FILE *ofile);
+};
+
+/// Time a phase for the lifetime of the object
+class ProfileScope {
+private:
+  int phase_idx = -1; // -1 when not timing
+  std::chrono::steady_clock::time_point start;
+  long start_allocs;
+  long start_bytes;
+
+  void begin(const char *name);
+  void end();
+
+public:
+  /// Constructor
+  /**\param name phase name, usually a string literal. */
+  ProfileScope(const char *name)
+  {
+    if (Profiler::is_enabled())
+      begin(name);
+  }
+
+  /// Destructor
+  ~ProfileScope()
+  {
+    if (phase_idx >= 0)
+      end();
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+} // namespace anti
+
+#ifdef ANTI_NO_PROFILE
+#define ANTI_PROFILE_SCOPE(name)
+#define ANTI_PROFILE_COUNT(name, num)
+#else
+#define ANTI_PROFILE_CAT_(a, b) a##b
+#define ANTI_PROFILE_CAT(a, b) ANTI_PROFILE_CAT_(a, b)
+/// Time the rest of the enclosing block as a phase
+#define ANTI_PROFILE_SCOPE(name)                                             \
+  anti::ProfileScope ANTI_PROFILE_CAT(anti_profile_scope_, __LINE__)(name)
+/// Add to a counter
+#define ANTI_PROFILE_COUNT(name, num)                                        \
+  do {                                                                       \
+    if (anti::Profiler::is_enabled())                                        \
+      anti::Profiler::count(name, num);                                      \
+  } while (0)
+#endif
+
+#endif // PROFILE_H
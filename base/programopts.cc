@@ -30,9 +30,12 @@
 #include "../config.h"
 #endif
 
+#include "parallel.h"
+#include "profile.h"
 #include "programopts.h"
 #include "utils.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <map>
 
@@ -43,7 +46,13 @@ namespace anti {
 
 const char *ProgramOpts::help_ver_text =
     "  -h,--help this help message (run 'off_util -H help' for general help)\n"
-    "  --version version information";
+    "  --version version information\n"
+    "  --profile on exit, write the time and allocations in the main phases\n"
+    "            to standard error\n"
+    "  --threads <num> maximum number of threads, 0 for all the hardware\n"
+    "            threads, optionally followed by ',f' for faster reductions\n"
+    "            that may vary in the last digits between runs (default:\n"
+    "            ANTIPRISM_THREADS environment variable, otherwise 0)";
 
 const char *ProgramOpts::prog_name() const { return program_name.c_str(); }
 
@@ -121,10 +130,45 @@ bool ProgramOpts::common_opts(char c, char opt)
   return true;
 }
 
-void ProgramOpts::handle_long_opts(int argc, char *argv[])
+void ProgramOpts::handle_long_opts(int &argc, char *argv[])
 {
+  const char *env_threads = getenv("ANTIPRISM_THREADS");
+  if (env_threads) {
+    Status stat = set_threads(env_threads);
+    if (stat.is_error())
+      warning(stat.msg() + ", ignored", "ANTIPRISM_THREADS");
+  }
+
+  // remove arguments, including the terminating null pointer
+  auto remove_args = [&](int idx, int num) {
+    for (int j = idx; j <= argc - num; j++)
+      argv[j] = argv[j + num];
+    argc -= num;
+  };
+
   for (int i = 1; i < argc; i++) {
-    if (strcmp(argv[i], "--help") == 0) {
+    if (strcmp(argv[i], "--profile") == 0) {
+      Status stat = Profiler::enable(prog_name());
+      if (stat.is_error())
+        error(stat.msg(), argv[i]);
+      remove_args(i--, 1);
+    }
+    else if (strcmp(argv[i], "--threads") == 0 ||
+             strncmp(argv[i], "--threads=", 10) == 0) {
+      const char *setting = strchr(argv[i], '=');
+      int num_args = 1;
+      if (setting)
+        setting++;
+      else if (i + 1 < argc) {
+        setting = argv[i + 1];
+        num_args = 2;
+      }
+      else
+        error("missing argument", argv[i]);
+      print_status_or_exit(set_threads(setting), "--threads");
+      remove_args(i--, num_args);
+    }
+    else if (strcmp(argv[i], "--help") == 0) {
       usage();
       exit(0);
     }
@@ -131,9 +131,11 @@ public:
   void print_status_or_exit(const Status &stat, char opt) const;
 
   /// Process long options
-  /**\param argc the number of arguments.
+  /**Options which set up the program, like \c --profile, are removed
+   * from the arguments, so they are not seen by \c getopt.
+   * \param argc the number of arguments, updated if any are removed.
    * \param argv pointers to the argument strings. */
-  void handle_long_opts(int argc, char *argv[]);
+  void handle_long_opts(int &argc, char *argv[]);
 
   /// Process common options
   /**\param c the character returned by getopt.
@@ -0,0 +1,564 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: rasterwriter.cc
+   Description: render a scene to an image in software
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#include "rasterwriter.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+using std::vector;
+
+namespace anti {
+
+namespace {
+
+// Light direction, and half-way vector for the highlight, in view
+// coordinates (the light position used by antiview)
+const Vec3d light_dir = Vec3d(-100, 200, 1000).unit();
+const Vec3d light_half = (light_dir + Vec3d::Z).unit();
+
+// Ordered dither thresholds for the screen door transparency
+const int dither[4][4] = {
+    {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+// Shade a colour for a unit normal facing the viewer, using antiview
+// material and light values: diffuse is the colour, specular is half the
+// colour with shininess 100, and ambient is the scene ambient 0.3
+// times the material default 0.2
+void shade(const float norm[3], const float col[4], float out[3])
+{
+  double diff = std::max(0.0, norm[0] * light_dir[0] +
+                                  norm[1] * light_dir[1] +
+                                  norm[2] * light_dir[2]);
+  double spec = 0;
+  if (diff > 0) {
+    double n_h = norm[0] * light_half[0] + norm[1] * light_half[1] +
+                 norm[2] * light_half[2];
+    if (n_h > 0)
+      spec = pow(n_h, 100) / 2;
+  }
+  for (int i = 0; i < 3; i++)
+    out[i] = std::min(1.0, 0.06 + col[i] * (diff + spec));
+}
+
+// Write a big-endian 32-bit value
+void put_u32(vector<unsigned char> &buf, uint32_t val)
+{
+  for (int i = 3; i >= 0; i--)
+    buf.push_back((val >> (8 * i)) & 0xff);
+}
+
+uint32_t crc32(const unsigned char *data, size_t len)
+{
+  static uint32_t table[256];
+  static bool table_set = [] {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+    return true;
+  }();
+  (void)table_set;
+
+  uint32_t crc = 0xffffffff;
+  for (size_t i = 0; i < len; i++)
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffff;
+}
+
+// Append a PNG chunk
+void put_chunk(vector<unsigned char> &png, const char *type,
+               const vector<unsigned char> &data)
+{
+  put_u32(png, data.size());
+  size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data.begin(), data.end());
+  put_u32(png, crc32(&png[start], png.size() - start));
+}
+
+// Writes a DEFLATE bit stream
+class BitWriter {
+private:
+  vector<unsigned char> &out;
+  uint32_t bits = 0;
+  int num_bits = 0;
+
+public:
+  BitWriter(vector<unsigned char> &buf) : out(buf) {}
+
+  // Write a value, least significant bit first
+  void put(uint32_t val, int len)
+  {
+    bits |= val << num_bits;
+    num_bits += len;
+    while (num_bits >= 8) {
+      out.push_back(bits & 0xff);
+      bits >>= 8;
+      num_bits -= 8;
+    }
+  }
+
+  // Write a Huffman code, most significant bit first
+  void put_code(uint32_t code, int len)
+  {
+    uint32_t rev = 0;
+    for (int i = 0; i < len; i++)
+      rev |= ((code >> i) & 1) << (len - 1 - i);
+    put(rev, len);
+  }
+
+  void flush()
+  {
+    if (num_bits)
+      out.push_back(bits & 0xff);
+    bits = 0;
+    num_bits = 0;
+  }
+};
+
+// Write a literal/length symbol with the fixed Huffman code
+void put_fixed_sym(BitWriter &bw, int sym)
+{
+  if (sym < 144)
+    bw.put_code(0x30 + sym, 8);
+  else if (sym < 256)
+    bw.put_code(0x190 + sym - 144, 9);
+  else if (sym < 280)
+    bw.put_code(sym - 256, 7);
+  else
+    bw.put_code(0xc0 + sym - 280, 8);
+}
+
+// Write a match of a repeated previous byte (distance 1)
+void put_run(BitWriter &bw, int len)
+{
+  static const int bases[] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,
+                              15, 17, 19, 23, 27, 31, 35, 43,  51,  59,
+                              67, 83, 99, 115, 131, 163, 195, 227, 258};
+  int code = 28;
+  while (bases[code] > len)
+    code--;
+  put_fixed_sym(bw, 257 + code);
+  int extra = (code < 8 || code == 28) ? 0 : (code - 4) / 4;
+  bw.put(len - bases[code], extra);
+  bw.put_code(0, 5); // distance code for 1
+}
+
+// Compress data as a zlib stream, using a single fixed Huffman block in
+// which only runs of a repeated byte are matched. Filtered image rows
+// are mostly such runs.
+vector<unsigned char> zlib_compress(const vector<unsigned char> &data)
+{
+  vector<unsigned char> out = {0x78, 0x01};
+  BitWriter bw(out);
+  bw.put(1, 1); // final block
+  bw.put(1, 2); // fixed Huffman codes
+  size_t i = 0;
+  while (i < data.size()) {
+    put_fixed_sym(bw, data[i]);
+    size_t run = 0;
+    while (i + 1 + run < data.size() && data[i + 1 + run] == data[i] &&
+           run < 258)
+      run++;
+    if (run >= 3) {
+      put_run(bw, run);
+      i += run;
+    }
+    i++;
+  }
+  put_fixed_sym(bw, 256); // end of block
+  bw.flush();
+
+  uint32_t a = 1, b = 0;
+  for (unsigned char c : data) {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+  put_u32(out, (b << 16) | a);
+  return out;
+}
+
+} // namespace
+
+void RasterWriter::set_view(const Scene &scen)
+{
+  const Camera &cam = scen.cur_camera();
+  Vec3d cent = cam.get_centre();
+  Trans3d rot = cam.get_rotation() * cam.get_spin_rot();
+  to_view = Trans3d::translate(Vec3d(0, 0, -1.57 * cam.get_distance())) *
+            Trans3d::translate(cent - cam.get_lookat()) * rot *
+            Trans3d::translate(-cent);
+  to_view_rot = rot;
+  view_wd = scen.get_width();
+  double near_dist = cam.get_cut_dist();
+  near_depth = persp ? 1 / near_dist : -near_dist;
+}
+
+bool RasterWriter::project(const Vec3d &v, float &x, float &y,
+                           float &z) const
+{
+  const double aspect = double(width) / height;
+  double xn, yn;
+  if (persp) {
+    if (v[2] >= 0)
+      return false;
+    const double f = 1 / tan(deg2rad(15));
+    xn = f / aspect * v[0] / -v[2];
+    yn = f * v[1] / -v[2];
+    z = 1 / -v[2];
+  }
+  else {
+    xn = v[0] / (view_wd / 2 * aspect);
+    yn = v[1] / (view_wd / 2);
+    z = v[2];
+  }
+  x = (xn + 1) / 2 * width * samples;
+  y = (1 - yn) / 2 * height * samples;
+  return true;
+}
+
+int RasterWriter::get_divs(const Vec3d &pt, double rad) const
+{
+  double scale = height * samples / view_wd; // pixels per unit
+  if (persp) {
+    double dist = -(to_view * pt)[2];
+    if (dist <= 0)
+      return 0;
+    scale = height * samples / (2 * tan(deg2rad(15)) * dist);
+  }
+  return std::min(64, int(6 + 4 * sqrt(rad * scale)));
+}
+
+void RasterWriter::add_triangle(const Vec3d pts[3], const Vec3d norms[3],
+                                Color col, bool trans, bool closed)
+{
+  Tri tri;
+  tri.level = trans ? int(col.get_vec4d()[3] * 16 + 0.5) : 16;
+  if (tri.level <= 0)
+    return;
+  Vec3d v_pts[3];
+  for (int i = 0; i < 3; i++)
+    v_pts[i] = to_view * pts[i];
+
+  // Lighting is two-sided, as in antiview: when the back of a triangle
+  // is seen the normals are reversed. The back of a triangle from a
+  // closed opaque surface is hidden.
+  Vec3d to_eye = persp ? -(v_pts[0] + v_pts[1] + v_pts[2]) : Vec3d::Z;
+  double facing = vdot(vcross(v_pts[1] - v_pts[0], v_pts[2] - v_pts[0]),
+                       to_eye);
+  if (facing < 0 && closed && tri.level == 16)
+    return;
+
+  // With perspective, clip the triangle to the part beyond the near
+  // plane, which is a triangle or a quadrilateral. With a parallel view
+  // the near plane is applied to each sample when rasterising.
+  Vec3d c_pts[4];
+  Vec3d c_norms[4];
+  int num_pts = 0;
+  const double near_z = persp ? -1 / double(near_depth) : 0;
+  for (int i = 0; i < 3; i++) {
+    const int i1 = (i + 1) % 3;
+    const bool in0 = !persp || v_pts[i][2] <= near_z;
+    const bool in1 = !persp || v_pts[i1][2] <= near_z;
+    if (in0) {
+      c_pts[num_pts] = v_pts[i];
+      c_norms[num_pts++] = norms[i];
+    }
+    if (in0 != in1) {
+      double t = (near_z - v_pts[i][2]) / (v_pts[i1][2] - v_pts[i][2]);
+      c_pts[num_pts] = v_pts[i] + (v_pts[i1] - v_pts[i]) * t;
+      c_pts[num_pts][2] = near_z;
+      c_norms[num_pts++] = norms[i] + (norms[i1] - norms[i]) * t;
+    }
+  }
+
+  Vec4d cv = col.get_vec4d();
+  for (int j = 0; j < 4; j++)
+    tri.col[j] = cv[j];
+  for (int t = 1; t < num_pts - 1; t++) {
+    const int idxs[3] = {0, t, t + 1};
+    bool valid = true;
+    for (int i = 0; i < 3 && valid; i++)
+      valid = project(c_pts[idxs[i]], tri.x[i], tri.y[i], tri.z[i]);
+    if (!valid)
+      continue;
+
+    // Skip a triangle that does not cover the centre of any sample
+    const float x_min = std::min({tri.x[0], tri.x[1], tri.x[2]});
+    const float x_max = std::max({tri.x[0], tri.x[1], tri.x[2]});
+    const float y_min = std::min({tri.y[0], tri.y[1], tri.y[2]});
+    const float y_max = std::max({tri.y[0], tri.y[1], tri.y[2]});
+    if (x_max < 0.5 || x_min > width * samples - 0.5 || y_max < 0.5 ||
+        y_min > height * samples - 0.5 ||
+        floor(x_min - 0.5) == floor(x_max - 0.5) ||
+        floor(y_min - 0.5) == floor(y_max - 0.5))
+      continue;
+
+    for (int i = 0; i < 3; i++) {
+      Vec3d norm = to_view_rot * c_norms[idxs[i]];
+      if (facing < 0)
+        norm = -norm;
+      for (int j = 0; j < 3; j++)
+        tri.norm[i][j] = norm[j];
+    }
+    tris.push_back(tri);
+  }
+}
+
+void RasterWriter::add_polygon(const vector<Vec3d> &verts,
+                               const vector<int> &face, Color col,
+                               bool trans)
+{
+  if (face.size() < 3)
+    return;
+  Vec3d norm = face_norm(verts, face);
+  const Vec3d norms[3] = {norm, norm, norm};
+  for (unsigned int i = 1; i < face.size() - 1; i++) {
+    const Vec3d pts[3] = {verts[face[0]], verts[face[i]], verts[face[i + 1]]};
+    add_triangle(pts, norms, col, trans);
+  }
+}
+
+void RasterWriter::add_sphere(const Vec3d &cent, double rad, Color col,
+                              bool trans)
+{
+  int divs = get_divs(cent, rad);
+  if (divs < 3)
+    return;
+  if ((int)unit_sphs.size() <= divs)
+    unit_sphs.resize(divs + 1);
+  vector<Vec3d> &sph = unit_sphs[divs];
+  if (sph.empty()) {
+    // Triangles of a sphere with divs longitudes and 2/3 as many latitudes
+    int lat_divs = std::max(3, divs * 2 / 3);
+    auto pt = [&](int lat, int lng) {
+      double a = M_PI * lat / lat_divs;
+      double b = 2 * M_PI * lng / divs;
+      return Vec3d(sin(a) * cos(b), sin(a) * sin(b), cos(a));
+    };
+    for (int i = 0; i < lat_divs; i++)
+      for (int j = 0; j < divs; j++) {
+        if (i > 0)
+          sph.insert(sph.end(), {pt(i, j), pt(i + 1, j), pt(i, j + 1)});
+        if (i < lat_divs - 1)
+          sph.insert(sph.end(),
+                     {pt(i, j + 1), pt(i + 1, j), pt(i + 1, j + 1)});
+      }
+  }
+
+  for (size_t i = 0; i < sph.size(); i += 3) {
+    const Vec3d pts[3] = {cent + sph[i] * rad, cent + sph[i + 1] * rad,
+                          cent + sph[i + 2] * rad};
+    add_triangle(pts, &sph[i], col, trans, true);
+  }
+}
+
+void RasterWriter::add_cylinder(const Vec3d &p0, const Vec3d &p1,
+                                double rad, Color col, bool trans)
+{
+  Vec3d axis = p1 - p0;
+  int divs = get_divs((p0 + p1) / 2, rad);
+  if (axis.len() < epsilon || divs < 3)
+    return;
+  Trans3d rot = Trans3d::rotate(Vec3d::Z, axis);
+  vector<Vec3d> dirs(divs + 1);
+  for (int i = 0; i <= divs; i++) {
+    double ang = 2 * M_PI * i / divs;
+    dirs[i] = rot * Vec3d(cos(ang), sin(ang), 0);
+  }
+  for (int i = 0; i < divs; i++) {
+    const Vec3d &d0 = dirs[i];
+    const Vec3d &d1 = dirs[i + 1];
+    const Vec3d pts0[3] = {p0 + d0 * rad, p0 + d1 * rad, p1 + d1 * rad};
+    const Vec3d norms0[3] = {d0, d1, d1};
+    add_triangle(pts0, norms0, col, trans);
+    const Vec3d pts1[3] = {p0 + d0 * rad, p1 + d1 * rad, p1 + d0 * rad};
+    const Vec3d norms1[3] = {d0, d1, d0};
+    add_triangle(pts1, norms1, col, trans);
+  }
+}
+
+void RasterWriter::rasterise(const Color &bg_col)
+{
+  const int s_wd = width * samples;
+  const int s_ht = height * samples;
+  const int band_ht = 16 * samples; // a band makes whole rows of pixels
+  const int num_bands = (s_ht + band_ht - 1) / band_ht;
+
+  // Triangles in each band, in the order they were added
+  vector<vector<int>> bands(num_bands);
+  for (int t = 0; t < (int)tris.size(); t++) {
+    const Tri &tri = tris[t];
+    float y_min = std::min({tri.y[0], tri.y[1], tri.y[2]});
+    float y_max = std::max({tri.y[0], tri.y[1], tri.y[2]});
+    if (y_max < 0 || y_min >= s_ht)
+      continue;
+    int b_first = std::max(0, int(y_min) / band_ht);
+    int b_last = std::min(num_bands - 1, int(y_max) / band_ht);
+    for (int b = b_first; b <= b_last; b++)
+      bands[b].push_back(t);
+  }
+
+  pixels.assign(3 * width * height, 0);
+  Vec4d bg = bg_col.get_vec4d();
+  auto draw_band = [&](size_t b) {
+    const int y0 = b * band_ht;
+    const int rows = std::min(band_ht, s_ht - y0);
+    vector<float> depth(s_wd * rows, -std::numeric_limits<float>::max());
+    vector<float> rgb(3 * s_wd * rows);
+    for (int i = 0; i < s_wd * rows; i++)
+      for (int j = 0; j < 3; j++)
+        rgb[3 * i + j] = bg[j];
+
+    for (int t : bands[b]) {
+      const Tri &tri = tris[t];
+      double area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) -
+                    (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+      if (fabs(area) < 1e-12)
+        continue;
+      const auto x_rng = std::minmax({tri.x[0], tri.x[1], tri.x[2]});
+      const auto y_rng = std::minmax({tri.y[0], tri.y[1], tri.y[2]});
+      const int x_min = std::max(0, int(floor(x_rng.first)));
+      const int x_max = std::min(s_wd - 1, int(ceil(x_rng.second)));
+      const int y_min = std::max(y0, int(floor(y_rng.first)));
+      const int y_max = std::min(y0 + rows - 1, int(ceil(y_rng.second)));
+      for (int y = y_min; y <= y_max; y++) {
+        const double py = y + 0.5;
+        for (int x = x_min; x <= x_max; x++) {
+          const double px = x + 0.5;
+          // barycentric coordinates
+          double w[3];
+          for (int i = 0; i < 3; i++) {
+            int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            w[i] = ((tri.x[i2] - tri.x[i1]) * (py - tri.y[i1]) -
+                    (tri.y[i2] - tri.y[i1]) * (px - tri.x[i1])) /
+                   area;
+          }
+          if (w[0] < 0 || w[1] < 0 || w[2] < 0)
+            continue;
+          float z = w[0] * tri.z[0] + w[1] * tri.z[1] + w[2] * tri.z[2];
+          const int idx = (y - y0) * s_wd + x;
+          if (z > near_depth || z <= depth[idx])
+            continue;
+          if (tri.level < 16 && dither[y % 4][x % 4] >= tri.level)
+            continue;
+          float norm[3];
+          double len2 = 0;
+          for (int j = 0; j < 3; j++) {
+            norm[j] = w[0] * tri.norm[0][j] + w[1] * tri.norm[1][j] +
+                      w[2] * tri.norm[2][j];
+            len2 += norm[j] * norm[j];
+          }
+          double len = sqrt(len2);
+          if (len > 0)
+            for (int j = 0; j < 3; j++)
+              norm[j] /= len;
+          depth[idx] = z;
+          shade(norm, tri.col, &rgb[3 * idx]);
+        }
+      }
+    }
+
+    // Average the samples for each pixel
+    const float scale = 255.0 / (samples * samples);
+    for (int y = 0; y < rows / samples; y++)
+      for (int x = 0; x < width; x++)
+        for (int j = 0; j < 3; j++) {
+          float sum = 0;
+          for (int sy = 0; sy < samples; sy++)
+            for (int sx = 0; sx < samples; sx++)
+              sum += rgb[3 * ((y * samples + sy) * s_wd + x * samples + sx) +
+                         j];
+          pixels[3 * ((y0 / samples + y) * width + x) + j] =
+              (unsigned char)(sum * scale + 0.5);
+        }
+  };
+  parallel_for(num_bands, draw_band, num_threads);
+}
+
+void RasterWriter::render(const Scene &scen)
+{
+  set_view(scen);
+  tris.clear();
+  for (const auto &sc_geom : scen.get_geoms()) {
+    for (auto *disp : sc_geom.get_disps())
+      disp->raster_geom(*this, scen);
+    if (sc_geom.get_sym())
+      sc_geom.get_sym()->raster_geom(*this, scen);
+  }
+  rasterise(scen.get_bg_col());
+  tris.clear();
+  tris.shrink_to_fit();
+}
+
+Status RasterWriter::write_ppm(FILE *ofile) const
+{
+  fprintf(ofile, "P6\n%d %d\n255\n", width, height);
+  if (fwrite(pixels.data(), 1, pixels.size(), ofile) != pixels.size())
+    return Status::error("could not write image data");
+  return Status::ok();
+}
+
+Status RasterWriter::write_png(FILE *ofile) const
+{
+  const unsigned char sig[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  vector<unsigned char> png(sig, sig + 8);
+
+  vector<unsigned char> hdr;
+  put_u32(hdr, width);
+  put_u32(hdr, height);
+  hdr.insert(hdr.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, no interlace
+  put_chunk(png, "IHDR", hdr);
+
+  // Each row uses the Sub filter, so areas of a single colour are zeros
+  const int row_sz = 3 * width;
+  vector<unsigned char> filtered;
+  filtered.reserve((row_sz + 1) * height);
+  for (int y = 0; y < height; y++) {
+    const unsigned char *row = &pixels[y * row_sz];
+    filtered.push_back(1);
+    for (int i = 0; i < row_sz; i++)
+      filtered.push_back(row[i] - (i >= 3 ? row[i - 3] : 0));
+  }
+  put_chunk(png, "IDAT", zlib_compress(filtered));
+  put_chunk(png, "IEND", vector<unsigned char>());
+
+  if (fwrite(png.data(), 1, png.size(), ofile) != png.size())
+    return Status::error("could not write image data");
+  return Status::ok();
+}
+
+} // namespace anti
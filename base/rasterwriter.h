@@ -0,0 +1,175 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file rasterwriter.h
+ * \brief Render a scene to an image in software
+ */
+
+#ifndef RASTERWRITER_H
+#define RASTERWRITER_H
+
+#include "scene.h"
+#include "status.h"
+#include "trans3d.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace anti {
+
+/// Render a scene to a PNG or PPM image, without OpenGL
+/** Displayed elements are drawn as triangles with a depth buffer,
+ *  using the same camera and a similar light as antiview. Transparent
+ *  elements are drawn with a screen door pattern. */
+class RasterWriter : public SceneItem {
+private:
+  // A triangle in image coordinates, with view normals and colour
+  struct Tri {
+    float x[3], y[3], z[3];
+    float norm[3][3];
+    float col[4];
+    int level; // screen door level, 16 for opaque
+  };
+
+  int width;
+  int height;
+  int samples;
+  bool persp;
+  int num_threads;
+
+  Trans3d to_view;
+  Trans3d to_view_rot;
+  double view_wd;
+  float near_depth;
+  std::vector<Tri> tris;
+  std::vector<std::vector<Vec3d>> unit_sphs; // sphere meshes by divisions
+  std::vector<unsigned char> pixels;
+
+  void set_view(const Scene &scen);
+  bool project(const Vec3d &v, float &x, float &y, float &z) const;
+  int get_divs(const Vec3d &pt, double rad) const;
+  void rasterise(const Color &bg_col);
+
+public:
+  /// Constructor
+  /**\param wdth width of the image in pixels.
+   * \param hgt height of the image in pixels. */
+  RasterWriter(int wdth = 400, int hgt = 400)
+      : width(wdth), height(hgt), samples(2), persp(true), num_threads(0),
+        view_wd(1), near_depth(0)
+  {
+  }
+
+  /// Set the image size
+  /**\param wdth width of the image in pixels.
+   * \param hgt height of the image in pixels. */
+  void set_size(int wdth, int hgt)
+  {
+    width = wdth;
+    height = hgt;
+  }
+
+  /// Get the image width
+  /**\return The width in pixels. */
+  int get_width() const { return width; }
+
+  /// Get the image height
+  /**\return The height in pixels. */
+  int get_height() const { return height; }
+
+  /// Set the antialiasing
+  /**\param samps the number of samples along each side of a pixel,
+   *  \c 1 for no antialiasing. */
+  void set_samples(int samps) { samples = samps > 0 ? samps : 1; }
+
+  /// Set the projection
+  /**\param per \c true for a perspective view as in antiview, \c false
+   *  for a parallel view. */
+  void set_persp(bool per = true) { persp = per; }
+
+  /// Set the number of threads used for drawing
+  /**\param num_thrds the maximum number of threads to use, \c 0 for the
+   *  default. */
+  void set_num_threads(int num_thrds) { num_threads = num_thrds; }
+
+  /// Add a triangle to the image
+  /** Called by the scene displays while the scene is rendered.
+   * \param pts the vertices, in model coordinates.
+   * \param norms the normals at the vertices, in model coordinates.
+   * \param col the colour.
+   * \param trans \c true to use the colour transparency.
+   * \param closed \c true if the triangle is part of a closed surface,
+   *  and so its back is hidden unless it is transparent. */
+  void add_triangle(const Vec3d pts[3], const Vec3d norms[3], Color col,
+                    bool trans, bool closed = false);
+
+  /// Add a polygon to the image, shaded flat
+  /**\param verts the vertices of the geometry.
+   * \param face the polygon vertex index numbers, it is drawn as a fan.
+   * \param col the colour.
+   * \param trans \c true to use the colour transparency. */
+  void add_polygon(const std::vector<Vec3d> &verts,
+                   const std::vector<int> &face, Color col, bool trans);
+
+  /// Add a sphere to the image
+  /**\param cent the centre, in model coordinates.
+   * \param rad the radius.
+   * \param col the colour.
+   * \param trans \c true to use the colour transparency. */
+  void add_sphere(const Vec3d &cent, double rad, Color col, bool trans);
+
+  /// Add an open cylinder to the image
+  /**\param p0 the centre of one end, in model coordinates.
+   * \param p1 the centre of the other end, in model coordinates.
+   * \param rad the radius.
+   * \param col the colour.
+   * \param trans \c true to use the colour transparency. */
+  void add_cylinder(const Vec3d &p0, const Vec3d &p1, double rad, Color col,
+                    bool trans);
+
+  /// Render a scene
+  /** The image is drawn from the current camera.
+   * \param scen the scene. */
+  void render(const Scene &scen);
+
+  /// Get the image pixels
+  /**\return The pixels as RGB byte triples, row by row from the top. */
+  const std::vector<unsigned char> &get_pixels() const { return pixels; }
+
+  /// Write the image in PPM format
+  /**\param ofile file pointer to write to.
+   * \return status, which evaluates to \c true if the image was written. */
+  Status write_ppm(FILE *ofile) const;
+
+  /// Write the image in PNG format
+  /** The image data is compressed by matching runs of a repeated byte,
+   *  which suits images with large areas of flat colour.
+   * \param ofile file pointer to write to.
+   * \return status, which evaluates to \c true if the image was written. */
+  Status write_png(FILE *ofile) const;
+};
+
+} // namespace anti
+
+#endif // RASTERWRITER_H
@@ -0,0 +1,173 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file relaxation.cc
+   \brief Run the stages of an iterative relaxation in parallel
+*/
+
+#include "relaxation.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+using std::set;
+using std::vector;
+
+namespace anti {
+
+namespace {
+// index numbers handed to a thread at a time
+const size_t block_size = 256;
+// fewer index numbers than this are processed in the calling thread
+const size_t min_parallel = 2048;
+} // namespace
+
+FlatLists::FlatLists(const vector<vector<int>> &lists)
+{
+  starts.reserve(lists.size() + 1);
+  starts.push_back(0);
+  for (const auto &list : lists) {
+    vals.insert(vals.end(), list.begin(), list.end());
+    starts.push_back(vals.size());
+  }
+}
+
+Relaxation::Relaxation(Geometry &base_geom, const Symmetry &sym,
+                       int num_threads)
+    : base_geom(base_geom), using_symmetry(sym.get_sym_type() > Symmetry::C1),
+      sym_updater((using_symmetry) ? base_geom : Geometry(), sym),
+      num_threads(num_threads)
+{
+  if (using_symmetry) {
+    vert_orbits = sym_updater.get_equiv_sets(VERTS);
+    principal_verts = sym_updater.get_principal(VERTS);
+  }
+  else
+    principal_verts =
+        SymmetricUpdater::sequential_index_list(base_geom.verts().size());
+}
+
+vector<int>
+Relaxation::get_elems_to_process(const vector<vector<int>> &vert_elems,
+                                 int num_elems)
+{
+  if (using_symmetry)
+    return sym_updater.get_associated_elems(vert_elems);
+  else
+    return SymmetricUpdater::sequential_index_list(num_elems);
+}
+
+void Relaxation::add_verts_to_update(const vector<int> &v_idxs)
+{
+  if (using_symmetry) {
+    verts_to_update.insert(verts_to_update.end(), v_idxs.begin(),
+                           v_idxs.end());
+    SymmetricUpdater::to_unique_index_list(verts_to_update);
+  }
+}
+
+// A vertex is only written when updating itself, and principal vertices,
+// which are read, are not changed by an update
+void Relaxation::update_verts()
+{
+  for_each(verts_to_update,
+           [&](int v_idx) { sym_updater.update_from_principal_vertex(v_idx); });
+}
+
+void Relaxation::update_all_verts()
+{
+  if (using_symmetry)
+    for_range(get_geom().verts().size(), [&](int v_idx) {
+      sym_updater.update_from_principal_vertex(v_idx);
+    });
+}
+
+void Relaxation::for_each(const vector<int> &idxs,
+                          const std::function<void(int)> &kernel) const
+{
+  const size_t num = idxs.size();
+  const size_t num_blocks = (num + block_size - 1) / block_size;
+  parallel_for(
+      num_blocks,
+      [&](size_t b) {
+        const size_t end = std::min(num, (b + 1) * block_size);
+        for (size_t i = b * block_size; i < end; i++)
+          kernel(idxs[i]);
+      },
+      (num < min_parallel) ? 1 : num_threads);
+}
+
+void Relaxation::for_range(int num,
+                           const std::function<void(int)> &kernel) const
+{
+  const size_t num_blocks = (num + block_size - 1) / block_size;
+  parallel_for(
+      num_blocks,
+      [&](size_t b) {
+        const int end = (int)std::min((size_t)num, (b + 1) * block_size);
+        for (int i = b * block_size; i < end; i++)
+          kernel(i);
+      },
+      ((size_t)num < min_parallel) ? 1 : num_threads);
+}
+
+// Each principal vertex is the principal orbit vertex that it updates
+void Relaxation::move_verts(const std::function<Vec3d(int)> &new_vert)
+{
+  if (using_symmetry)
+    for_each(principal_verts, [&](int v_idx) {
+      sym_updater.update_principal_vertex(v_idx, new_vert(v_idx));
+    });
+  else
+    for_each(principal_verts,
+             [&](int v_idx) { base_geom.verts(v_idx) = new_vert(v_idx); });
+}
+
+// The working vertices are saved and restored as they are, including
+// any that have not been updated from their principal vertex
+Status Relaxation::resume(IterationControl &it_ctrl,
+                          std::initializer_list<double *> state)
+{
+  if (!it_ctrl.is_resume_pending())
+    return Status::ok();
+
+  vector<Vec3d> verts = get_geom().verts();
+  Status stat = it_ctrl.resume(verts, state);
+  if (stat.is_ok()) {
+    if (using_symmetry)
+      sym_updater.set_verts_working(verts);
+    else
+      base_geom.raw_verts() = verts;
+  }
+  return stat;
+}
+
+void Relaxation::finish()
+{
+  if (using_symmetry)
+    base_geom = sym_updater.get_geom_final();
+}
+
+} // namespace anti
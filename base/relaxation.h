@@ -0,0 +1,190 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file relaxation.h
+ * \brief Run the stages of an iterative relaxation in parallel
+ */
+
+#ifndef RELAXATION_H
+#define RELAXATION_H
+
+#include <functional>
+#include <initializer_list>
+#include <set>
+#include <vector>
+
+#include "geometry.h"
+#include "iteration.h"
+#include "symmetry.h"
+
+namespace anti {
+
+/// Lists of index numbers held in a single array
+/**Used for adjacency information that is read on every iteration, like
+ * the faces around each vertex. */
+class FlatLists {
+private:
+  std::vector<int> starts;
+  std::vector<int> vals;
+
+public:
+  /// Constructor
+  FlatLists() : starts(1, 0) {}
+
+  /// Constructor
+  /**\param lists the lists to store */
+  explicit FlatLists(const std::vector<std::vector<int>> &lists);
+
+  /// Get the number of lists
+  /**\return the number of lists. */
+  size_t size() const { return starts.size() - 1; }
+
+  /// Get the start of a list
+  /**\param idx the index number of the list
+   * \return a pointer to the first value of the list. */
+  const int *begin(int idx) const { return vals.data() + starts[idx]; }
+
+  /// Get the end of a list
+  /**\param idx the index number of the list
+   * \return a pointer to just past the last value of the list. */
+  const int *end(int idx) const { return vals.data() + starts[idx + 1]; }
+};
+
+/// Run the stages of an iterative relaxation in parallel
+/**Relaxation solvers adjust a model over many iterations. Each iteration
+ * calculates data for some elements, then an offset for each vertex that
+ * will move, and finally moves the vertices. With symmetry only the
+ * principal vertex of each vertex orbit is moved, and the other vertices
+ * that the calculations read are updated from these with a
+ * \c SymmetricUpdater.
+ *
+ * The calculations are passed as kernels which are called for each
+ * element in parallel, in blocks of elements. A kernel should only write
+ * to slots reserved for its element, so that the result does not depend
+ * on the number of threads. */
+class Relaxation {
+private:
+  Geometry &base_geom;
+  bool using_symmetry;
+  SymmetricUpdater sym_updater;
+  std::vector<std::set<int>> vert_orbits;
+  std::vector<int> principal_verts;
+  std::vector<int> verts_to_update;
+  int num_threads;
+
+public:
+  /// Constructor
+  /**\param base_geom the geometry to relax, which is updated by \c finish()
+   * \param sym symmetry to maintain, or \c C1 to move every vertex
+   * \param num_threads the maximum number of threads to use, \c 0 to use
+   *  the value of \c get_max_threads() */
+  Relaxation(Geometry &base_geom, const Symmetry &sym, int num_threads = 0);
+
+  /// Is symmetry being maintained
+  /**\return \c true if only principal vertices are moved. */
+  bool is_using_symmetry() const { return using_symmetry; }
+
+  /// Get the working geometry
+  /**\return the geometry that the kernels should read. */
+  const Geometry &get_geom() const
+  {
+    return (using_symmetry) ? sym_updater.get_geom_working() : base_geom;
+  }
+
+  /// Get the vertices that will be moved
+  /**\return the principal vertices, or all vertices without symmetry. */
+  const std::vector<int> &get_principal_verts() const
+  {
+    return principal_verts;
+  }
+
+  /// Get the vertex orbits
+  /**\return the vertex orbits, empty without symmetry. */
+  const std::vector<std::set<int>> &get_vert_orbits() const
+  {
+    return vert_orbits;
+  }
+
+  /// Get the elements associated with the vertices that will be moved
+  /**\param vert_elems the elements associated with each vertex
+   * \param num_elems the number of elements
+   * \return the elements associated with a principal vertex, or all the
+   *  elements without symmetry. */
+  std::vector<int>
+  get_elems_to_process(const std::vector<std::vector<int>> &vert_elems,
+                       int num_elems);
+
+  /// Add vertices that are read by the kernels
+  /**With symmetry these are updated from their principal vertices by
+   * \c update_verts(). Without symmetry there is nothing to do.
+   * \param v_idxs the index numbers of the vertices. */
+  void add_verts_to_update(const std::vector<int> &v_idxs);
+
+  /// Update the vertices read by the kernels from the principal vertices
+  void update_verts();
+
+  /// Update all vertices of the working geometry
+  void update_all_verts();
+
+  /// Call a kernel for each of a list of index numbers
+  /**\param idxs the index numbers
+   * \param kernel function to call with each index number. */
+  void for_each(const std::vector<int> &idxs,
+                const std::function<void(int)> &kernel) const;
+
+  /// Call a kernel for each index number in a range
+  /**\param num the number of index numbers, from \c 0 to \c num-1
+   * \param kernel function to call with each index number. */
+  void for_range(int num, const std::function<void(int)> &kernel) const;
+
+  /// Move the vertices
+  /**\param new_vert function that returns the new position for a vertex
+   *  that will be moved. */
+  void move_verts(const std::function<Vec3d(int)> &new_vert);
+
+  /// Write a checkpoint of the working geometry
+  /**\param it_ctrl the iteration control
+   * \param state values of the solver variables that are carried from one
+   *  iteration to the next
+   * \return status from \c IterationControl::checkpoint(). */
+  Status checkpoint(IterationControl &it_ctrl,
+                    std::initializer_list<double> state = {}) const
+  {
+    return it_ctrl.checkpoint(get_geom().verts(), state);
+  }
+
+  /// Resume the working geometry from a checkpoint
+  /**\param it_ctrl the iteration control
+   * \param state pointers to the solver variables
+   * \return status from \c IterationControl::resume(). */
+  Status resume(IterationControl &it_ctrl,
+                std::initializer_list<double *> state = {});
+
+  /// Copy the relaxed model to the geometry passed to the constructor
+  void finish();
+};
+
+} // namespace anti
+
+#endif // RELAXATION_H
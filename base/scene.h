@@ -44,6 +44,7 @@ class GeometryDisplay;
 class Scene;
 class Camera;
 class SceneGeometry;
+class RasterWriter;
 
 /// Basic display properties of an element type.
 class ElemDispProps {
@@ -198,6 +199,11 @@ public:
   /**\param scen the scene that the display is part of.*/
   virtual void gl_geom(const Scene &scen);
 
+  /// Draw geometry into a software rendered image.
+  /**\param rast the image writer to add the geometry to.
+   * \param scen the scene that the display is part of.*/
+  virtual void raster_geom(RasterWriter &rast, const Scene &scen);
+
   /// Update animated properties.
   /**\return The number of animation changes (\c 0 if no changes).*/
   virtual int animate() { return 0; }
@@ -205,6 +211,10 @@ public:
 
 inline void GeometryDisplay::gl_geom(const Scene & /*scen*/) {} // Avoid
                                                                 // warnings
+inline void GeometryDisplay::raster_geom(RasterWriter & /*rast*/,
+                                         const Scene & /*scen*/)
+{
+}
 
 class GeometryDisplayLabel : public virtual GeometryDisplay {
 private:
@@ -34,6 +34,7 @@
 #include "geometryinfo.h"
 #include "geometryutils.h"
 #include "mathutils.h"
+#include "profile.h"
 
 #include <algorithm>
 #include <cstring>
@@ -494,6 +495,7 @@ bool sort_merge_elems(Geometry &geom, const string &merge_elems,
                       vector<map<int, set<int>>> *equiv_elems,
                       bool chk_coincidence, int blend_type, double eps)
 {
+  ANTI_PROFILE_SCOPE("merge");
   // an empty geom cannot be processed
   if (!geom.verts().size())
     return false;
@@ -29,6 +29,7 @@
 #include "symmetry.h"
 #include "geometryinfo.h"
 #include "mathutils.h"
+#include "profile.h"
 #include "utils.h"
 
 #include <algorithm>
@@ -1113,6 +1114,7 @@ Symmetry::Symmetry(const SymmetryAxis &sym_axis, const Vec3d &cent)
 Status Symmetry::init(const Geometry &geom,
                       vector<vector<set<int>>> *equiv_sets)
 {
+  ANTI_PROFILE_SCOPE("symmetry");
   sym_type = unknown;
   Transformations ts;
   find_syms(geom, ts, equiv_sets);
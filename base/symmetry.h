@@ -812,6 +812,14 @@ public:
    * \return the working geometry */
   const Geometry &get_geom_working() const { return geom; }
 
+  /// Set the working geometry vertex coordinates
+  /**Restores working coordinates that were saved, e.g. in a checkpoint
+   * \param verts the vertex coordinates */
+  void set_verts_working(const std::vector<Vec3d> &verts)
+  {
+    geom.raw_verts() = verts;
+  }
+
   /// Get the final geometry after all iteration has finished
   /** \return the final geometry */
   const Geometry &get_geom_final();
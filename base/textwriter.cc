@@ -0,0 +1,425 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file textwriter.cc
+   \brief Buffered writing of numbers and text to a file stream
+*/
+
+#include "textwriter.h"
+#include "vec3d.h"
+#include "vec4d.h"
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+using std::string;
+using std::vector;
+
+namespace anti {
+
+// don't export these functions
+namespace {
+
+// A 192 bit unsigned integer, least significant limb first
+struct Uint192 {
+  uint64_t limb[3];
+};
+
+// Full product of two 64 bit integers
+void mul64(uint64_t a, uint64_t b, uint64_t &hi, uint64_t &lo)
+{
+  const uint64_t mask = 0xffffffff;
+  uint64_t a_lo = a & mask, a_hi = a >> 32;
+  uint64_t b_lo = b & mask, b_hi = b >> 32;
+  uint64_t ll = a_lo * b_lo;
+  uint64_t lh = a_lo * b_hi;
+  uint64_t hl = a_hi * b_lo;
+  uint64_t hh = a_hi * b_hi;
+  uint64_t mid = (ll >> 32) + (lh & mask) + (hl & mask);
+  lo = (mid << 32) | (ll & mask);
+  hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+}
+
+// Largest power of ten that can be held exactly in 128 bits
+const int max_pow10 = 38;
+
+// Powers of ten as 128 bit integers, {high limb, low limb}
+const uint64_t (*pow10_table())[2]
+{
+  static uint64_t table[max_pow10 + 1][2];
+  static bool init = [] {
+    table[0][0] = 0;
+    table[0][1] = 1;
+    for (int i = 1; i <= max_pow10; i++) {
+      uint64_t carry, lo;
+      mul64(table[i - 1][1], 10, carry, lo);
+      table[i][0] = table[i - 1][0] * 10 + carry;
+      table[i][1] = lo;
+    }
+    return true;
+  }();
+  (void)init;
+  return table;
+}
+
+// Index of the highest set bit, or -1 if the number is zero
+int top_bit(const Uint192 &n)
+{
+  for (int i = 2; i >= 0; i--)
+    if (n.limb[i]) {
+      int bit = 63;
+      while (!(n.limb[i] >> bit))
+        bit--;
+      return 64 * i + bit;
+    }
+  return -1;
+}
+
+bool get_bit(const Uint192 &n, int idx)
+{
+  return (n.limb[idx / 64] >> (idx % 64)) & 1;
+}
+
+// Whether any bit below idx is set
+bool any_bits_below(const Uint192 &n, int idx)
+{
+  int whole = idx / 64;
+  for (int i = 0; i < whole; i++)
+    if (n.limb[i])
+      return true;
+  int part = idx % 64;
+  return part && (n.limb[whole] & ((uint64_t(1) << part) - 1));
+}
+
+// Find the integer nearest to m * 2^e * 10^k, rounding halves to even.
+// The integer part is returned in whole, and false is returned if
+// either value does not fit in 64 bits.
+bool scaled_int(uint64_t m, int e, int k, uint64_t &whole, uint64_t &rnd)
+{
+  const uint64_t(*p10)[2] = pow10_table();
+  Uint192 n;
+  uint64_t h0, h1;
+  mul64(m, p10[k][1], h0, n.limb[0]);
+  mul64(m, p10[k][0], h1, n.limb[1]);
+  n.limb[1] += h0;
+  n.limb[2] = h1 + (n.limb[1] < h0);
+
+  int top = top_bit(n);
+  if (e >= 0) {
+    if (top + e >= 64)
+      return false;
+    whole = rnd = n.limb[0] << e;
+    return true;
+  }
+
+  int s = -e;
+  if (top < s - 1) { // less than a half
+    whole = rnd = 0;
+    return true;
+  }
+  if (top >= s + 64)
+    return false;
+
+  int w = s / 64;
+  int b = s % 64;
+  whole = 0;
+  if (w < 3) {
+    whole = n.limb[w] >> b;
+    if (b && w < 2)
+      whole |= n.limb[w + 1] << (64 - b);
+  }
+
+  rnd = whole;
+  if (get_bit(n, s - 1) && (any_bits_below(n, s - 1) || (whole & 1))) {
+    if (++rnd == 0)
+      return false;
+  }
+  return true;
+}
+
+// Write the decimal digits of an integer, return the number written
+int put_digits(char *buf, uint64_t val)
+{
+  char tmp[20];
+  int len = 0;
+  do {
+    tmp[len++] = '0' + val % 10;
+    val /= 10;
+  } while (val);
+  for (int i = 0; i < len; i++)
+    buf[i] = tmp[len - 1 - i];
+  return len;
+}
+
+// Format as "%.*g" into buf, which must hold at least 32 characters.
+// Returns the length, or -1 if the value is not handled.
+int format_sig(char *buf, double val, bool neg, uint64_t m, int e, int prec)
+{
+  const uint64_t(*p10)[2] = pow10_table();
+  if (prec > 17)
+    return -1;
+  if (prec == 0)
+    prec = 1;
+
+  char *p = buf;
+  if (neg)
+    *p++ = '-';
+  if (m == 0) {
+    *p++ = '0';
+    return p - buf;
+  }
+
+  // find the digits and decimal exponent after rounding
+  const uint64_t lo_lim = p10[prec - 1][1];
+  const uint64_t hi_lim = p10[prec][1];
+  int exp10 = (int)floor(log10(fabs(val)));
+  uint64_t whole, digits = 0;
+  bool found = false;
+  for (int tries = 0; tries < 3 && !found; tries++) {
+    int k = prec - 1 - exp10;
+    if (k < 0 || k > max_pow10 || !scaled_int(m, e, k, whole, digits))
+      return -1;
+    if (whole >= hi_lim)
+      exp10++;
+    else if (whole < lo_lim)
+      exp10--;
+    else
+      found = true;
+  }
+  if (!found)
+    return -1;
+  if (digits == hi_lim) { // rounding carried to another digit
+    digits = lo_lim;
+    exp10++;
+  }
+
+  char dgts[20];
+  put_digits(dgts, digits);
+  int num_dgts = prec;
+  while (num_dgts > 1 && dgts[num_dgts - 1] == '0')
+    num_dgts--;
+
+  if (exp10 >= -4 && exp10 < prec) {
+    if (exp10 >= 0) {
+      int int_dgts = exp10 + 1;
+      memcpy(p, dgts, int_dgts);
+      p += int_dgts;
+      if (num_dgts > int_dgts) {
+        *p++ = '.';
+        memcpy(p, dgts + int_dgts, num_dgts - int_dgts);
+        p += num_dgts - int_dgts;
+      }
+    }
+    else {
+      *p++ = '0';
+      *p++ = '.';
+      for (int i = 0; i < -exp10 - 1; i++)
+        *p++ = '0';
+      memcpy(p, dgts, num_dgts);
+      p += num_dgts;
+    }
+  }
+  else {
+    *p++ = dgts[0];
+    if (num_dgts > 1) {
+      *p++ = '.';
+      memcpy(p, dgts + 1, num_dgts - 1);
+      p += num_dgts - 1;
+    }
+    *p++ = 'e';
+    *p++ = (exp10 < 0) ? '-' : '+';
+    int exp_abs = abs(exp10);
+    if (exp_abs < 10)
+      *p++ = '0';
+    p += put_digits(p, exp_abs);
+  }
+  return p - buf;
+}
+
+// Format as "%.*f" into buf, which must hold at least 64 characters.
+// Returns the length, or -1 if the value is not handled.
+int format_fixed(char *buf, bool neg, uint64_t m, int e, int prec)
+{
+  uint64_t whole, rnd;
+  if (prec > max_pow10 || !scaled_int(m, e, prec, whole, rnd))
+    return -1;
+
+  char *p = buf;
+  if (neg)
+    *p++ = '-';
+  char dgts[20];
+  int num_dgts = put_digits(dgts, rnd);
+  int int_dgts = num_dgts - prec;
+  if (int_dgts > 0) {
+    memcpy(p, dgts, int_dgts);
+    p += int_dgts;
+  }
+  else
+    *p++ = '0';
+
+  if (prec) {
+    *p++ = '.';
+    for (int i = 0; i < -int_dgts; i++)
+      *p++ = '0';
+    int frac_dgts = (int_dgts < 0) ? num_dgts : prec;
+    memcpy(p, dgts + num_dgts - frac_dgts, frac_dgts);
+    p += frac_dgts;
+  }
+  return p - buf;
+}
+
+} // namespace
+
+int format_double(char *buf, size_t buf_sz, double val, int sig_dgts)
+{
+  uint64_t bits;
+  memcpy(&bits, &val, sizeof(bits));
+  bool neg = bits >> 63;
+  int exp_bits = (bits >> 52) & 0x7ff;
+  uint64_t frac = bits & ((uint64_t(1) << 52) - 1);
+
+  // zero and normal numbers are handled directly, when the buffer is large
+  // enough for the longest result, otherwise use the standard library
+  int len = -1;
+  if (buf_sz >= 64 && exp_bits != 0x7ff && (exp_bits || !frac)) {
+    uint64_t m = exp_bits ? frac | (uint64_t(1) << 52) : 0;
+    int e = exp_bits ? exp_bits - 1075 : 0;
+    if (sig_dgts > 0)
+      len = format_sig(buf, val, neg, m, e, sig_dgts);
+    else
+      len = format_fixed(buf, neg, m, e, -sig_dgts);
+  }
+
+  if (len < 0) {
+    if (sig_dgts > 0)
+      len = snprintf(buf, buf_sz, "%.*g", sig_dgts, val);
+    else
+      len = snprintf(buf, buf_sz, "%.*f", -sig_dgts, val);
+  }
+  else
+    buf[len] = '\0';
+  return len;
+}
+
+TextWriter::TextWriter(FILE *ofile, size_t buf_sz)
+    : ofile(ofile), buf(buf_sz), pos(0)
+{
+}
+
+TextWriter::~TextWriter() { flush(); }
+
+void TextWriter::flush()
+{
+  if (pos)
+    fwrite(buf.data(), 1, pos, ofile);
+  pos = 0;
+}
+
+char *TextWriter::reserve(size_t sz)
+{
+  if (buf.size() - pos < sz) {
+    flush();
+    if (buf.size() < sz)
+      buf.resize(sz);
+  }
+  return buf.data() + pos;
+}
+
+TextWriter &TextWriter::put(const char *str)
+{
+  size_t len = strlen(str);
+  if (buf.size() - pos < len) {
+    flush();
+    if (buf.size() < len) {
+      fwrite(str, 1, len, ofile);
+      return *this;
+    }
+  }
+  memcpy(buf.data() + pos, str, len);
+  pos += len;
+  return *this;
+}
+
+TextWriter &TextWriter::put_int(long val)
+{
+  char *p = reserve(24);
+  unsigned long uval = val;
+  if (val < 0) {
+    *p++ = '-';
+    uval = 0 - uval;
+    pos++;
+  }
+  pos += put_digits(p, uval);
+  return *this;
+}
+
+TextWriter &TextWriter::put_double(double val, int sig_dgts)
+{
+  const size_t min_sz = 64;
+  char *p = reserve(min_sz);
+  size_t avail = buf.size() - pos;
+  size_t len = format_double(p, avail, val, sig_dgts);
+  if (len >= avail) {
+    p = reserve(len + 1);
+    format_double(p, len + 1, val, sig_dgts);
+  }
+  pos += len;
+  return *this;
+}
+
+TextWriter &TextWriter::put_vec(const Vec3d &v, const char *sep, int sig_dgts)
+{
+  if (!v.is_set())
+    return put("not set");
+  put_double(v[0], sig_dgts).put(sep);
+  put_double(v[1], sig_dgts).put(sep);
+  return put_double(v[2], sig_dgts);
+}
+
+TextWriter &TextWriter::put_vec(const Vec4d &v, const char *sep, int sig_dgts)
+{
+  for (int i = 0; i < 3; i++)
+    put_double(v[i], sig_dgts).put(sep);
+  return put_double(v[3], sig_dgts);
+}
+
+TextWriter &TextWriter::printf(const char *fmt, ...)
+{
+  va_list args, args_retry;
+  va_start(args, fmt);
+  va_copy(args_retry, args);
+  size_t avail = buf.size() - pos;
+  size_t len = vsnprintf(buf.data() + pos, avail, fmt, args);
+  if (len >= avail)
+    vsnprintf(reserve(len + 1), len + 1, fmt, args_retry);
+  pos += len;
+  va_end(args_retry);
+  va_end(args);
+  return *this;
+}
+
+} // namespace anti
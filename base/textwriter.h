@@ -0,0 +1,144 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*!\file textwriter.h
+ * \brief Buffered writing of numbers and text to a file stream
+ */
+
+#ifndef TEXTWRITER_H
+#define TEXTWRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace anti {
+
+class Vec3d;
+class Vec4d;
+
+/// Format a number in the same way as \c printf
+/**The number is formatted as by \c "%.*g" with precision \c sig_dgts when
+ * \c sig_dgts is positive, and otherwise as by \c "%.*f" with precision
+ * \c -sig_dgts. The output is identical to \c snprintf, but common values
+ * are converted without the overhead of parsing a format.
+ * \param buf buffer to write the number into.
+ * \param buf_sz size of \c buf.
+ * \param val the number to format.
+ * \param sig_dgts the number of significant digits, or the negative of
+ *  the number of decimal places.
+ * \return The length of the formatted number. If this is not less than
+ *  \c buf_sz then the output was truncated, as for \c snprintf. */
+int format_double(char *buf, size_t buf_sz, double val, int sig_dgts);
+
+/// Write text to a file stream through a buffer
+/**Text is accumulated in a buffer and passed to the stream in large
+ * blocks. The buffer is flushed when the writer is destroyed, and must
+ * be flushed before other output is written directly to the stream. */
+class TextWriter {
+private:
+  FILE *ofile;
+  std::vector<char> buf;
+  size_t pos;
+
+  // make room for at least sz characters, return the write position
+  char *reserve(size_t sz);
+
+public:
+  /// Constructor
+  /**\param ofile the stream to write to.
+   * \param buf_sz the size of the buffer. */
+  explicit TextWriter(FILE *ofile, size_t buf_sz = 1 << 16);
+
+  /// Destructor, flushes the buffer
+  ~TextWriter();
+
+  TextWriter(const TextWriter &) = delete;
+  TextWriter &operator=(const TextWriter &) = delete;
+
+  /// Write the buffered text to the stream
+  void flush();
+
+  /// Write a string
+  /**\param str the string.
+   * \return A reference to this object. */
+  TextWriter &put(const char *str);
+
+  /// Write a string
+  /**\param str the string.
+   * \return A reference to this object. */
+  TextWriter &put(const std::string &str) { return put(str.c_str()); }
+
+  /// Write a character
+  /**\param c the character.
+   * \return A reference to this object. */
+  TextWriter &put(char c)
+  {
+    *reserve(1) = c;
+    pos++;
+    return *this;
+  }
+
+  /// Write an integer, as by \c "%ld"
+  /**\param val the integer.
+   * \return A reference to this object. */
+  TextWriter &put_int(long val);
+
+  /// Write a number
+  /**\param val the number.
+   * \param sig_dgts the number of significant digits, or the negative of
+   *  the number of decimal places, as for \c format_double().
+   * \return A reference to this object. */
+  TextWriter &put_double(double val, int sig_dgts);
+
+  /// Write the coordinates of a vector, as by \c Vec3d::to_str()
+  /**\param v the vector.
+   * \param sep the separator between the coordinates.
+   * \param sig_dgts the number of significant digits, or the negative of
+   *  the number of decimal places.
+   * \return A reference to this object. */
+  TextWriter &put_vec(const Vec3d &v, const char *sep, int sig_dgts);
+
+  /// Write the coordinates of a vector, as by \c Vec4d::to_str()
+  /**\param v the vector.
+   * \param sep the separator between the coordinates.
+   * \param sig_dgts the number of significant digits, or the negative of
+   *  the number of decimal places.
+   * \return A reference to this object. */
+  TextWriter &put_vec(const Vec4d &v, const char *sep, int sig_dgts);
+
+  /// Write formatted text, as by \c printf
+  /**\param fmt the format.
+   * \param ... the values for the format.
+   * \return A reference to this object. */
+  TextWriter &printf(const char *fmt, ...)
+#ifdef __GNUC__
+      __attribute__((format(printf, 2, 3)))
+#endif
+      ;
+};
+
+} // namespace anti
+
+#endif // TEXTWRITER_H
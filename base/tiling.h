@@ -256,6 +256,14 @@ private:
 
   bool one_of_each_tile; ///< Only plot one tile per kind
 
+  /// Index numbers of the meta tiling elements of one inclusion type
+  /**Elements are numbered in order of their vertex index, or of their
+   * vertex-sorted vertex index pair for edges. */
+  struct ElemIndex {
+    std::vector<int> order; ///< Number of the element, by meta face
+    std::vector<int> tris;  ///< Example meta face, by element number
+  };
+
   /// Find base tiling face neighbours
   /** \return Status, which evaluates to \c true if the nieghbours were
    *  found successfully, otherwise \c false to indicate an error. */
@@ -278,18 +286,22 @@ private:
   int get_associated_element(int start_idx, const std::string &step,
                              int assoc_type) const;
 
-  /// Add a circuit (face) for an individual tile pattern
-  /**\param geom the geometry to add the circuit face to
-   * \param start_index the base triangle to start the circuit
-   * \param seen base triangles that have already been used
-   * \param index order used to calculate final vertex index numbers
-   * \param point_vertex_offsets used to calculate final vertex index numbers */
-  void
-  add_circuit(Geometry &geom, int start_idx, const Tile &pat,
-              std::vector<bool> &seen, Color col,
-              const std::vector<std::map<std::vector<int>, std::pair<int, int>>>
-                  &index_order,
-              const std::vector<int> &point_vertex_offsets) const;
+  /// Follow the circuit for an individual tile pattern
+  /**\param start_idx the base triangle to start the circuit
+   * \param pat the tile pattern, which keeps the reading position, so a
+   *  copy must be used by each thread
+   * \param index_order used to calculate final vertex index numbers
+   * \param point_vertex_offsets used to calculate final vertex index numbers
+   * \param face to return the circuit face
+   * \param starts the start triangle of each application of the pattern
+   *  is appended, including for a circuit that did not complete
+   * \return \c true if the circuit completed, \c false if the circuit
+   *  tried to cross an open edge. */
+  bool trace_circuit(int start_idx, const Tile &pat,
+                     const std::vector<ElemIndex> &index_order,
+                     const std::vector<int> &point_vertex_offsets,
+                     std::vector<int> &face, std::vector<int> &starts) const;
+
   /// Get the tile patterns
   /** \return The tile patterns. */
   const std::vector<Tile> &get_pat_paths() const { return pat_paths; }
@@ -341,13 +353,16 @@ public:
   Status add_tile(const std::string &pat);
 
   /// Make the tiling
-  /**\param geom the geometry to return the tiling
+  /**The tiling is the same for any number of threads.
+   * \param geom the geometry to return the tiling
    * \param tile_reports reports about the paths and the tiles produced
+   * \param num_threads the maximum number of threads to use, \c 0 for
+   *  the default.
    * \return Status, which evaluates to \c true if the tiling was
    *  successfully created, otherwise \c false to indicate an error. */
-  Status
-  make_tiling(Geometry &geom,
-              std::vector<Tile::TileReport> *tile_reports = nullptr) const;
+  Status make_tiling(Geometry &geom,
+                     std::vector<Tile::TileReport> *tile_reports = nullptr,
+                     int num_threads = 0) const;
 
   /// Read tiling pattern
   /**\param pat the tiling pattern string
@@ -28,7 +28,9 @@
 
 #include "trans3d.h"
 #include "mathutils.h"
+#include "parallel.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <vector>
 
@@ -383,4 +385,89 @@ Trans3d Trans3d::align(Vec3d from1, Vec3d from2, Vec3d to1, Vec3d to2)
   return inv_r * trans;
 }
 
+namespace {
+
+// Points are loaded into separate coordinate arrays in blocks of this size,
+// so that the arithmetic can be vectorised
+const int block_sz = 8;
+
+// Sets with at least this many points are transformed in parallel, in
+// chunks of chunk_sz points
+const size_t par_min_sz = 1 << 15;
+const size_t chunk_sz = 1 << 12;
+
+// Transform num points from src to dst, which may be the same. The
+// operations are done in the same order as in trans*vec.
+void transform_range(const Trans3d &trans, const Vec3d *src, Vec3d *dst,
+                     size_t num)
+{
+  double m[12];
+  for (int i = 0; i < 12; i++)
+    m[i] = trans[i];
+
+  double x[block_sz], y[block_sz], z[block_sz];
+  for (size_t start = 0; start < num; start += block_sz) {
+    int n = (int)std::min(num - start, (size_t)block_sz);
+    for (int i = 0; i < n; i++) {
+      x[i] = src[start + i][0];
+      y[i] = src[start + i][1];
+      z[i] = src[start + i][2];
+    }
+    for (int i = n; i < block_sz; i++)
+      x[i] = y[i] = z[i] = 0.0;
+
+    double nx[block_sz], ny[block_sz], nz[block_sz];
+    for (int i = 0; i < block_sz; i++) {
+      nx[i] = 0.0 + m[0] * x[i] + m[1] * y[i] + m[2] * z[i] + m[3];
+      ny[i] = 0.0 + m[4] * x[i] + m[5] * y[i] + m[6] * z[i] + m[7];
+      nz[i] = 0.0 + m[8] * x[i] + m[9] * y[i] + m[10] * z[i] + m[11];
+    }
+
+    for (int i = 0; i < n; i++)
+      dst[start + i] = Vec3d(nx[i], ny[i], nz[i]);
+  }
+}
+
+// Transform the points by each transformation, writing the results for
+// transformation i to dst + i*num
+void transform_all(const Trans3d *transs, size_t num_transs, const Vec3d *src,
+                   Vec3d *dst, size_t num)
+{
+  if (num * num_transs < par_min_sz) {
+    for (size_t i = 0; i < num_transs; i++)
+      transform_range(transs[i], src, dst + i * num, num);
+    return;
+  }
+
+  size_t chunks_per_trans = (num + chunk_sz - 1) / chunk_sz;
+  parallel_for(num_transs * chunks_per_trans, [&](size_t idx) {
+    size_t t_idx = idx / chunks_per_trans;
+    size_t start = (idx % chunks_per_trans) * chunk_sz;
+    size_t n = std::min(num - start, chunk_sz);
+    transform_range(transs[t_idx], src + start, dst + t_idx * num + start, n);
+  });
+}
+
+} // namespace
+
+void transform(vector<Vec3d> &vecs, const Trans3d &trans)
+{
+  transform_all(&trans, 1, vecs.data(), vecs.data(), vecs.size());
+}
+
+void transform(vector<Vec3d> &dst, const vector<Vec3d> &vecs,
+               const Trans3d &trans)
+{
+  dst.resize(vecs.size());
+  transform_all(&trans, 1, vecs.data(), dst.data(), vecs.size());
+}
+
+void transform(vector<Vec3d> &dst, const vector<Vec3d> &vecs,
+               const vector<Trans3d> &transs)
+{
+  dst.resize(vecs.size() * transs.size());
+  transform_all(transs.data(), transs.size(), vecs.data(), dst.data(),
+                vecs.size());
+}
+
 } // namespace anti
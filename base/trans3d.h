@@ -281,10 +281,28 @@ int compare(const Trans3d &trans1, const Trans3d &trans2, double eps = epsilon);
 bool operator<(const Trans3d &trans1, const Trans3d &trans2);
 
 /// Transform a set of vectors
-/**\param vecs the (column) vectors to transform.
+/**Large sets are transformed in parallel. The results are identical to
+ * applying \c trans*vec to each vector.
+ * \param vecs the (column) vectors to transform.
  * \param trans the transformation to apply. */
 void transform(std::vector<Vec3d> &vecs, const Trans3d &trans);
 
+/// Transform a set of vectors into another set
+/**\param dst used to return the transformed vectors.
+ * \param vecs the (column) vectors to transform.
+ * \param trans the transformation to apply. */
+void transform(std::vector<Vec3d> &dst, const std::vector<Vec3d> &vecs,
+               const Trans3d &trans);
+
+/// Transform a set of vectors by each of several transformations
+/**\param dst used to return the transformed vectors, the vectors
+ *  transformed by \c transs[0], followed by the vectors transformed by
+ *  \c transs[1], and so on.
+ * \param vecs the (column) vectors to transform.
+ * \param transs the transformations to apply. */
+void transform(std::vector<Vec3d> &dst, const std::vector<Vec3d> &vecs,
+               const std::vector<Trans3d> &transs);
+
 // inline functions
 inline Trans3d::Trans3d()
 {
@@ -399,12 +417,6 @@ inline bool operator==(const Trans3d &trans1, const Trans3d &trans2)
   return true;
 }
 
-inline void transform(std::vector<Vec3d> &vecs, const Trans3d &trans)
-{
-  for (auto &v : vecs)
-    v = trans * v;
-}
-
 } // namespace anti
 
 #endif // TRANS3D_H
@@ -33,6 +33,7 @@
 #include "../config.h"
 #endif
 
+#include <atomic>
 #include <cctype>
 #include <climits>
 #include <cmath>
@@ -44,6 +45,7 @@
 #include <string>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 #include <vector>
 
 using std::map;
@@ -133,12 +135,9 @@ Status read_int_list(const char *str, vector<int> &nums, bool is_index, int len,
   nums.clear();
   int vec_idx;
 
-  string str_cpy(str);         // copy, do not access as C++ string
-  char *str_ptr = &str_cpy[0]; // may be used to modify characters
-
-  char *v_str = strtok(str_ptr, sep);
+  Split parts(str, sep);
   int i = 0;
-  while (v_str) {
+  for (const char *v_str : parts.get_parts()) {
     i++;
     if (!read_int(v_str, &vec_idx))
       return Status::error(msg_str("'%s' is not an integer", v_str));
@@ -150,7 +149,6 @@ Status read_int_list(const char *str, vector<int> &nums, bool is_index, int len,
       return Status::error(msg_str("more than %d integers given", len));
 
     nums.push_back(vec_idx);
-    v_str = strtok(nullptr, sep);
   }
 
   return Status::ok();
@@ -185,11 +183,8 @@ Status read_idx_list(const char *str, vector<int> &nums, int num_idxs,
   int idx, idx2;
   char *p;
 
-  string str_cpy(str);         // copy, do not access as C++ string
-  char *str_ptr = &str_cpy[0]; // may be used to modify characters
-
-  char *v_str = strtok(str_ptr, ",");
-  while (v_str) {
+  Split parts(str, ",");
+  for (char *v_str : parts.get_parts()) {
     if ((p = strchr(v_str, '-'))) { // process a range
       *p = '\0';                    // terminate first index
       if (*v_str) {
@@ -227,7 +222,6 @@ Status read_idx_list(const char *str, vector<int> &nums, int num_idxs,
       }
       nums.push_back(idx + extra * num_idxs);
     }
-    v_str = strtok(nullptr, ",");
   }
 
   return Status::ok();
@@ -265,13 +259,10 @@ static Status read_double_list(const char *str, vector<double> &nums, int len,
 {
   nums.clear();
 
-  string str_cpy(str);         // copy, do not access as C++ string
-  char *str_ptr = &str_cpy[0]; // may be used to modify characters
-
   double num;
-  char *num_str = strtok(str_ptr, sep);
+  Split parts(str, sep);
   int i = 0;
-  while (num_str) {
+  for (const char *num_str : parts.get_parts()) {
     i++;
     Status stat = (parse) ? read_double(num_str, &num)
                           : read_double_noparse(num_str, &num);
@@ -282,7 +273,6 @@ static Status read_double_list(const char *str, vector<double> &nums, int len,
       return Status::error(msg_str("more than %d numbers given", len));
 
     nums.push_back(num);
-    num_str = strtok(nullptr, sep);
   }
 
   return Status::ok();
@@ -539,6 +529,12 @@ FILE *open_sup_file(const char *fname, const char *subdir, string *alt_name,
   return nullptr;
 }
 
+string get_tmp_file_name(const string &fpath)
+{
+  static std::atomic<unsigned long> cnt(0);
+  return msg_str("%s.%ld.%lu.tmp", fpath.c_str(), (long)getpid(), cnt++);
+}
+
 // https://stackoverflow.com/questions/2342162/stdstring-formatting-
 // like-sprintf/49812018#49812018
 string msg_str(const char *fmt, ...)
@@ -581,13 +577,14 @@ int split_line(char *line, vector<char *> &parts, const char *delims,
     }
   }
   else {
-    char *val;
-    if (!(val = strtok(line, delims)))
-      return 0;
-
-    parts.push_back(val);
-    while ((val = strtok(nullptr, delims)))
-      parts.push_back(val);
+    // like strtok, but without shared state, so safe to use in threads
+    char *cur = line;
+    while (*(cur += strspn(cur, delims))) { // skip delimiters, quit at end
+      parts.push_back(cur);                 // start of part
+      cur += strcspn(cur, delims);          // end of part
+      if (*cur)
+        *cur++ = '\0'; // terminate part
+    }
   }
 
   return parts.size();
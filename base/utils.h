@@ -214,6 +214,14 @@ FILE *open_sup_file(const char *fname, const char *subdir,
                     std::string *alt_name = nullptr, int *where = nullptr,
                     std::string *fpath = nullptr);
 
+/// Get a name for a temporary file, to be renamed to a path when complete
+/**The name is the path with the process ID and a count appended, so that
+ * processes and threads writing the same path use different temporary
+ * files, and it is in the same directory as the path.
+ * \param fpath the path the file will be renamed to.
+ * \return The temporary file name. */
+std::string get_tmp_file_name(const std::string &fpath);
+
 /// Convert a C formated message string to a C++ string
 /**\param fmt the formatted string
  * \param ... the values for the format
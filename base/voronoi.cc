@@ -0,0 +1,146 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file voronoi.cc
+   \brief Voronoi cells calculated locally, cell by cell.
+*/
+
+#include "boundbox.h"
+#include "geometry.h"
+#include "geometryutils.h"
+#include "parallel.h"
+#include "private_point_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using std::vector;
+
+namespace anti {
+
+namespace {
+
+// Calculate the cell of a point, as the intersection of the half-spaces
+// on its side of the planes bisecting it and its neighbours. The
+// intersection is found as the polar dual of the hull of the plane
+// poles, taken with the point as origin. Returns 1 if the cell is
+// finite, 0 if not, and sets the cell radius.
+int local_cell(const vector<Vec3d> &pts, int idx, const vector<int> &nbrs,
+               Geometry &cell, double &radius, double eps)
+{
+  const Vec3d &pt = pts[idx];
+  Geometry poles;
+  for (int nbr : nbrs) {
+    Vec3d norm = pts[nbr] - pt;
+    double len2 = norm.len2();
+    if (len2 > eps * eps)
+      poles.add_vert(norm * (2 / len2));
+  }
+
+  int dim;
+  if (poles.verts().size() < 4 || !poles.set_hull("", &dim) || dim < 3)
+    return 0;
+
+  // the cell is finite if the point is strictly inside the hull of poles
+  cell.clear_all();
+  radius = 0.0;
+  for (unsigned int i = 0; i < poles.faces().size(); i++) {
+    Vec3d norm = poles.face_norm(i).unit();
+    double offset = vdot(norm, poles.face_v(i, 0));
+    if (offset < eps)
+      return 0;
+    radius = std::max(radius, 1 / offset);
+    cell.add_vert(pt + norm / offset);
+  }
+
+  merge_coincident_elements(cell, "v", eps);
+  cell.add_hull();
+  return 1;
+}
+
+} // namespace
+
+Status get_voronoi_cells_local(const vector<Vec3d> &verts,
+                               vector<Geometry> *cells, double eps,
+                               int num_threads, const vector<int> *idxs)
+{
+  if (verts.size() < 5)
+    return Status::error("too few points to calculate voronoi cells");
+
+  // points on the convex hull have infinite cells
+  Geometry hull;
+  hull.raw_verts() = verts;
+  hull.set_hull();
+  vector<Vec3d> norms(hull.faces().size());
+  vector<double> offsets(hull.faces().size());
+  for (unsigned int i = 0; i < hull.faces().size(); i++) {
+    norms[i] = hull.face_norm(i).unit();
+    offsets[i] = vdot(norms[i], hull.face_v(i, 0));
+  }
+
+  PointGrid grid(verts);
+  const double all_dist = BoundBox(verts).max_width() * (1 + epsilon);
+  vector<Geometry> all_cells(verts.size());
+  vector<char> finite(verts.size(), 0);
+
+  vector<int> all_idxs;
+  if (!idxs) {
+    all_idxs.resize(verts.size());
+    for (unsigned int i = 0; i < verts.size(); i++)
+      all_idxs[i] = i;
+    idxs = &all_idxs;
+  }
+
+  parallel_for(
+      idxs->size(),
+      [&](size_t n) {
+        const int i = (*idxs)[n];
+        for (unsigned int f = 0; f < norms.size(); f++)
+          if (fabs(vdot(norms[f], verts[i]) - offsets[f]) < eps)
+            return;
+
+        // widen the search until no point beyond it could cut the cell
+        vector<int> nbrs;
+        double dist = 2.5 * grid.get_spacing();
+        while (true) {
+          dist = std::min(dist, all_dist);
+          grid.get_nearby(i, dist, nbrs);
+          double radius;
+          finite[i] = local_cell(verts, i, nbrs, all_cells[i], radius, eps);
+          if (dist >= all_dist || (finite[i] && 2 * radius <= dist))
+            break;
+          dist *= 2;
+        }
+      },
+      num_threads);
+
+  for (int i : *idxs)
+    if (finite[i])
+      cells->push_back(all_cells[i]);
+
+  return Status::ok();
+}
+
+} // namespace anti
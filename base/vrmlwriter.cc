@@ -50,6 +50,21 @@ string vrml_vec(double x, double y, double z, int sig_digits)
                    -sig_digits, z);
 }
 
+void vrml_vec(TextWriter &out, const Vec3d &v, int sig_digits)
+{
+  out.put_double(v[0], sig_digits).put(' ');
+  out.put_double(v[1], sig_digits).put(' ');
+  out.put_double(v[2], sig_digits);
+}
+
+void vrml_col(TextWriter &out, const Color &col)
+{
+  Vec4d cv = col.get_vec4d();
+  out.put_double(cv[0], -4).put(' ');
+  out.put_double(cv[1], -4).put(' ');
+  out.put_double(cv[2], -4);
+}
+
 string vrml_col(const Color &col)
 {
   Vec4d cv = col.get_vec4d();
@@ -30,6 +30,7 @@
 #define VRMLWRITER_H
 
 #include "scene.h"
+#include "textwriter.h"
 
 #include <cstdio>
 #include <string>
@@ -44,6 +45,10 @@ inline std::string vrml_vec(const Vec3d &v, int sig_digits = 10)
 }
 std::string vrml_col(const Color &col);
 
+// buffered output, with the same text as the conversion functions
+void vrml_vec(TextWriter &out, const Vec3d &v, int sig_digits = 10);
+void vrml_col(TextWriter &out, const Color &col);
+
 class VrmlWriter {
 private:
   void header(FILE *ofile);
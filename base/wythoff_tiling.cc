@@ -23,10 +23,14 @@
 */
 
 #include "geometryinfo.h"
+#include "parallel.h"
+#include "profile.h"
 #include "programopts.h"
 #include "tiling.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <map>
 #include <regex>
@@ -375,29 +379,43 @@ string TilingColoring::get_option_help(char op_char)
       op_char);
 }
 
+// Key for an edge, with the vertex-sorted index pair packed into an integer
+// so that keys sort in the same order as the pairs
+static uint64_t edge_key(int v0, int v1)
+{
+  if (v0 > v1)
+    std::swap(v0, v1);
+  return ((uint64_t)v0 << 32) | (uint32_t)v1;
+}
+
 bool Tiling::find_nbrs()
 {
-  auto ef_pairs = meta.get_edge_face_pairs(false);
+  // Side i of face f, opposite vertex i, keyed by its packed vertex pair.
+  // Sorting brings together the sides on each edge, in face order.
+  const int f_sz = meta.faces().size();
+  vector<pair<uint64_t, int>> sides;
+  sides.reserve(3 * f_sz);
+  for (int f = 0; f < f_sz; f++)
+    for (int i = 0; i < 3; i++)
+      sides.push_back({edge_key(meta.faces_mod(f, i + 1),
+                                meta.faces_mod(f, i + 2)),
+                       3 * f + i});
+  std::sort(sides.begin(), sides.end());
 
   // Find the neighbour face opposite each VEF vertex
-  nbrs.resize(meta.faces().size(), vector<int>(3));
-  for (unsigned int f = 0; f < meta.faces().size(); f++)
-    for (int i = 0; i < 3; i++) {
-      vector<int> e(2);
-      e[0] = meta.faces_mod(f, i + 1);
-      e[1] = meta.faces_mod(f, i + 2);
-      if (e[0] > e[1])
-        std::swap(e[0], e[1]);
-      auto ef_i = ef_pairs.find(e);
-      if (ef_i == ef_pairs.end())
-        return false;
-      else if (ef_i->second.size() != 2)
-        nbrs[f][i] = -1; // only allow connection for two faces at an edge
-      else {
-        nbrs[f][i] =
-            (ef_i->second[0] != (int)f) ? ef_i->second[0] : ef_i->second[1];
-      }
+  nbrs.assign(f_sz, vector<int>(3, -1));
+  for (unsigned int i = 0; i < sides.size();) {
+    unsigned int j = i + 1;
+    while (j < sides.size() && sides[j].first == sides[i].first)
+      j++;
+    if (j - i == 2) { // only allow connection for two faces at an edge
+      const int s0 = sides[i].second;
+      const int s1 = sides[i + 1].second;
+      nbrs[s0 / 3][s0 % 3] = s1 / 3;
+      nbrs[s1 / 3][s1 % 3] = s0 / 3;
     }
+    i = j;
+  }
   return true;
 }
 
@@ -448,63 +466,35 @@ int Tiling::get_associated_element(int start_idx, const string &step,
   return idx >= 0 ? meta.faces(idx, assoc_type) : idx;
 }
 
-// Each pattern point plotted for a meta triangle cooresponds to
-// a previously assigned geometry vertex. Get the index of that vertex.
-static int
-get_index(const vector<int> &face, int f_idx, int pat_pt_idx, int incl,
-          const std::vector<std::map<std::vector<int>, std::pair<int, int>>>
-              &index_order,
-          const std::vector<int> &point_vertex_offsets)
-{
-  vector<int> incl_key;
-  if (incl >= Tile::V && incl <= Tile::F) // meta tile vertex
-    incl_key = {face[incl]};
-  else if (incl >= Tile::VE && incl <= Tile::FV) // meta tile edge
-    incl_key = make_edge(face[incl % 3], face[(incl + 1) % 3]);
-  else if (incl == Tile::VEF) // meta tile interior
-    incl_key = {f_idx};
-  else
-    return -1; // invalid inclusion value, shouldn't happen
-
-  const auto it = index_order[incl].find(incl_key);
-  if (it == index_order[incl].end())
-    return -2; // invalid element key, shouldn't happen
-
-  return point_vertex_offsets[pat_pt_idx] + it->second.first;
-}
-
-void Tiling::add_circuit(
-    Geometry &geom, int start_idx, const Tile &pat, std::vector<bool> &seen,
-    Color col,
-    const std::vector<std::map<std::vector<int>, std::pair<int, int>>>
-        &index_order,
-    const std::vector<int> &point_vertex_offsets) const
+bool Tiling::trace_circuit(int start_idx, const Tile &pat,
+                           const std::vector<ElemIndex> &index_order,
+                           const std::vector<int> &point_vertex_offsets,
+                           std::vector<int> &face,
+                           std::vector<int> &starts) const
 {
   // Apply pattern until circuit completes
-  vector<int> face;
+  face.clear();
   int idx = start_idx;
-  while (true) {
-    seen[idx] = true;
+  do {
+    starts.push_back(idx);
     pat.start_op();
     while (pat.get_op() != Tile::END) {
       if (pat.get_op() == Tile::P) {
+        // Each pattern point plotted for a meta triangle cooresponds to
+        // a previously assigned geometry vertex. Get the index of that vertex.
         int incl = points[pat.get_idx()].get_inclusion();
-        int v_idx = get_index(meta.faces(idx), idx, pat.get_idx(), incl,
-                              index_order, point_vertex_offsets);
-        face.push_back(v_idx);
+        face.push_back(point_vertex_offsets[pat.get_idx()] +
+                       index_order[incl].order[idx]);
       }
       else {
         idx = nbrs[idx][pat.get_op()]; // move to next triangle
         if (idx < 0)
-          return; // abandon: circuit tried to cross an open edge
+          return false; // abandon: circuit tried to cross an open edge
       }
       pat.next_op();
     }
-    if (idx == start_idx) // circuit complete
-      break;
-  }
-
-  geom.add_face(face, col);
+  } while (idx != start_idx);
+  return true;
 }
 
 static void reverse_odd_faces(Geometry &geom)
@@ -611,45 +601,76 @@ bool valid_start_face(int f, int start_faces)
   return !((start_faces == '-' && pos_tri) || (start_faces == '+' && !pos_tri));
 }
 
-void store_tri(map<vector<int>, pair<int, int>> &elem_to_tri, vector<int> key,
-               int tri_idx)
+// Number the elements with keys elem_keys (one per meta face) in key order.
+// The example face is the last face with the element, or for VE elements
+// the first odd face, if any, otherwise the first face
+template <typename T>
+void number_elems(const vector<T> &elem_keys, bool first_odd,
+                  vector<int> &order, vector<int> &tris)
 {
-  auto pr = elem_to_tri.insert({key, {-1, tri_idx}});
-  if (pr.second == false && is_even(pr.first->second.second) &&
-      !is_even(tri_idx))
-    pr.first->second.second = tri_idx;
+  const int f_sz = elem_keys.size();
+  vector<pair<T, int>> keys(f_sz);
+  for (int i = 0; i < f_sz; i++)
+    keys[i] = {elem_keys[i], i};
+  std::sort(keys.begin(), keys.end());
+
+  order.resize(f_sz);
+  tris.clear();
+  for (int i = 0; i < f_sz;) {
+    int j = i + 1;
+    while (j < f_sz && keys[j].first == keys[i].first)
+      j++;
+    int tri = keys[j - 1].second;
+    if (first_odd) {
+      tri = keys[i].second;
+      for (int k = i; k < j; k++)
+        if (!is_even(keys[k].second)) {
+          tri = keys[k].second;
+          break;
+        }
+    }
+    for (int k = i; k < j; k++)
+      order[keys[k].second] = tris.size();
+    tris.push_back(tri);
+    i = j;
+  }
 }
 
 }; // namespace
 
 Status Tiling::make_tiling(Geometry &geom,
-                           vector<Tile::TileReport> *tile_reports) const
+                           vector<Tile::TileReport> *tile_reports,
+                           int num_threads) const
 {
+  ANTI_PROFILE_SCOPE("tiling");
   geom.clear_all();
   if (tile_reports)
     tile_reports->resize(pat_paths.size());
 
   // All the possible element inclusion postions V, E, F, VE, EF, FV, VEF.
-  // Each entry maps to order (to find index of corresponding point)
-  // and example triangle (to generate coordinates of corresponding point)
-  auto ef_pairs = meta.get_edge_face_pairs();
-  vector<map<vector<int>, pair<int, int>>> index_order(7);
-  for (int i = 0; i < (int)meta.faces().size(); i++) {
-    const auto &face = meta.faces(i);
-    index_order[Tile::VEF][{i}] = {-1, i};
-    index_order[Tile::V][{face[Tile::V]}] = {-1, i};
-    index_order[Tile::E][{face[Tile::E]}] = {-1, i};
-    index_order[Tile::F][{face[Tile::F]}] = {-1, i};
-    store_tri(index_order[Tile::VE], make_edge(face[Tile::V], face[Tile::E]),
-              i);
-    index_order[Tile::EF][make_edge(face[Tile::E], face[Tile::F])] = {-1, i};
-    index_order[Tile::FV][make_edge(face[Tile::F], face[Tile::V])] = {-1, i};
+  // For each, the order of the element of each meta face (to find index of
+  // corresponding point) and an example triangle for each element (to
+  // generate coordinates of corresponding point)
+  const int meta_f_sz = meta.faces().size();
+  vector<ElemIndex> index_order(7);
+  for (int incl = Tile::V; incl <= Tile::F; incl++) {
+    vector<int> keys(meta_f_sz);
+    for (int i = 0; i < meta_f_sz; i++)
+      keys[i] = meta.faces(i, incl);
+    number_elems(keys, false, index_order[incl].order, index_order[incl].tris);
   }
-  for (int i = (int)Tile::V; i <= (int)Tile::VEF; i++) {
-    int pos = 0;
-    for (auto &m : index_order[i])
-      m.second.first = pos++;
+  for (int incl = Tile::VE; incl <= Tile::FV; incl++) {
+    vector<uint64_t> keys(meta_f_sz);
+    for (int i = 0; i < meta_f_sz; i++)
+      keys[i] =
+          edge_key(meta.faces(i, incl % 3), meta.faces(i, (incl + 1) % 3));
+    number_elems(keys, (incl == Tile::VE), index_order[incl].order,
+                 index_order[incl].tris);
   }
+  index_order[Tile::VEF].order.resize(meta_f_sz);
+  for (int i = 0; i < meta_f_sz; i++)
+    index_order[Tile::VEF].order[i] = i;
+  index_order[Tile::VEF].tris = index_order[Tile::VEF].order;
 
   // Starting offset of vertices corresponding to each pattern point
   vector<int> point_vertex_offsets(points.size());
@@ -659,13 +680,19 @@ Status Tiling::make_tiling(Geometry &geom,
     int incl = pt.get_inclusion();
     Vec3d crds = pt.get_coords();
     crds /= crds[0] + crds[1] + crds[2];
-    for (auto &m : index_order[incl]) {
-      const int f_idx = m.second.second;
-      Color col = coloring.get_point_color(pt);
-      if (coloring.is_associated_element(TilingColoring::POINTS))
-        col = get_associated_element_point_color(f_idx, incl);
-      geom.add_vert(point_on_face(meta, f_idx, crds), col);
-    }
+    const vector<int> &tris = index_order[incl].tris;
+    vector<Vec3d> verts(tris.size());
+    vector<Color> cols(tris.size(), coloring.get_point_color(pt));
+    parallel_for(
+        tris.size(),
+        [&](size_t j) {
+          verts[j] = point_on_face(meta, tris[j], crds);
+          if (coloring.is_associated_element(TilingColoring::POINTS))
+            cols[j] = get_associated_element_point_color(tris[j], incl);
+        },
+        num_threads);
+    for (unsigned int j = 0; j < tris.size(); j++)
+      geom.add_vert(verts[j], cols[j]);
   }
 
   int faces_sz = meta.faces().size();
@@ -682,30 +709,94 @@ Status Tiling::make_tiling(Geometry &geom,
     }
 
     auto assoc = pat.get_element_association();
-    vector<bool> seen(faces_sz, false);
-    int start_faces_sz = geom.faces().size();
+    auto circuit_color = [&](int i) {
+      Color col; // col_type==ColoringType::none
+      if (coloring.is_index(TilingColoring::TILES))
+        col.set_index(p_idx);
+      else if (coloring.is_associated_element(TilingColoring::TILES)) {
+        auto type = (assoc.assoc_type == Tile::P)
+                        ? coloring.get_local_association(TilingColoring::TILES)
+                        : assoc.assoc_type;
+        if (type == Tile::P)
+          col = coloring.get_local_color(TilingColoring::TILES);
+        else {
+          int col_idx = get_associated_element(i, assoc.step, type);
+          if (col_idx >= 0)
+            col = orig_colors.get(col_idx);
+        }
+      }
+      return col;
+    };
+
     unsigned char start_faces = pat.get_start_faces();
-    for (int i = 0; i < faces_sz; i++) {
-      if (!seen[i] && valid_start_face(i, start_faces)) {
-        Color col; // col_type==ColoringType::none
-        if (coloring.is_index(TilingColoring::TILES))
-          col.set_index(p_idx);
-        else if (coloring.is_associated_element(TilingColoring::TILES)) {
-          auto type =
-              (assoc.assoc_type == Tile::P)
-                  ? coloring.get_local_association(TilingColoring::TILES)
-                  : assoc.assoc_type;
-          if (type == Tile::P)
-            col = coloring.get_local_color(TilingColoring::TILES);
-          else {
-            int col_idx = get_associated_element(i, assoc.step, type);
-            if (col_idx >= 0)
-              col = orig_colors.get(col_idx);
+    int first = 0;
+    int last = faces_sz;
+    if (one_of_each_tile) {
+      while (first < faces_sz && !valid_start_face(first, start_faces))
+        first++;
+      last = std::min(first + 1, faces_sz);
+    }
+
+    // Trace the circuits from the start triangles of each block in
+    // parallel, skipping triangles already seen in the block. Then claim
+    // the circuits in start order, skipping those that start on a triangle
+    // seen by an earlier claimed circuit. A triangle seen by a circuit is
+    // also seen by the circuits that reach it, so the claimed circuits are
+    // those found by tracing from each triangle in order.
+    struct Trace {
+      int start;
+      bool complete;
+      size_t starts_end; // end of the start triangles in the block list
+      vector<int> face;
+    };
+    struct BlockTraces {
+      vector<Trace> traces;
+      vector<int> starts; // start triangles of each pattern application
+    };
+    // A circuit that passes through several blocks is traced in each of
+    // them, so use one block for each thread
+    const size_t num_blocks =
+        std::min((size_t)(last - first),
+                 (size_t)((num_threads > 0) ? num_threads : get_max_threads()));
+    vector<BlockTraces> blocks(num_blocks);
+    parallel_for_blocks(
+        last - first, num_blocks,
+        [&](size_t b, size_t begin, size_t end) {
+          Tile pat_copy = pat; // the pattern keeps its own reading position
+          vector<bool> block_seen(faces_sz, false);
+          BlockTraces &blk = blocks[b];
+          for (size_t n = begin; n < end; n++) {
+            const int i = first + n;
+            if (block_seen[i] || !valid_start_face(i, start_faces))
+              continue;
+            Trace trace;
+            trace.start = i;
+            const size_t starts_begin = blk.starts.size();
+            trace.complete = trace_circuit(i, pat_copy, index_order,
+                                           point_vertex_offsets, trace.face,
+                                           blk.starts);
+            if (!trace.complete)
+              trace.face.clear();
+            trace.starts_end = blk.starts.size();
+            for (size_t k = starts_begin; k < trace.starts_end; k++)
+              block_seen[blk.starts[k]] = true;
+            blk.traces.push_back(std::move(trace));
           }
+        },
+        num_threads);
+
+    int start_faces_sz = geom.faces().size();
+    vector<bool> seen(faces_sz, false);
+    for (const auto &blk : blocks) {
+      size_t starts_begin = 0;
+      for (const auto &trace : blk.traces) {
+        if (!seen[trace.start]) {
+          for (size_t k = starts_begin; k < trace.starts_end; k++)
+            seen[blk.starts[k]] = true;
+          if (trace.complete)
+            geom.add_face(trace.face, circuit_color(trace.start));
         }
-        add_circuit(geom, i, pat, seen, col, index_order, point_vertex_offsets);
-        if (one_of_each_tile)
-          break;
+        starts_begin = trace.starts_end;
       }
     }
     if (tile_reports) {
@@ -0,0 +1,625 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: antiprism_bench.cc
+   Description: time core library operations on a standard model corpus
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+#include "../base/antiprism.h"
+#include "../config.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+using namespace anti;
+
+namespace {
+
+// Library operations, in the order they are run
+const char *lib_ops[] = {"off_write",   "off_read",   "merge",
+                         "symmetry",    "info",       "dual",
+                         "triangulate", "sym_repeat", "sym_repeat_merged",
+                         "wythoff",     "planar",     "canonical",
+                         "corpus"};
+
+// Program operations, run when a program directory is given
+const char *prog_ops[] = {"off_color_radial", "poly_kscope", "n_icons",
+                          "off2png",          "poly_form",   "canonical_prog"};
+
+const int max_levels = 5;
+
+// Wythoff patterns, as Conway operators with tiles of different kinds:
+// truncate, snub, meta, gyro and whirl
+const char *wythoff_pats[] = {"t", "s", "m", "g", "w"};
+
+} // namespace
+
+class bench_opts : public ProgramOpts {
+public:
+  int levels = 3;
+  int repeats = 3;
+  int solver_iters = 200;
+  set<string> ops;
+  string prog_dir;
+  string cmp_file;
+  string ofile;
+
+  bench_opts() : ProgramOpts("antiprism_bench") {}
+
+  void process_command_line(int argc, char **argv);
+  void usage();
+
+  bool use_op(const string &op) const { return ops.empty() || ops.count(op); }
+};
+
+void bench_opts::usage()
+{
+  fprintf(stdout, R"(
+Usage: %s [options]
+
+Time core library operations on a corpus of models generated from the
+built-in resources, and write the timings as JSON. The corpus has
+geodesic spheres and a grid of separate cubes at increasing sizes, a
+geodesic sphere with 100820 faces for the Wythoff tilings, and all the
+uniform and Johnson polyhedra. Each timing is the minimum over
+the repeats. Progress is written to standard error.
+
+Options
+%s
+  -l <num>  number of model sizes, 1 to %d, a geodesic frequency of
+            5, 10, 20, 40, 80 for each size (default: %d)
+  -r <num>  number of times to repeat each timing (default: %d)
+  -n <itrs> number of iterations for the solvers (default: %d)
+  -t <ops>  operations to time, a comma separated list from
+            library: off_write, off_read, merge, symmetry, info, dual,
+               triangulate, sym_repeat, sym_repeat_merged, wythoff,
+               planar, canonical, corpus
+            programs: off_color_radial, poly_kscope, n_icons, off2png,
+               poly_form, canonical_prog
+            (default: all)
+  -T <dir>  also time the programs in dir (usually the src directory of
+            the build), work files are written to the current directory
+  -c <file> compare timings with a previous JSON output file, writing
+            the ratios (old time / new time) to standard error
+  -o <file> write JSON output to file (default: write to standard output)
+
+)",
+          prog_name(), help_ver_text, max_levels, levels, repeats,
+          solver_iters);
+}
+
+void bench_opts::process_command_line(int argc, char **argv)
+{
+  opterr = 0;
+  int c;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv, ":hl:r:n:t:T:c:o:")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'l':
+      print_status_or_exit(read_int(optarg, &levels), c);
+      if (levels < 1 || levels > max_levels)
+        error(msg_str("number of sizes must be between 1 and %d", max_levels),
+              c);
+      break;
+
+    case 'r':
+      print_status_or_exit(read_int(optarg, &repeats), c);
+      if (repeats < 1)
+        error("number of repeats must be 1 or more", c);
+      break;
+
+    case 'n':
+      print_status_or_exit(read_int(optarg, &solver_iters), c);
+      if (solver_iters < 1)
+        error("number of iterations must be 1 or more", c);
+      break;
+
+    case 't': {
+      set<string> known(std::begin(lib_ops), std::end(lib_ops));
+      known.insert(std::begin(prog_ops), std::end(prog_ops));
+      Split parts(optarg, ",");
+      for (size_t i = 0; i < parts.size(); i++) {
+        if (!known.count(parts[i]))
+          error(msg_str("unknown operation '%s'", parts[i]), c);
+        ops.insert(parts[i]);
+      }
+      break;
+    }
+
+    case 'T':
+      prog_dir = optarg;
+      break;
+
+    case 'c':
+      cmp_file = optarg;
+      break;
+
+    case 'o':
+      ofile = optarg;
+      break;
+
+    default:
+      error("unknown command line error");
+    }
+  }
+
+  if (argc - optind > 0)
+    error("too many arguments");
+}
+
+namespace {
+
+struct BenchResult {
+  string op;
+  string model;
+  int verts;
+  int faces;
+  double secs;
+  int reps;
+};
+
+/// Times operations and collects the results
+class Bench {
+private:
+  const bench_opts &opts;
+  vector<BenchResult> results;
+
+public:
+  Bench(const bench_opts &opts) : opts(opts) {}
+
+  /// Time an operation
+  /**\param op operation name.
+   * \param model model name.
+   * \param geom model, for the element counts.
+   * \param run the operation to time.
+   * \param setup untimed preparation before each run, or \c nullptr. */
+  void time(const string &op, const string &model, const Geometry &geom,
+            const std::function<void()> &run,
+            const std::function<void()> &setup = nullptr);
+
+  /// Time a program run
+  /**\param op operation name.
+   * \param model model name.
+   * \param geom model, for the element counts.
+   * \param prog program name.
+   * \param args program arguments.
+   * \return \c true if the program ran successfully. */
+  bool time_prog(const string &op, const string &model, const Geometry &geom,
+                 const string &prog, const string &args);
+
+  /// Write the results as JSON
+  /**\param ofile output file name, or "" for standard output.
+   * \return status, which evaluates to \c true if the file was written. */
+  Status write_json(const string &ofile) const;
+
+  /// Compare the results with a previous JSON output
+  /**\param cmp_file file name of the previous output.
+   * \return status, which evaluates to \c true if the file was read. */
+  Status compare(const string &cmp_file) const;
+};
+
+double elapsed_secs(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Bench::time(const string &op, const string &model, const Geometry &geom,
+                 const std::function<void()> &run,
+                 const std::function<void()> &setup)
+{
+  double min_secs = -1;
+  for (int i = 0; i < opts.repeats; i++) {
+    if (setup)
+      setup();
+    auto start = std::chrono::steady_clock::now();
+    run();
+    double secs = elapsed_secs(start);
+    if (min_secs < 0 || secs < min_secs)
+      min_secs = secs;
+  }
+  results.push_back({op, model, (int)geom.verts().size(),
+                     (int)geom.faces().size(), min_secs, opts.repeats});
+  fprintf(stderr, "%-18s %-28s %10.6f s\n", op.c_str(), model.c_str(),
+          min_secs);
+}
+
+bool Bench::time_prog(const string &op, const string &model,
+                      const Geometry &geom, const string &prog,
+                      const string &args)
+{
+  string cmd = opts.prog_dir + "/" + prog + " " + args + " > /dev/null 2>&1";
+  bool ok = true;
+  time(op, model, geom, [&]() {
+    if (ok && system(cmd.c_str()) != 0)
+      ok = false;
+  });
+  if (!ok) {
+    results.pop_back();
+    opts.warning(msg_str("command failed, timing not recorded: %s",
+                         cmd.c_str()));
+  }
+  return ok;
+}
+
+Status Bench::write_json(const string &ofile) const
+{
+  FILE *ofp = stdout;
+  if (ofile != "") {
+    ofp = fopen(ofile.c_str(), "w");
+    if (!ofp)
+      return Status::error(msg_str("could not open output file '%s': %s",
+                                   ofile.c_str(), strerror(errno)));
+  }
+
+  fprintf(ofp, "{\n");
+  fprintf(ofp, "  \"version\": \"%s\",\n", VERSION);
+  fprintf(ofp, "  \"levels\": %d,\n", opts.levels);
+  fprintf(ofp, "  \"repeats\": %d,\n", opts.repeats);
+  fprintf(ofp, "  \"solver_iters\": %d,\n", opts.solver_iters);
+  fprintf(ofp, "  \"results\": [\n");
+  // one result per line, so the file can be compared with line tools
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto &res = results[i];
+    fprintf(ofp,
+            "    {\"op\": \"%s\", \"model\": \"%s\", \"verts\": %d, "
+            "\"faces\": %d, \"secs\": %.6g, \"reps\": %d}%s\n",
+            res.op.c_str(), res.model.c_str(), res.verts, res.faces,
+            res.secs, res.reps, (i < results.size() - 1) ? "," : "");
+  }
+  fprintf(ofp, "  ]\n");
+  fprintf(ofp, "}\n");
+
+  if (ofile != "")
+    fclose(ofp);
+
+  return Status::ok();
+}
+
+Status Bench::compare(const string &cmp_file) const
+{
+  FILE *ifp = fopen(cmp_file.c_str(), "r");
+  if (!ifp)
+    return Status::error(msg_str("could not open comparison file '%s': %s",
+                                 cmp_file.c_str(), strerror(errno)));
+
+  map<std::pair<string, string>, double> old_secs;
+  char *line = nullptr;
+  while (read_line(ifp, &line) == 0) {
+    char op[128], model[128];
+    int verts, faces;
+    double secs;
+    if (sscanf(line,
+               " {\"op\": \"%127[^\"]\", \"model\": \"%127[^\"]\", "
+               "\"verts\": %d, \"faces\": %d, \"secs\": %lf",
+               op, model, &verts, &faces, &secs) == 5)
+      old_secs[{op, model}] = secs;
+    free(line);
+  }
+  fclose(ifp);
+
+  fprintf(stderr, "\ncomparison with %s (old / new)\n", cmp_file.c_str());
+  for (const auto &res : results) {
+    auto it = old_secs.find({res.op, res.model});
+    if (it == old_secs.end())
+      fprintf(stderr, "%-18s %-28s %10s\n", res.op.c_str(), res.model.c_str(),
+              "-");
+    else
+      fprintf(stderr, "%-18s %-28s %10.2f\n", res.op.c_str(),
+              res.model.c_str(), it->second / res.secs);
+  }
+
+  return Status::ok();
+}
+
+// A grid of separate cubes, with coincident vertices, edges and faces
+// where neighbouring cubes meet
+void make_cube_grid(Geometry &geom, int n)
+{
+  geom.clear_all();
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      for (int k = 0; k < n; k++) {
+        int v0 = geom.verts().size();
+        for (int v = 0; v < 8; v++)
+          geom.add_vert(Vec3d(i + (v & 1), j + ((v >> 1) & 1), k + (v >> 2)));
+        const int cube[][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+                               {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+        for (const auto &f : cube)
+          geom.add_face({v0 + f[0], v0 + f[1], v0 + f[2], v0 + f[3]});
+      }
+}
+
+// A Goldberg polyhedron with the vertices moved off the face planes,
+// as a start model for the solvers
+void make_unplanar(Geometry &geom, const Geometry &geod)
+{
+  get_dual(geom, geod, 1);
+  Random rnd(1);
+  for (auto &v : geom.raw_verts())
+    v += Vec3d::random(rnd) * (0.2 / sqrt(geod.faces().size()));
+}
+
+// Remove a work file when going out of scope
+class WorkFile {
+private:
+  string fname;
+
+public:
+  WorkFile(const string &name) : fname("bench_tmp_" + name) {}
+  ~WorkFile() { remove(fname.c_str()); }
+  const string &name() const { return fname; }
+};
+
+void bench_library(Bench &bench, const bench_opts &opts)
+{
+  for (int lev = 0; lev < opts.levels; lev++) {
+    const int freq = 5 << lev;
+    const string geo_name = msg_str("geo_i_%d", freq);
+    Geometry geod;
+    opts.print_status_or_exit(geod.read_resource(geo_name));
+
+    WorkFile wfile("io.off");
+    if (opts.use_op("off_write"))
+      bench.time("off_write", geo_name, geod,
+                 [&]() { geod.write(wfile.name()); });
+
+    if (opts.use_op("off_read")) {
+      opts.print_status_or_exit(geod.write(wfile.name()));
+      Geometry geom;
+      bench.time("off_read", geo_name, geod,
+                 [&]() { geom.read(wfile.name()); });
+    }
+
+    if (opts.use_op("merge")) {
+      const int cubes = 4 + 6 * lev;
+      const string grid_name = msg_str("cube_grid_%d", cubes);
+      Geometry grid, geom;
+      make_cube_grid(grid, cubes);
+      bench.time("merge", grid_name, grid,
+                 [&]() { merge_coincident_elements(geom, "vef"); },
+                 [&]() { geom = grid; });
+    }
+
+    if (opts.use_op("symmetry"))
+      bench.time("symmetry", geo_name, geod, [&]() { Symmetry sym(geod); });
+
+    if (opts.use_op("info"))
+      bench.time("info", geo_name, geod, [&]() {
+        GeometryInfo info(geod);
+        info.volume();
+        info.face_areas();
+        info.iedge_length_lims();
+        info.get_vert_cons();
+        info.get_edge_dihedrals();
+      });
+
+    Geometry gold;
+    get_dual(gold, geod, 1);
+    const string gold_name = msg_str("gold_%d", freq);
+    if (opts.use_op("dual")) {
+      Geometry dual;
+      bench.time("dual", geo_name, geod, [&]() { get_dual(dual, geod, 1); });
+      // explicit edges are also converted to dual edges
+      Geometry geod_e = geod;
+      geod_e.add_missing_impl_edges();
+      bench.time("dual", geo_name + "_e", geod_e,
+                 [&]() { get_dual(dual, geod_e, 1); });
+    }
+
+    if (opts.use_op("triangulate")) {
+      Geometry geom;
+      bench.time("triangulate", gold_name, gold, [&]() { geom.triangulate(); },
+                 [&]() { geom = gold; });
+    }
+
+    if (opts.use_op("sym_repeat") || opts.use_op("sym_repeat_merged")) {
+      // the geodesic sphere is invariant under T, so the merged copies
+      // give back the sphere
+      Symmetry sym("T");
+      Transformations ts = sym.get_trans();
+      Geometry geom;
+      if (opts.use_op("sym_repeat"))
+        bench.time("sym_repeat", geo_name + "_T", geod,
+                   [&]() { sym_repeat(geom, geod, ts); });
+      if (opts.use_op("sym_repeat_merged"))
+        bench.time("sym_repeat_merged", geo_name + "_T", geod,
+                   [&]() { sym_repeat_merged(geom, geod, ts, ts); });
+    }
+
+    if (opts.use_op("wythoff")) {
+      Geometry geom;
+      for (const char *pat : wythoff_pats)
+        bench.time("wythoff", geo_name + "_" + pat, geod,
+                   [&]() { wythoff_make_tiling(geom, geod, pat); });
+    }
+
+    if (opts.use_op("planar") || opts.use_op("canonical")) {
+      Geometry start, geom;
+      make_unplanar(start, geod);
+      const string start_name = msg_str("gold_%d_jitter", freq);
+      IterationControl it_ctrl;
+      it_ctrl.set_max_iters(opts.solver_iters);
+      it_ctrl.set_sig_digits(DEF_SIG_DGTS); // run all the iterations
+      it_ctrl.set_stream(nullptr);
+      Symmetry sym; // no symmetry, the start model has none
+      if (opts.use_op("planar"))
+        bench.time("planar", start_name, start,
+                   [&]() { make_planar(geom, it_ctrl, 0.2, sym); },
+                   [&]() { geom = start; });
+      if (opts.use_op("canonical"))
+        bench.time(
+            "canonical", start_name, start,
+            [&]() { make_canonical(geom, it_ctrl, 0.01, 0.5, 'c', sym); },
+            [&]() { geom = start; });
+    }
+  }
+
+  if (opts.use_op("wythoff")) {
+    // a large base, whatever the number of sizes, as tiling is per face
+    const int freq = 71; // 100820 faces
+    const string geo_name = msg_str("geo_i_%d", freq);
+    Geometry geod, geom;
+    opts.print_status_or_exit(geod.read_resource(geo_name));
+    for (const char *pat : {"t", "s"})
+      bench.time("wythoff", geo_name + "_" + pat, geod,
+                 [&]() { wythoff_make_tiling(geom, geod, pat); });
+  }
+
+  if (opts.use_op("corpus")) {
+    // all the uniform and Johnson polyhedra, timed as a set
+    const vector<std::pair<string, int>> sets = {{"u", 80}, {"j", 92}};
+    for (const auto &set_info : sets) {
+      vector<Geometry> polys(set_info.second);
+      Geometry all; // for the element counts
+      for (int i = 0; i < set_info.second; i++) {
+        opts.print_status_or_exit(
+            polys[i].read_resource(msg_str("%s%d", set_info.first.c_str(),
+                                           i + 1)));
+        all.append(polys[i]);
+      }
+      const string set_name = (set_info.first == "u") ? "uniform" : "johnson";
+      bench.time("corpus", set_name, all, [&]() {
+        Geometry dual;
+        for (const auto &poly : polys) {
+          Symmetry sym(poly);
+          GeometryInfo info(poly);
+          info.volume();
+          info.iedge_length_lims();
+          get_dual(dual, poly, 1);
+        }
+      });
+    }
+  }
+}
+
+void bench_programs(Bench &bench, const bench_opts &opts)
+{
+  for (int lev = 0; lev < opts.levels; lev++) {
+    const int freq = 5 << lev;
+    const string geo_name = msg_str("geo_i_%d", freq);
+    Geometry geod;
+    opts.print_status_or_exit(geod.read_resource(geo_name));
+    WorkFile geo_file(geo_name + ".off");
+    opts.print_status_or_exit(geod.write(geo_file.name()));
+
+    if (opts.use_op("off_color_radial")) {
+      bench.time_prog("off_color_radial", geo_name, geod, "off_color_radial",
+                      "-f v0 " + geo_file.name());
+      Geometry gold;
+      get_dual(gold, geod, 1);
+      WorkFile gold_file(geo_name + "_gold.off");
+      opts.print_status_or_exit(gold.write(gold_file.name()));
+      bench.time_prog("off_color_radial", msg_str("gold_%d", freq), gold,
+                      "off_color_radial", "-f v0 " + gold_file.name());
+    }
+
+    if (opts.use_op("poly_kscope"))
+      bench.time_prog("poly_kscope", geo_name + "_Oh", geod, "poly_kscope",
+                      "-s Oh -I -M " + geo_file.name());
+
+    if (opts.use_op("poly_form") || opts.use_op("canonical_prog")) {
+      Geometry start;
+      make_unplanar(start, geod);
+      const string start_name = msg_str("gold_%d_jitter", freq);
+      WorkFile start_file(start_name + ".off");
+      opts.print_status_or_exit(start.write(start_file.name()));
+      const string iter_args =
+          msg_str("-n %d -l %d -z 0 ", opts.solver_iters, DEF_SIG_DGTS);
+      if (opts.use_op("poly_form")) {
+        bench.time_prog("poly_form", start_name + "_e", start, "poly_form",
+                        "-a e " + iter_args + start_file.name());
+        bench.time_prog("poly_form", start_name + "_p", start, "poly_form",
+                        "-a p " + iter_args + start_file.name());
+      }
+      if (opts.use_op("canonical_prog"))
+        bench.time_prog("canonical_prog", start_name, start, "canonical",
+                        iter_args + start_file.name());
+    }
+  }
+
+  if (opts.use_op("n_icons")) {
+    // fixed size cases, from the n_icons list and colouring speed-ups
+    const char *cases[] = {"-n 400 -t 7 -F l -E l",
+                           "-n 200 -t 3 -M 400 -F m -E m",
+                           "-n 50/7 -t 2 -M 100 -F f",
+                           "-n 40 -t 3 -M 200 -F l -E l"};
+    Geometry no_geom;
+    for (const auto &args : cases)
+      bench.time_prog("n_icons", args, no_geom, "n_icons", args);
+  }
+
+  if (opts.use_op("off2png")) {
+    // u29, the snub dodecahedron, has 92 faces
+    Geometry poly;
+    opts.print_status_or_exit(poly.read_resource("u29"));
+    WorkFile poly_file("u29.off");
+    opts.print_status_or_exit(poly.write(poly_file.name()));
+    WorkFile png_file("u29.png");
+    for (const char *size : {"200", "1000"})
+      bench.time_prog("off2png", msg_str("u29_%s", size), poly, "off2png",
+                      msg_str("-z %s -o %s %s", size, png_file.name().c_str(),
+                              poly_file.name().c_str()));
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  bench_opts opts;
+  opts.process_command_line(argc, argv);
+
+  Bench bench(opts);
+  bench_library(bench, opts);
+  if (opts.prog_dir != "")
+    bench_programs(bench, opts);
+
+  opts.print_status_or_exit(bench.write_json(opts.ofile));
+  if (opts.cmp_file != "")
+    opts.print_status_or_exit(bench.compare(opts.cmp_file));
+
+  return 0;
+}
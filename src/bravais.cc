@@ -102,6 +102,7 @@ public:
   bool append_container = false;       // append cage of -k container
   bool voronoi_cells = false;          // calculate voronoi cells
   bool voronoi_central_cell = false;   // include voronoi cells only at center
+  bool voronoi_local_cells = false;    // calculate voronoi cells locally
   char auto_grid_type = '\0';          // p,f,i,e or 8 for automatic grid size
   bool grid_for_radius = false;        // for automatic grid size
   bool convex_hull = false;            // convex hull for waterman polyhedra
@@ -280,6 +281,7 @@ Lattice Options
               use multiple -s parameters for multiple struts
   -D <opt>  Voronoi (a.k.a Dirichlet) cells (Brillouin zones for duals)
               c - cells only, i - cell(s) touching center only
+              follow with l to calculate each cell locally, in parallel
   -A        append the original lattice to the final product
 
 Container Options
@@ -530,11 +532,16 @@ void brav_opts::process_command_line(int argc, char **argv)
       break;
 
     case 'D':
-      if (strlen(optarg) > 1 || !strchr("ci", *optarg))
-        error("Voronoi cells arg is '" + string(optarg) + "' must be c, i", c);
+      if (!strchr("ci", *optarg) ||
+          (strlen(optarg) > 1 && strcmp(optarg + 1, "l")))
+        error("Voronoi cells arg is '" + string(optarg) +
+                  "' must be c, i, optionally followed by l",
+              c);
       voronoi_cells = true;
       if (strchr("i", *optarg))
         voronoi_central_cell = true;
+      if (strlen(optarg) > 1)
+        voronoi_local_cells = true;
       break;
 
     case 'C':
@@ -1842,7 +1849,7 @@ void do_bravais(Geometry &geom, Geometry &container, brav_opts &opts)
   if (opts.voronoi_cells) {
     Geometry vgeom;
     if (get_voronoi_geom(geom, vgeom, opts.voronoi_central_cell, false,
-                         opts.eps)) {
+                         opts.eps, opts.voronoi_local_cells)) {
       Coloring(&vgeom).vef_one_col(opts.vert_col[2], opts.edge_col[2],
                                    opts.face_col[2]);
       geom = vgeom;
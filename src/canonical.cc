@@ -36,6 +36,7 @@
 #include "canonical_common.h"
 #include "color_common.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <string>
 #include <vector>
@@ -428,6 +429,10 @@ Options
   -l <lim>  minimum distance change to terminate, as negative exponent
                (default: %d giving %.0e)
             WARNING: high values can cause non-terminal behaviour. Use -n
+  -R <file> write progress records to file on status reports, as CSV if
+            the name ends in .csv, otherwise as JSON lines
+  -K <file> write a checkpoint to file on status reports, to resume from
+  -U <file> resume from a checkpoint file, using the same input and options
   -o <file> write output to file (default: write to standard output)
 
 Canonical and Planarization Options
@@ -541,9 +546,9 @@ void cn_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv,
-                     ":hHe:s:t:p:i:c:n:yO:q:g:Q:P:f:Cd:Yz:V:E:F:m:l:o:")) !=
-         -1) {
+  const char *opt_str =
+      ":hHe:s:t:p:i:c:n:yO:q:g:Q:P:f:Cd:Yz:V:E:F:m:l:R:K:U:o:";
+  while ((c = getopt(argc, argv, opt_str)) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -702,6 +707,18 @@ void cn_opts::process_command_line(int argc, char **argv)
       print_status_or_exit(it_ctrl.set_sig_digits(num), c);
       break;
 
+    case 'R':
+      print_status_or_exit(it_ctrl.set_record_file(optarg), c);
+      break;
+
+    case 'K':
+      print_status_or_exit(it_ctrl.set_checkpoint_file(optarg), c);
+      break;
+
+    case 'U':
+      print_status_or_exit(it_ctrl.set_resume_file(optarg), c);
+      break;
+
     case 'o':
       ofile = optarg;
       break;
@@ -752,6 +769,12 @@ void cn_opts::process_command_line(int argc, char **argv)
       (radius_range_percent > -1))
     warning("set, but not used for planarization", 'd');
 
+  if (!it_ctrl.get_checkpoint_file().empty() &&
+      it_ctrl.get_status_check_and_report_iters() <= 0)
+    warning("checkpoints are only written on status reports, which are "
+            "turned off by -z",
+            'K');
+
   if (use_symmetry) {
     if (planarize_method && planarize_method != 'p')
       warning("set, but not used for this planarize algorithm", 'y');
@@ -1725,6 +1748,16 @@ void shuffle_model_indexes(Geometry &geom, const cn_opts &opts)
   }
 }
 
+// Greatest squared distance between corresponding vertices
+double max_vert_diff2(const vector<Vec3d> &verts,
+                      const vector<Vec3d> &verts_last)
+{
+  return parallel_reduce<double>(
+      verts.size(), 0.0,
+      [&](size_t i) { return (verts[i] - verts_last[i]).len2(); },
+      [](const double &a, const double &b) { return std::max(a, b); });
+}
+
 // Implementation of George Hart's canonicalization algorithm
 // http://library.wolfram.com/infocenter/Articles/2012/
 // RK - the model will possibly become non-convex early in the loops.
@@ -1735,6 +1768,7 @@ bool canonicalize_mm(Geometry &geom, IterationControl it_ctrl,
                      const double radius_range_percent,
                      const bool planarize_only)
 {
+  ANTI_PROFILE_SCOPE("solve: canonical mm");
   bool completed = false;
   it_ctrl.set_finished(false);
 
@@ -1746,6 +1780,10 @@ bool canonicalize_mm(Geometry &geom, IterationControl it_ctrl,
   double test_val = it_ctrl.get_test_val();
   double max_diff2 = 0;
 
+  // a checkpoint that does not match is reported by the caller
+  if (it_ctrl.resume(verts).is_error())
+    return false;
+
   for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
     vector<Vec3d> verts_last = verts;
 
@@ -1795,12 +1833,7 @@ bool canonicalize_mm(Geometry &geom, IterationControl it_ctrl,
     string finish_msg;
     if (it_ctrl.is_status_check_iter()) {
       // len2() for difference value to minimize internal sqrt() calls
-      max_diff2 = 0;
-      for (unsigned int i = 0; i < verts.size(); i++) {
-        double diff2 = (verts[i] - verts_last[i]).len2();
-        if (diff2 > max_diff2)
-          max_diff2 = diff2;
-      }
+      max_diff2 = max_vert_diff2(verts, verts_last);
 
       if (sqrt(max_diff2) < test_val) {
         completed = true;
@@ -1823,6 +1856,7 @@ bool canonicalize_mm(Geometry &geom, IterationControl it_ctrl,
           it_ctrl.set_finished();
         finish_msg = "breaking out: radius range detected. try increasing -d";
       }
+      it_ctrl.record(sqrt(max_diff2), {}, finish_msg);
     }
 
     if (it_ctrl.is_status_report_iter()) {
@@ -1832,6 +1866,9 @@ bool canonicalize_mm(Geometry &geom, IterationControl it_ctrl,
       it_ctrl.print("%-12u max_diff:%17.15e\n", it_ctrl.get_current_iter(),
                     sqrt(max_diff2));
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      it_ctrl.checkpoint(verts);
   }
 
   return completed;
@@ -1854,6 +1891,7 @@ bool canonicalize_unit(Geometry &geom, IterationControl it_ctrl,
                        const double radius_range_percent,
                        const bool planarize_only)
 {
+  ANTI_PROFILE_SCOPE("solve: canonical unit");
   bool completed = false;
   it_ctrl.set_finished(false);
 
@@ -1865,6 +1903,10 @@ bool canonicalize_unit(Geometry &geom, IterationControl it_ctrl,
   double test_val = it_ctrl.get_test_val();
   double max_diff2 = 0;
 
+  // a checkpoint that does not match is reported by the caller
+  if (it_ctrl.resume(verts).is_error())
+    return false;
+
   for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
     vector<Vec3d> verts_last = verts;
 
@@ -1916,12 +1958,7 @@ bool canonicalize_unit(Geometry &geom, IterationControl it_ctrl,
     string finish_msg;
     if (it_ctrl.is_status_check_iter()) {
       // len2() for difference value to minimize internal sqrt() calls
-      max_diff2 = 0;
-      for (unsigned int i = 0; i < verts.size(); i++) {
-        double diff2 = (verts[i] - verts_last[i]).len2();
-        if (diff2 > max_diff2)
-          max_diff2 = diff2;
-      }
+      max_diff2 = max_vert_diff2(verts, verts_last);
 
       if (sqrt(max_diff2) < test_val) {
         completed = true;
@@ -1944,6 +1981,7 @@ bool canonicalize_unit(Geometry &geom, IterationControl it_ctrl,
           it_ctrl.set_finished();
         finish_msg = "breaking out: radius range detected. try increasing -d";
       }
+      it_ctrl.record(sqrt(max_diff2), {}, finish_msg);
     }
 
     if (it_ctrl.is_status_report_iter()) {
@@ -1953,6 +1991,9 @@ bool canonicalize_unit(Geometry &geom, IterationControl it_ctrl,
       it_ctrl.print("%-12u max_diff:%17.15e\n", it_ctrl.get_current_iter(),
                     sqrt(max_diff2));
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      it_ctrl.checkpoint(verts);
   }
 
   return completed;
@@ -1962,6 +2003,7 @@ bool canonicalize_unit(Geometry &geom, IterationControl it_ctrl,
 // meant to be called with finite num_iters (not -1)
 bool planarize_unit(Geometry &geom, IterationControl it_ctrl)
 {
+  ANTI_PROFILE_SCOPE("solve: planarize unit");
   double radius_range_percent = 0;
   bool planarize_only = true;
   return canonicalize_unit(geom, it_ctrl, radius_range_percent, planarize_only);
@@ -2018,6 +2060,19 @@ int main(int argc, char *argv[])
     base = get_dual(base);
   }
 
+  // a checkpoint is only resumed by the same stage and method, check that
+  // it will be resumed before running any stage
+  string planarize_stage = msg_str("planarize -p %c", opts.planarize_method);
+  string canonical_stage = msg_str("canonicalize -c %c", opts.canonical_method);
+  string resume_stage = opts.it_ctrl.get_resume_stage();
+  if (opts.it_ctrl.is_resume_pending() &&
+      !(resume_stage == planarize_stage && opts.planarize_method) &&
+      !(resume_stage == canonical_stage && opts.canonical_method != 'x' &&
+        opts.num_iters_canonical != 0))
+    opts.error(msg_str("checkpoint is from stage '%s', which will not be run",
+                       resume_stage.c_str()),
+               'U');
+
   bool perfect_score = true;
   bool completed = false;
   if (opts.planarize_method) {
@@ -2034,11 +2089,17 @@ int main(int argc, char *argv[])
 
     bool planarize_only = true;
     opts.it_ctrl.set_max_iters(opts.num_iters_planar);
+    opts.it_ctrl.set_stage(planarize_stage);
     double radius_range_pct =
         0; // RK: not used when planarizing
            // (opts.radius_range_percent < 0) ? 0 : opts.radius_range_percent;
 
-    if (opts.planarize_method == 'b') {
+    if (resume_stage == canonical_stage) {
+      // the checkpoint was written after planarization had finished
+      opts.message("planarize: skipped, resuming canonicalization", "p");
+      completed = true;
+    }
+    else if (opts.planarize_method == 'b') {
       completed = canonicalize_bd(base, opts.it_ctrl, radius_range_pct / 100,
                                   planarize_only);
     }
@@ -2124,6 +2185,7 @@ int main(int argc, char *argv[])
 
     bool planarize_only = false;
     opts.it_ctrl.set_max_iters(opts.num_iters_canonical);
+    opts.it_ctrl.set_stage(canonical_stage);
     double radius_range_pct =
         (opts.radius_range_percent < 0) ? 80 : opts.radius_range_percent;
 
@@ -2151,6 +2213,11 @@ int main(int argc, char *argv[])
     }
   }
 
+  if (opts.it_ctrl.is_resume_pending())
+    opts.error("checkpoint was not resumed, it does not match the model, "
+               "the options or the stage",
+               'U');
+
   if ((opts.canonical_method != 'x') && (opts.num_iters_canonical != 0)) {
     fprintf(stderr, "\n");
     opts.message(msg_str("the canonical algorithm %s",
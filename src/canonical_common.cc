@@ -273,6 +273,7 @@ vector<Vec3d> reciprocalC_len2(const Geometry &geom)
 bool canonicalize_bd(Geometry &base, IterationControl it_ctrl,
                      double radius_range_percent, const bool planarize_only)
 {
+  ANTI_PROFILE_SCOPE("solve: canonical bd");
   bool completed = false;
   it_ctrl.set_finished(false);
 
@@ -284,6 +285,10 @@ bool canonicalize_bd(Geometry &base, IterationControl it_ctrl,
   double test_val = it_ctrl.get_test_val();
   double max_diff2 = 0;
 
+  // a checkpoint that does not match is reported by the caller
+  if (it_ctrl.resume(base.raw_verts()).is_error())
+    return false;
+
   for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
     vector<Vec3d> base_verts_last = base.verts();
 
@@ -344,6 +349,7 @@ bool canonicalize_bd(Geometry &base, IterationControl it_ctrl,
           it_ctrl.set_finished();
         finish_msg = "breaking out: radius range detected. try increasing -d";
       }
+      it_ctrl.record(sqrt(max_diff2), {}, finish_msg);
     }
 
     if (it_ctrl.is_status_report_iter()) {
@@ -353,6 +359,9 @@ bool canonicalize_bd(Geometry &base, IterationControl it_ctrl,
       it_ctrl.print("%-12u max_diff:%17.15e\n", it_ctrl.get_current_iter(),
                     sqrt(max_diff2));
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      it_ctrl.checkpoint(base.verts());
   }
 
   return completed;
@@ -362,6 +371,7 @@ bool canonicalize_bd(Geometry &base, IterationControl it_ctrl,
 // meant to be called with finite num_iters (not -1)
 bool planarize_bd(Geometry &geom, IterationControl it_ctrl)
 {
+  ANTI_PROFILE_SCOPE("solve: planar bd");
   double radius_range_percent = 0;
   bool planarize_only = true;
   return canonicalize_bd(geom, it_ctrl, radius_range_percent, planarize_only);
@@ -58,6 +58,7 @@ public:
   bool append_container = false;     // append cage of -k container
   bool voronoi_cells = false;        // calculate voronoi cells
   bool voronoi_central_cell = false; // include voronoi cells only at center
+  bool voronoi_local_cells = false;  // calculate voronoi cells locally
   bool convex_hull = false;          // convex hull for waterman polyhedra
   bool add_hull = false;             // add lattice to waterman polyhedra
   bool append_lattice = false;       // append lattice to final produc
@@ -121,6 +122,7 @@ Scene Options
               use multiple -s parameters for multiple struts
   -D <opt>  Voronoi (a.k.a Dirichlet) cells (Brillouin zones for duals)
               c - cells only, i - cell(s) touching center only
+              follow with l to calculate each cell locally, in parallel
   -C <opt>  c - convex hull only, i - keep interior
   -A        append the original lattice to the final product
   -R <fi,s> repeat off file fi at every vertex in lattice. If optional s is
@@ -240,11 +242,16 @@ void lutil_opts::process_command_line(int argc, char **argv)
     }
 
     case 'D':
-      if (strlen(optarg) > 1 || !strchr("ci", *optarg))
-        error("Voronoi cells arg is '" + string(optarg) + "' must be c, i", c);
+      if (!strchr("ci", *optarg) ||
+          (strlen(optarg) > 1 && strcmp(optarg + 1, "l")))
+        error("Voronoi cells arg is '" + string(optarg) +
+                  "' must be c, i, optionally followed by l",
+              c);
       voronoi_cells = true;
       if (strchr("i", *optarg))
         voronoi_central_cell = true;
+      if (strlen(optarg) > 1)
+        voronoi_local_cells = true;
       break;
 
     case 'C':
@@ -454,7 +461,7 @@ void process_lattices(Geometry &geom, Geometry &container,
   if (opts.voronoi_cells) {
     Geometry vgeom;
     if (get_voronoi_geom(geom, vgeom, opts.voronoi_central_cell, false,
-                         opts.eps)) {
+                         opts.eps, opts.voronoi_local_cells)) {
       Coloring(&vgeom).vef_one_col(opts.vert_col[2], opts.edge_col[2],
                                    opts.face_col[2]);
       geom = vgeom;
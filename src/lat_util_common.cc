@@ -31,7 +31,9 @@
 #include "lat_util_common.h"
 #include "../base/antiprism.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -407,7 +409,8 @@ void color_centroid(Geometry &geom, Color &cent_col, const double eps)
 }
 
 int get_voronoi_geom(Geometry &geom, Geometry &vgeom, const bool central_cells,
-                     const bool one_cell_only, const double eps)
+                     const bool one_cell_only, const double eps,
+                     const bool local_cells)
 {
   // do this in case compound lattice was sent. Simultaneous points cause
   // problems for Voronoi Cells
@@ -428,16 +431,41 @@ int get_voronoi_geom(Geometry &geom, Geometry &vgeom, const bool central_cells,
   // Add centroid to a vector. Needed in this form for are_points_in_hull()
   vector<Vec3d> cent = as_vector(centroid(hgeom.verts()));
 
+  // the cells touching the centre are the cells of the points nearest to
+  // it, only these cells are calculated locally
+  vector<int> cent_idxs;
+  if (local_cells && central_cells) {
+    double min_dist = std::numeric_limits<double>::max();
+    for (const auto &v : geom.verts())
+      min_dist = std::min(min_dist, (v - cent[0]).len());
+    for (unsigned int i = 0; i < geom.verts().size(); i++)
+      if ((geom.verts(i) - cent[0]).len() < min_dist + eps)
+        cent_idxs.push_back(i);
+  }
+
   vector<Geometry> cells;
-  get_voronoi_cells(geom.verts(), &cells);
+  Status stat2 =
+      (local_cells)
+          ? get_voronoi_cells_local(geom.verts(), &cells, eps, 0,
+                                    (central_cells) ? &cent_idxs : nullptr)
+          : get_voronoi_cells(geom.verts(), &cells);
+  if (stat2.is_error()) {
+    fprintf(stderr, "%s\n", stat2.c_msg());
+    fprintf(stderr, "get_voronoi_geom: warning: Voronoi cells could not "
+                    "be created\n");
+    return 0;
+  }
 
   for (auto &cell : cells) {
-    if (central_cells &&
-        !are_points_in_hull(cent, hgeom, INCLUSION_IN | INCLUSION_ON, eps)) {
-      continue;
+    // the local cells were only calculated for the points nearest the centre
+    if (central_cells && !local_cells) {
+      Geometry ocell = cell;
+      ocell.orient(1); // positive orientation
+      if (!are_points_in_hull(cent, ocell, INCLUSION_IN | INCLUSION_ON, eps))
+        continue;
     }
-    else if (!are_points_in_hull(cell.verts(), hgeom,
-                                 INCLUSION_IN | INCLUSION_ON, eps)) {
+    if (!are_points_in_hull(cell.verts(), hgeom, INCLUSION_IN | INCLUSION_ON,
+                            eps)) {
       continue;
     }
     vgeom.append(cell);
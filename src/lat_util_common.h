@@ -69,7 +69,7 @@ void color_centroid(anti::Geometry &, anti::Color &,
                     double eps = anti::epsilon);
 
 int get_voronoi_geom(anti::Geometry &, anti::Geometry &, const bool, const bool,
-                     double eps = anti::epsilon);
+                     double eps = anti::epsilon, const bool local_cells = false);
 
 // for lat_util.cc, bravais.cc and waterman.cc
 
@@ -31,6 +31,7 @@
 #include "../base/antiprism.h"
 #include "../src/color_common.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <map>
 #include <string>
@@ -47,6 +48,9 @@ public:
   string ifile;
   string ofile;
 
+  string batch_list; // miller numbers to make in batch mode
+  string cache_dir;  // directory to store diagrams between runs
+
   string output_parts = "s";           // s - stellation d - diagram
   bool merge_faces = false;            // do a planar merge on facelet
   bool rebuild_compound_model = false; // rebuild with seperate constituents
@@ -72,7 +76,7 @@ public:
 void miller_opts::usage()
 {
   fprintf(stdout, R"(
-Usage: %s [options] input
+Usage: %s [options] [input]
 
 Millers 59 Icosahedra Stellations. Plus additional stellations since discovered
 input may be Miller list number from 1 to 75. Or m_string where string consists
@@ -82,9 +86,16 @@ model string can be followed by I or Ih symmetry. e.g. m_e1f1',I
 Options
 %s
   -L        list models only
+  -b <nums> batch mode, make several models in parallel from one diagram,
+            given as Miller numbers and ranges e.g. 1-32,60, or 'all'. Each
+            model is written to its own file (see -o)
+  -C <dir>  directory to store the stellation diagram, which is reused by
+            later runs with the same settings (directory must exist)
   -l <lim>  minimum distance for unique vertex locations as negative exponent
               (default: %d giving %.0e)
-  -o <file> write output to file (default: write to standard output)
+  -o <file> write output to file (default: write to standard output). In
+            batch mode the two digit Miller number is added before the file
+            extension, e.g. m.off gives m01.off (default: miller.off)
 
 Program Options
   -M        merge stellation facelets (for cell name strings only)
@@ -139,7 +150,7 @@ void miller_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hLMrO:V:E:F:T:m:l:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":hLb:C:MrO:V:E:F:T:m:l:o:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -148,6 +159,14 @@ void miller_opts::process_command_line(int argc, char **argv)
       list_polys = true;
       break;
 
+    case 'b':
+      batch_list = optarg;
+      break;
+
+    case 'C':
+      cache_dir = optarg;
+      break;
+
     case 'M':
       merge_faces = true;
       break;
@@ -281,6 +300,9 @@ void miller_opts::process_command_line(int argc, char **argv)
 
   if (argc - optind == 1)
     ifile = argv[optind];
+
+  if (batch_list.size() && ifile.size())
+    error("input model cannot be given in batch mode (-b)");
 }
 
 struct MillerItem {
@@ -294,11 +316,18 @@ class Miller {
 private:
   MillerItem *Miller_items;
   int last_M;
+  map<string, StellationDiagrams> stel_diagrams; // by symmetry
+  bool batch;                                     // diagrams all made
 
 public:
   Miller();
+  StellationDiagrams &get_diagrams(const string &sym_str,
+                                   const miller_opts &opts);
+  const StellationDiagrams *find_diagrams(const string &sym_str) const;
+  Status add_diagrams(int sym, const miller_opts &opts);
+  void set_batch(bool batch_mode) { batch = batch_mode; }
   int get_poly(anti::Geometry &geom, int sym, string cell_str, string sym_str,
-               map<int, Geometry> &diagrams, miller_opts &opts);
+               map<int, Geometry> &diagrams, const miller_opts &opts);
   int get_last_M() { return last_M; }
   void list_polys();
 };
@@ -421,6 +450,30 @@ Miller::Miller()
 {
   Miller_items = miller_item_list;
   last_M = sizeof(miller_item_list) / sizeof(miller_item_list[0]);
+  batch = false;
+}
+
+// diagrams of the icosahedron for a symmetry, made when first used
+StellationDiagrams &Miller::get_diagrams(const string &sym_str,
+                                         const miller_opts &opts)
+{
+  auto it = stel_diagrams.find(sym_str);
+  if (it != stel_diagrams.end())
+    return it->second;
+
+  Geometry ico;
+  ico.read_resource("ico");
+  StellationDiagrams &diagrams = stel_diagrams[sym_str];
+  diagrams.init(ico, sym_str, 500, opts.eps);
+  diagrams.set_cache_dir(opts.cache_dir);
+  return diagrams;
+}
+
+// diagrams of the icosahedron for a symmetry, or nullptr if not made
+const StellationDiagrams *Miller::find_diagrams(const string &sym_str) const
+{
+  auto it = stel_diagrams.find(sym_str);
+  return (it != stel_diagrams.end()) ? &it->second : nullptr;
 }
 
 // if cell string will not decode, return empty result string
@@ -539,11 +592,50 @@ vector<string> decode_cell_string(string cell_str)
   return (diagram_list_strings);
 }
 
-int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str,
-                     map<int, Geometry> &diagrams, miller_opts &opts)
+// index lists for a cell string, empty if the cell string is invalid,
+// the stellation face index is in the first position of each list
+vector<vector<int>> get_idx_lists(const string &cell_str)
+{
+  vector<string> diagram_list_strings = decode_cell_string(cell_str);
+  vector<vector<int>> idx_lists(diagram_list_strings.size());
+
+  // data sizes are verified
+  for (unsigned int i = 0; i < diagram_list_strings.size(); i++) {
+    if (!diagram_list_strings[i].length())
+      continue;
+
+    read_idx_list((char *)diagram_list_strings[i].c_str(), idx_lists[i],
+                  std::numeric_limits<int>::max(), false);
+  }
+
+  return idx_lists;
+}
+
+// make the diagrams needed for a Miller model, before making models in
+// batch mode, when the diagrams are only looked up
+Status Miller::add_diagrams(int sym, const miller_opts &opts)
 {
-  geom.read_resource("ico");
+  Status stat;
+  if (sym < 0 || sym >= last_M)
+    return stat;
+
+  StellationDiagrams &diagrams = get_diagrams(Miller_items[sym].sub_sym, opts);
+  for (const auto &idx_list : get_idx_lists(Miller_items[sym].cell_string)) {
+    if (idx_list.empty())
+      continue;
+    Status stat2 = diagrams.add_diagram(idx_list[0]);
+    if (stat2.is_error())
+      return stat2;
+    if (stat2.is_warning())
+      stat = stat2;
+  }
+
+  return stat;
+}
 
+int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str,
+                     map<int, Geometry> &diagrams, const miller_opts &opts)
+{
   // decode the cell string
   if (!cell_str.length()) {
     cell_str = Miller_items[sym].cell_string;
@@ -553,49 +645,57 @@ int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str,
     if (!sym_str.length())
       sym_str = "Ih";
   }
-  fprintf(stderr, "cell string = %s symmetry = %s\n", cell_str.c_str(),
-          sym_str.c_str());
+  // models are made in parallel in batch mode, so don't write messages
+  if (!batch)
+    fprintf(stderr, "cell string = %s symmetry = %s\n", cell_str.c_str(),
+            sym_str.c_str());
 
-  vector<string> diagram_list_strings = decode_cell_string(cell_str);
   // if list is empty, code string was invalid
-  unsigned int sz = diagram_list_strings.size();
-  if (!sz)
+  vector<vector<int>> idx_lists = get_idx_lists(cell_str);
+  if (!idx_lists.size())
     return -1;
 
-  vector<vector<int>> idx_lists(sz);
-
-  // data sizes are verified
-  for (unsigned int i = 0; i < diagram_list_strings.size(); i++) {
-    if (!diagram_list_strings[i].length())
-      continue;
-
-    read_idx_list((char *)diagram_list_strings[i].c_str(), idx_lists[i],
-                  std::numeric_limits<int>::max(), false);
-
-    // stellation face index is in the first position
-    int stellation_face_idx = idx_lists[i][0];
-
-    // construct the diagrams
-    if (!diagrams[stellation_face_idx].verts().size())
-      diagrams[stellation_face_idx] =
-          make_stellation_diagram(geom, stellation_face_idx, sym_str);
+  // construct the diagrams, if not already made. In batch mode they are
+  // all made beforehand, and are only looked up.
+  if (!batch) {
+    StellationDiagrams &new_diagrams = get_diagrams(sym_str, opts);
+    for (const auto &idx_list : idx_lists) {
+      if (idx_list.empty())
+        continue;
+      Status stat = new_diagrams.add_diagram(idx_list[0]);
+      if (stat.is_warning())
+        opts.warning(stat.msg(), 'C');
+    }
   }
 
+  const StellationDiagrams *found_diagrams = find_diagrams(sym_str);
+  if (!found_diagrams)
+    return -1;
+  const StellationDiagrams &stel_diagrams = *found_diagrams;
+  for (const auto &idx_list : idx_lists)
+    if (idx_list.size() && !stel_diagrams.get_diagrams().count(idx_list[0]))
+      return -1;
+
   bool merge_faces =
       (sym > -1) ? Miller_items[sym].merge_faces : opts.merge_faces;
-  bool remove_inline_verts = Miller_items[sym].remove_inline_verts;
+  bool remove_inline_verts =
+      (sym > -1) ? Miller_items[sym].remove_inline_verts : true;
   bool split_pinched = true;
   bool resolve_faces = true;
   bool remove_multiples = true;
 
-  geom = make_stellation(geom, diagrams, idx_lists, sym_str, merge_faces,
-                         remove_inline_verts, split_pinched, resolve_faces,
-                         remove_multiples, opts.map_string, opts.eps);
-
-  vector<vector<int>> idx_lists_full =
-      lists_full(diagrams, idx_lists, remove_multiples);
+  geom = stel_diagrams.make_stellation(idx_lists, merge_faces,
+                                       remove_inline_verts, split_pinched,
+                                       resolve_faces, remove_multiples,
+                                       opts.map_string);
 
   if (opts.output_parts.find_first_of("d") != string::npos) {
+    vector<vector<int>> idx_lists_full =
+        stel_diagrams.lists_full(idx_lists, remove_multiples);
+
+    // diagrams for display, the originals keep their color indexes
+    diagrams = stel_diagrams.get_diagrams();
+
     // color diagrams
     for (auto const &key1 : diagrams) {
       Coloring clrng(&diagrams[key1.first]);
@@ -625,8 +725,8 @@ int Miller::get_poly(Geometry &geom, int sym, string cell_str, string sym_str,
   return 1;
 }
 
-int make_resource_miller(Geometry &geom, string name, miller_opts &opts,
-                         string *error_msg = nullptr)
+int make_resource_miller(Geometry &geom, string name, Miller &mill,
+                         const miller_opts &opts, string *error_msg = nullptr)
 {
   int sym_no = -1;
   // check if it is just the index number, if so format as m%d
@@ -641,7 +741,6 @@ int make_resource_miller(Geometry &geom, string name, miller_opts &opts,
   string cell_str;
   string sym_str;
 
-  Miller mill;
   if (read_int(name.c_str() + 1, &sym_no)) {
     sym_no--;
     if (sym_no < 0 || sym_no >= mill.get_last_M()) {
@@ -690,20 +789,23 @@ int make_resource_miller(Geometry &geom, string name, miller_opts &opts,
   if (opts.output_parts.find_first_of("s") == string::npos)
     geom.clear_all();
   else {
+    // copy, as the default coloring depends on the model
+    OffColor off_color = opts.off_color;
+
     // if coloring method not set
-    if (!opts.off_color.get_f_col_op()) {
+    if (!off_color.get_f_col_op()) {
       // check if it is a compound
       GeometryInfo info(geom);
       if (info.num_parts() > 1)
-        opts.off_color.set_f_col_op('k');
+        off_color.set_f_col_op('k');
       else
         // goldenrod1: Color(255,193,37) ... from George Hart,
         // Color(1.0,0.7,0.1)
-        opts.off_color.set_f_col(Color(255, 193, 37));
+        off_color.set_f_col(Color(255, 193, 37));
     }
 
     // handles face_color_op "hH" if it is set, colors edges and vertices
-    color_faces_by_connection_vef(geom, opts.off_color);
+    color_faces_by_connection_vef(geom, off_color);
   }
 
   // append diagrams if being output
@@ -730,10 +832,54 @@ int make_resource_miller(Geometry &geom, string name, miller_opts &opts,
 int try_miller(Geometry &geom, miller_opts &opts, string *error_msg = nullptr)
 {
   string name = opts.ifile;
-  int idx = make_resource_miller(geom, name, opts, error_msg);
+  Miller mill;
+  int idx = make_resource_miller(geom, name, mill, opts, error_msg);
   return (idx);
 }
 
+// insert the two digit model number before the file extension
+string batch_file_name(const string &ofile, int num)
+{
+  size_t dot = ofile.find_last_of('.');
+  size_t dir_end = ofile.find_last_of("/\\");
+  if (dot == string::npos || (dir_end != string::npos && dot < dir_end))
+    dot = ofile.size();
+  return ofile.substr(0, dot) + msg_str("%02d", num) + ofile.substr(dot);
+}
+
+// make the diagrams once, then make the models from them in parallel
+void make_batch(miller_opts &opts)
+{
+  Miller mill;
+  string list = (opts.batch_list == "all") ? "1-" : opts.batch_list;
+  vector<int> nums;
+  opts.print_status_or_exit(
+      read_idx_list(list.c_str(), nums, mill.get_last_M() + 1), 'b');
+  if (find(nums.begin(), nums.end(), 0) != nums.end())
+    opts.error("Miller numbers start from 1", 'b');
+
+  // models only read the diagrams, so add them all before running in parallel
+  for (int num : nums)
+    opts.print_status_or_exit(mill.add_diagrams(num - 1, opts), 'C');
+  mill.set_batch(true);
+
+  string ofile = opts.ofile.size() ? opts.ofile : "miller.off";
+  vector<Status> stats(nums.size());
+  parallel_for(nums.size(), [&](size_t i) {
+    Geometry geom;
+    string error_msg;
+    if (make_resource_miller(geom, std::to_string(nums[i]), mill, opts,
+                             &error_msg))
+      stats[i] = Status::error(error_msg);
+    else
+      stats[i] = geom.write(batch_file_name(ofile, nums[i]));
+  });
+
+  for (unsigned int i = 0; i < nums.size(); i++)
+    if (stats[i].is_error())
+      opts.error(msg_str("model %d: %s", nums[i], stats[i].c_msg()), 'b');
+}
+
 int main(int argc, char *argv[])
 {
   miller_opts opts;
@@ -745,6 +891,11 @@ int main(int argc, char *argv[])
     exit(0);
   }
 
+  if (opts.batch_list.size()) {
+    make_batch(opts);
+    exit(0);
+  }
+
   string error_msg;
 
   Geometry geom;
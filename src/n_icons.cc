@@ -1099,7 +1099,7 @@ int num_lats(const int ncon_order, const bool point_cut)
   return lats;
 }
 
-int num_lats_faces(const vector<faceList *> &face_list)
+int num_lats_faces(const pooledList<faceList> &face_list)
 {
   int lats = 0;
   for (auto i : face_list)
@@ -1109,7 +1109,7 @@ int num_lats_faces(const vector<faceList *> &face_list)
   return lats + 1;
 }
 
-int num_lats_edges(const vector<edgeList *> &edge_list)
+int num_lats_edges(const pooledList<edgeList> &edge_list)
 {
   int lats = 0;
   for (auto i : edge_list)
@@ -1118,94 +1118,48 @@ int num_lats_edges(const vector<edgeList *> &edge_list)
   return lats;
 }
 
-void add_coord(Geometry &geom, vector<coordList *> &coordinates,
+void add_coord(Geometry &geom, pooledList<coordList> &coordinates,
                const Vec3d &vert)
 {
-  coordinates.push_back(new coordList(geom.add_vert(vert)));
+  coordinates.add(geom.add_vert(vert));
 }
 
-void clear_coord(vector<coordList *> &coordinates)
-{
-  for (auto &coordinate : coordinates)
-    delete coordinate;
-  coordinates.clear();
-}
-
-void add_face(Geometry &geom, vector<faceList *> &face_list,
+void add_face(Geometry &geom, pooledList<faceList> &face_list,
               const vector<int> &face, const int lat, const int lon)
 {
-  face_list.push_back(new faceList(geom.add_face(face), lat, lon, 0));
+  face_list.add(geom.add_face(face), lat, lon, 0);
 }
 
-void add_face(Geometry &geom, vector<faceList *> &face_list,
+void add_face(Geometry &geom, pooledList<faceList> &face_list,
               const vector<int> &face, const int lat, const int lon,
               const int polygon_no)
 {
-  face_list.push_back(new faceList(geom.add_face(face), lat, lon, polygon_no));
-}
-
-void clear_faces(vector<faceList *> &face_list)
-{
-  for (auto &i : face_list)
-    delete i;
-  face_list.clear();
-}
-
-void delete_face_list_items(vector<faceList *> &face_list,
-                            const vector<int> &f_nos)
-{
-  vector<int> dels = f_nos;
-  if (!dels.size())
-    return;
-  sort(dels.begin(), dels.end());
-  unsigned int del_faces_cnt = 0;
-  int map_to;
-  for (unsigned int i = 0; i < face_list.size(); i++) {
-    if (del_faces_cnt < dels.size() && (int)i == dels[del_faces_cnt]) {
-      del_faces_cnt++;
-    }
-    else {
-      map_to = i - del_faces_cnt;
-      face_list[map_to] = face_list[i];
-    }
-  }
-  face_list.resize(face_list.size() - del_faces_cnt);
+  face_list.add(geom.add_face(face), lat, lon, polygon_no);
 }
 
 // pass edge by value from make_edge()
 // only add_edge_raw can be used else edge count is not correct for n_icons
-void add_edge(Geometry &geom, vector<edgeList *> &edge_list,
+void add_edge(Geometry &geom, pooledList<edgeList> &edge_list,
               const vector<int> &edge, const int lat, const int lon)
 {
-  edge_list.push_back(new edgeList(geom.add_edge_raw(edge), lat, lon));
+  edge_list.add(geom.add_edge_raw(edge), lat, lon);
 }
 
-void clear_edges(vector<edgeList *> &edge_list)
+// index edges, as from make_edge(), by their first position in the list
+map<vector<int>, int> make_edge_index(const vector<vector<int>> &edges)
 {
-  for (auto &i : edge_list)
-    delete i;
-  edge_list.clear();
+  map<vector<int>, int> edge_idx;
+  for (unsigned int i = 0; i < edges.size(); i++)
+    edge_idx.insert(make_pair(make_edge(edges[i][0], edges[i][1]), (int)i));
+  return edge_idx;
 }
 
-void delete_edge_list_items(vector<edgeList *> &edge_list,
-                            const vector<int> &f_nos)
+// as find_edge_in_edge_list() for the indexed list, -1 if not found
+int find_edge_in_edge_index(const map<vector<int>, int> &edge_idx,
+                            const vector<int> &edge)
 {
-  vector<int> dels = f_nos;
-  if (!dels.size())
-    return;
-  sort(dels.begin(), dels.end());
-  unsigned int del_edges_cnt = 0;
-  int map_to;
-  for (unsigned int i = 0; i < edge_list.size(); i++) {
-    if (del_edges_cnt < dels.size() && (int)i == dels[del_edges_cnt]) {
-      del_edges_cnt++;
-    }
-    else {
-      map_to = i - del_edges_cnt;
-      edge_list[map_to] = edge_list[i];
-    }
-  }
-  edge_list.resize(edge_list.size() - del_edges_cnt);
+  auto mi = edge_idx.find(make_edge(edge[0], edge[1]));
+  return (mi != edge_idx.end()) ? mi->second : -1;
 }
 
 class vertexMap {
@@ -1254,7 +1208,7 @@ void merge_halves(Geometry &geom, vector<polarOrb *> &polar_orbit,
 
 // method 3: prime polygon is analog of prime meridian
 void build_prime_polygon(Geometry &geom, vector<int> &prime_meridian,
-                         vector<coordList *> &coordinates,
+                         pooledList<coordList> &coordinates,
                          const vector<poleList *> &pole, const ncon_opts &opts)
 {
   // for finding poles, the accuracy must be less than the default
@@ -1343,7 +1297,7 @@ void reverse_poly_indexes_on_y(Geometry &geom, vector<int> &polygon,
 
 // bypass is for testing. rotation will not work if true
 vector<vector<int>> split_bow_ties(Geometry &geom,
-                                   vector<coordList *> &coordinates,
+                                   pooledList<coordList> &coordinates,
                                    vector<int> &face, const ncon_opts &opts)
 {
   const vector<Vec3d> &verts = geom.verts();
@@ -1402,40 +1356,20 @@ vector<vector<int>> split_bow_ties(Geometry &geom,
   return faces;
 }
 
-vector<int> find_face_by_lat_lon(const vector<faceList *> &face_list,
-                                 const int lat, const int lon)
-{
-  vector<int> idx;
-  for (unsigned int i = 0; i < face_list.size(); i++) {
-    if (face_list[i]->lat == lat && face_list[i]->lon == lon)
-      idx.push_back(i);
-  }
-  return idx;
-}
-
-vector<int> find_edge_by_lat_lon(const vector<edgeList *> &edge_list,
-                                 const int lat, const int lon)
-{
-  vector<int> idx;
-  for (unsigned int i = 0; i < edge_list.size(); i++) {
-    if (edge_list[i]->lat == lat && edge_list[i]->lon == lon)
-      idx.push_back(i);
-  }
-  return idx;
-}
-
-bool add_edge_wrapper(Geometry &geom, vector<edgeList *> &edge_list,
+bool add_edge_wrapper(Geometry &geom, pooledList<edgeList> &edge_list,
+                      map<vector<int>, int> &edge_idx,
                       const vector<int> &edge, const int lat,
                       const int lon_front, const int lon_back)
 {
   const vector<Vec3d> &verts = geom.verts();
 
-  int edge_no = find_edge_in_edge_list(geom.edges(), edge);
+  int edge_no = find_edge_in_edge_index(edge_idx, edge);
   if (edge_no < 0) {
     double edge_z = centroid(verts, edge)[2];
 
     int lon = (edge_z > 0.0) ? lon_front : lon_back;
     add_edge(geom, edge_list, make_edge(edge[0], edge[1]), lat, lon);
+    edge_idx[make_edge(edge[0], edge[1])] = geom.edges().size() - 1;
 
     if (edge_z > 0.0) // || double_eq(edge_z,0.0,eps))
       edge_list.back()->rotate = true;
@@ -1447,8 +1381,8 @@ bool add_edge_wrapper(Geometry &geom, vector<edgeList *> &edge_list,
 // split_face_indexes is cleared after use
 void apply_latitudes(const Geometry &geom,
                      vector<vector<int>> &split_face_indexes,
-                     const vector<faceList *> &face_list,
-                     const vector<edgeList *> &edge_list,
+                     pooledList<faceList> &face_list,
+                     pooledList<edgeList> &edge_list,
                      const vector<poleList *> &pole, const ncon_opts &opts)
 {
   const vector<vector<int>> &faces = geom.faces();
@@ -1544,6 +1478,7 @@ void apply_latitudes(const Geometry &geom,
 
     // each face is associated with one or two edges
     map<int, vector<int>> faces_edges_map;
+    map<vector<int>, int> edge_idx = make_edge_index(edges);
     for (unsigned int i = 0; i < faces.size(); i++) {
       vector<int> face = faces[i];
       unsigned int sz = face.size();
@@ -1551,7 +1486,7 @@ void apply_latitudes(const Geometry &geom,
         vector<int> edge(2);
         edge[0] = face[j];
         edge[1] = face[(j + 1) % sz];
-        int ret = find_edge_in_edge_list(edges, edge);
+        int ret = find_edge_in_edge_index(edge_idx, edge);
         if (ret > -1)
           faces_edges_map[i].push_back(ret);
       }
@@ -1779,6 +1714,8 @@ void apply_latitudes(const Geometry &geom,
       }
     }
   }
+  face_list.reindex();
+  edge_list.reindex();
 }
 
 // This was the old method of apply_latitudes, it still works for double_sweep
@@ -1787,8 +1724,8 @@ void apply_latitudes(const Geometry &geom,
 void apply_latitudes(const Geometry &geom,
                      const vector<vector<int>> &original_faces,
                      const vector<vector<int>> &split_face_indexes,
-                     const vector<faceList *> &face_list,
-                     const vector<edgeList *> &edge_list,
+                     pooledList<faceList> &face_list,
+                     pooledList<edgeList> &edge_list,
                      const vector<poleList *> &pole, const ncon_opts &opts)
 {
   const vector<vector<int>> &faces = geom.faces();
@@ -1832,6 +1769,7 @@ void apply_latitudes(const Geometry &geom,
     edge_list[j]->lat = lat;
     last_y = edge_y.first;
   }
+  edge_list.reindex();
 
   // find faces connected to edges for latitude assignment
   // optimization: if face lats not needed then bypass
@@ -1912,22 +1850,25 @@ void apply_latitudes(const Geometry &geom,
       }
     }
   }
+  face_list.reindex();
 }
 
 // method 3: fix polygon numbers for compound coloring
-void fix_polygon_numbers(const vector<faceList *> &face_list,
+void fix_polygon_numbers(pooledList<faceList> &face_list,
                          const ncon_opts &opts)
 {
+  // look up polygon numbers without writing to the list
+  const pooledList<faceList> &const_face_list = face_list;
   int lat = 0;
   unsigned int sz = 0;
   do {
     int polygon_min = std::numeric_limits<int>::max();
     for (unsigned int j = 0; j < 2; j++) {
       int lon = (opts.longitudes.front() / 2) - j;
-      vector<int> idx = find_face_by_lat_lon(face_list, lat, lon);
+      const vector<int> &idx = const_face_list.find(lat, lon);
       sz = idx.size();
       for (unsigned int k = 0; k < sz; k++) {
-        int polygon_no = face_list[idx[k]]->polygon_no;
+        int polygon_no = const_face_list[idx[k]]->polygon_no;
         if (polygon_no < polygon_min)
           polygon_min = polygon_no;
       }
@@ -1946,9 +1887,9 @@ void fix_polygon_numbers(const vector<faceList *> &face_list,
 // for method 3: analog to form_globe()
 // maximum latitudes is set
 void form_angular_model(Geometry &geom, const vector<int> &prime_meridian,
-                        vector<coordList *> &coordinates,
-                        vector<faceList *> &face_list,
-                        vector<edgeList *> &edge_list,
+                        pooledList<coordList> &coordinates,
+                        pooledList<faceList> &face_list,
+                        pooledList<edgeList> &edge_list,
                         const vector<poleList *> &pole,
                         vector<vector<int>> &original_faces,
                         vector<vector<int>> &split_face_indexes,
@@ -1965,6 +1906,8 @@ void form_angular_model(Geometry &geom, const vector<int> &prime_meridian,
   vector<int> meridian_last;
   vector<int> meridian;
 
+  map<vector<int>, int> edge_idx = make_edge_index(geom.edges());
+
   for (int i = 1; i <= polygons_total; i++) {
     // move current meridian one back
     meridian_last = (i == 1) ? prime_meridian : meridian;
@@ -2058,11 +2001,11 @@ void form_angular_model(Geometry &geom, const vector<int> &prime_meridian,
 
           // always add edges to discover face latitudes
           if (top_edge.size() == 2)
-            add_edge_wrapper(geom, edge_list, top_edge, -1, lon_front,
-                             lon_back);
+            add_edge_wrapper(geom, edge_list, edge_idx, top_edge, -1,
+                             lon_front, lon_back);
           if (bottom_edge.size() == 2)
-            add_edge_wrapper(geom, edge_list, bottom_edge, -1, lon_front,
-                             lon_back);
+            add_edge_wrapper(geom, edge_list, edge_idx, bottom_edge, -1,
+                             lon_front, lon_back);
         }
 
         if (split_face_idx.size()) {
@@ -2082,7 +2025,7 @@ void form_angular_model(Geometry &geom, const vector<int> &prime_meridian,
 // for method 2: to hide uneeded edges
 // note that function used to reverse indented based on manual inner and outer
 // radii
-void mark_indented_edges_invisible(const vector<edgeList *> &edge_list,
+void mark_indented_edges_invisible(pooledList<edgeList> &edge_list,
                                    const vector<poleList *> &pole,
                                    const bool radius_reverse,
                                    const ncon_opts &opts)
@@ -2104,6 +2047,7 @@ void mark_indented_edges_invisible(const vector<edgeList *> &edge_list,
       i->lat = lat;
     }
   }
+  edge_list.reindex();
 
   for (unsigned int i = 0; i < 2; i++) {
     if (pole[i]->idx > -1) {
@@ -2119,7 +2063,7 @@ void mark_indented_edges_invisible(const vector<edgeList *> &edge_list,
   }
 }
 
-void restore_indented_edges(const vector<edgeList *> &edge_list,
+void restore_indented_edges(pooledList<edgeList> &edge_list,
                             const ncon_opts &opts)
 {
   for (auto i : edge_list) {
@@ -2129,6 +2073,7 @@ void restore_indented_edges(const vector<edgeList *> &edge_list,
       i->lat = lat;
     }
   }
+  edge_list.reindex();
 }
 
 // for method 2
@@ -2172,8 +2117,8 @@ vector<pair<int, int>> get_lat_pairs(const int n, int d, const bool point_cut)
 // for method 2: set latitude numbers for pairs of faces of shell models
 // then split_face_indexes is filled
 void find_split_faces_shell_model(const Geometry &geom,
-                                  const vector<faceList *> &face_list,
-                                  const vector<edgeList *> &edge_list,
+                                  pooledList<faceList> &face_list,
+                                  pooledList<edgeList> &edge_list,
                                   const vector<poleList *> &pole,
                                   vector<vector<int>> &split_face_indexes,
                                   const ncon_opts &opts)
@@ -2219,6 +2164,8 @@ void find_split_faces_shell_model(const Geometry &geom,
         }
       }
     }
+    face_list.reindex();
+    edge_list.reindex();
   }
 
   // collect split faces
@@ -2309,7 +2256,7 @@ void calc_radii(double &inner_radius, double &outer_radius, double &arc,
 // inner_radius, outer_radius set
 // point_cut_calc changed from side cut to point cut if build method 2 and d > 1
 void build_prime_meridian(Geometry &geom, vector<int> &prime_meridian,
-                          vector<coordList *> &coordinates,
+                          pooledList<coordList> &coordinates,
                           double &inner_radius, double &outer_radius,
                           bool &point_cut_calc, const ncon_opts &opts)
 {
@@ -2388,8 +2335,9 @@ vector<int> calc_polygon_numbers(int n, int d, bool point_cut)
 
 // methods 1 and 2
 void form_globe(Geometry &geom, const vector<int> &prime_meridian,
-                vector<coordList *> &coordinates, vector<faceList *> &face_list,
-                vector<edgeList *> &edge_list, const bool point_cut_calc,
+                pooledList<coordList> &coordinates,
+                pooledList<faceList> &face_list,
+                pooledList<edgeList> &edge_list, const bool point_cut_calc,
                 const bool second_half, const ncon_opts &opts)
 {
   const vector<vector<int>> &faces = geom.faces();
@@ -2566,8 +2514,8 @@ void form_globe(Geometry &geom, const vector<int> &prime_meridian,
 
 // add caps to method 1 and 2 models
 // caps indexes are retained
-void add_caps(Geometry &geom, vector<coordList *> &coordinates,
-              vector<faceList *> &face_list, const vector<poleList *> &pole,
+void add_caps(Geometry &geom, pooledList<coordList> &coordinates,
+              pooledList<faceList> &face_list, const vector<poleList *> &pole,
               vector<int> &caps, const bool point_cut_calc,
               const ncon_opts &opts)
 {
@@ -2731,7 +2679,7 @@ void add_caps(Geometry &geom, vector<coordList *> &coordinates,
 }
 
 // for method 1 covering
-void close_latitudinal(Geometry &geom, vector<faceList *> &face_list,
+void close_latitudinal(Geometry &geom, pooledList<faceList> &face_list,
                        const vector<poleList *> &pole, const ncon_opts &opts)
 {
   bool point_cut_calc = opts.point_cut;
@@ -2887,9 +2835,9 @@ void find_polar_orbit(Geometry &geom, vector<polarOrb *> &polar_orbit,
 
 // opts.twist_angle is set
 void ncon_twist(Geometry &geom, const vector<polarOrb *> &polar_orbit,
-                const vector<coordList *> &coordinates,
-                const vector<faceList *> &face_list,
-                const vector<edgeList *> &edge_list, const int ncon_order,
+                pooledList<coordList> &coordinates,
+                pooledList<faceList> &face_list,
+                pooledList<edgeList> &edge_list, const int ncon_order,
                 const int twist, ncon_opts &opts)
 {
   // this function wasn't designed for twist 0
@@ -4087,7 +4035,7 @@ void unset_marked_elements(Geometry &geom)
 }
 
 // point cut is not from opts
-void ncon_edge_coloring(Geometry &geom, const vector<edgeList *> &edge_list,
+void ncon_edge_coloring(Geometry &geom, const pooledList<edgeList> &edge_list,
                         const vector<poleList *> &pole,
                         map<int, pair<int, int>> &edge_color_table,
                         const bool point_cut_calc, const ncon_opts &opts)
@@ -4356,7 +4304,7 @@ void ncon_edge_coloring(Geometry &geom, const vector<edgeList *> &edge_list,
   }
 }
 
-void ncon_face_coloring(Geometry &geom, const vector<faceList *> &face_list,
+void ncon_face_coloring(Geometry &geom, const pooledList<faceList> &face_list,
                         map<int, pair<int, int>> &face_color_table,
                         const bool point_cut_calc, const ncon_opts &opts)
 {
@@ -4552,7 +4500,7 @@ void ncon_face_coloring(Geometry &geom, const vector<faceList *> &face_list,
 
 vector<int> find_adjacent_face_idx_in_channel(
     const Geometry &geom, const int face_idx,
-    const vector<vector<int>> &bare_implicit_edges,
+    const map<vector<int>, int> &bare_implicit_edges,
     map<vector<int>, vector<int>> &faces_by_edge, const bool prime)
 {
   const vector<vector<int>> &faces = geom.faces();
@@ -4566,7 +4514,7 @@ vector<int> find_adjacent_face_idx_in_channel(
     vector<int> edge(2);
     edge[0] = face[i];
     edge[1] = face[(i + 1) % sz];
-    if (find_edge_in_edge_list(bare_implicit_edges, edge) > -1) {
+    if (find_edge_in_edge_index(bare_implicit_edges, edge) > -1) {
       adjacent_edges.push_back(make_edge(edge[0], edge[1]));
     }
   }
@@ -4596,7 +4544,7 @@ vector<int> find_adjacent_face_idx_in_channel(
 int set_face_colors_by_adjacent_face(
     Geometry &geom, const int start, const Color &c, const int opq,
     const int flood_fill_stop, int &flood_fill_count,
-    const vector<vector<int>> &bare_implicit_edges,
+    const map<vector<int>, int> &bare_implicit_edges,
     map<vector<int>, vector<int>> &faces_by_edge)
 {
   if (flood_fill_stop && (flood_fill_count >= flood_fill_stop))
@@ -4640,16 +4588,21 @@ int set_face_colors_by_adjacent_face(
   return (flood_fill_stop ? 1 : 0);
 }
 
+// bare implicit edges are indexed as by make_edge_index()
 void fill_bare_implicit_edges(const Geometry &geom,
-                              vector<vector<int>> &bare_implicit_edges)
+                              map<vector<int>, int> &bare_implicit_edges)
 {
   const vector<vector<int>> &edges = geom.edges();
   vector<vector<int>> implicit_edges;
   geom.get_impl_edges(implicit_edges);
 
+  map<vector<int>, int> edge_idx = make_edge_index(edges);
   for (auto &implicit_edge : implicit_edges) {
-    if (find_edge_in_edge_list(edges, implicit_edge) < 0)
-      bare_implicit_edges.push_back(implicit_edge);
+    if (find_edge_in_edge_index(edge_idx, implicit_edge) < 0) {
+      vector<int> edge = make_edge(implicit_edge[0], implicit_edge[1]);
+      int idx = bare_implicit_edges.size();
+      bare_implicit_edges.insert(make_pair(edge, idx));
+    }
   }
 }
 
@@ -4667,7 +4620,7 @@ void fill_faces_by_edge(const Geometry &geom,
 }
 
 int ncon_face_coloring_by_adjacent_face(Geometry &geom,
-                                        const vector<faceList *> &face_list,
+                                        const pooledList<faceList> &face_list,
                                         const ncon_opts &opts)
 {
   bool debug = false;
@@ -4679,7 +4632,7 @@ int ncon_face_coloring_by_adjacent_face(Geometry &geom,
   Coloring clrng(&geom);
   clrng.f_one_col(Color());
 
-  vector<vector<int>> bare_implicit_edges;
+  map<vector<int>, int> bare_implicit_edges;
   fill_bare_implicit_edges(geom, bare_implicit_edges);
 
   map<vector<int>, vector<int>> faces_by_edge;
@@ -4691,7 +4644,7 @@ int ncon_face_coloring_by_adjacent_face(Geometry &geom,
   unsigned int sz = 0;
   do {
     bool painted = false;
-    vector<int> idx = find_face_by_lat_lon(face_list, lat, lon);
+    const vector<int> &idx = face_list.find(lat, lon);
     sz = idx.size();
 
     Color c = map_count;
@@ -4727,7 +4680,7 @@ int ncon_face_coloring_by_adjacent_face(Geometry &geom,
       lat = 0;
       lon -= l;
       do {
-        vector<int> idx = find_face_by_lat_lon(face_list, lat, lon);
+        const vector<int> &idx = face_list.find(lat, lon);
         sz = idx.size();
         if (sz) {
           int f_idx = face_list[idx[0]]->face_no;
@@ -4788,7 +4741,7 @@ int ncon_face_coloring_by_adjacent_face(Geometry &geom,
 }
 
 void ncon_edge_coloring_by_adjacent_edge(Geometry &geom,
-                                         const vector<edgeList *> &edge_list,
+                                         const pooledList<edgeList> &edge_list,
                                          const vector<poleList *> &pole,
                                          const ncon_opts &opts)
 {
@@ -4841,7 +4794,7 @@ void ncon_edge_coloring_by_adjacent_edge(Geometry &geom,
   unsigned int sz = 0;
   do {
     bool painted = false;
-    vector<int> idx = find_edge_by_lat_lon(edge_list, lat, lon);
+    const vector<int> &idx = edge_list.find(lat, lon);
     sz = idx.size();
 
     Color c = map_count;
@@ -4921,8 +4874,9 @@ void ncon_edge_coloring_by_adjacent_edge(Geometry &geom,
 
   // some models will have a stranded edge
   bool painted = false;
+  map<vector<int>, int> edge_idx = make_edge_index(geom.edges());
   for (auto &edge : edges) {
-    int edge_no = find_edge_in_edge_list(geom.edges(), edge);
+    int edge_no = find_edge_in_edge_index(edge_idx, edge);
     if (!(geom.colors(EDGES).get(edge_no)).is_set()) {
       set_edge_color(geom, edge_no, Color(0), 255);
       painted = true;
@@ -4975,7 +4929,7 @@ void ncon_edge_coloring_by_adjacent_edge(Geometry &geom,
       // edge lats start at 1
       lat = 1;
       do {
-        vector<int> idx = find_edge_by_lat_lon(edge_list, lat, lon);
+        const vector<int> &idx = edge_list.find(lat, lon);
         sz = idx.size();
         if (sz) {
           int e_idx = edge_list[idx[0]]->edge_no;
@@ -5006,7 +4960,7 @@ void ncon_edge_coloring_by_adjacent_edge(Geometry &geom,
 }
 
 int ncon_face_coloring_by_compound_flood(Geometry &geom,
-                                         const vector<faceList *> &face_list,
+                                         const pooledList<faceList> &face_list,
                                          const vector<int> &caps,
                                          const ncon_opts &opts)
 {
@@ -5026,7 +4980,7 @@ int ncon_face_coloring_by_compound_flood(Geometry &geom,
   if (!opts.hybrid)
     lon--;
   do {
-    vector<int> idx = find_face_by_lat_lon(face_list, lat, lon);
+    const vector<int> &idx = face_list.find(lat, lon);
     sz = idx.size();
     for (int j = 0; j < sz; j++) {
       int polygon_no = face_list[idx[j]]->polygon_no;
@@ -5039,7 +4993,7 @@ int ncon_face_coloring_by_compound_flood(Geometry &geom,
   auto li = unique(polygon_table.begin(), polygon_table.end());
   polygon_table.erase(li, polygon_table.end());
 
-  vector<vector<int>> bare_implicit_edges;
+  map<vector<int>, int> bare_implicit_edges;
   fill_bare_implicit_edges(geom, bare_implicit_edges);
 
   map<vector<int>, vector<int>> faces_by_edge;
@@ -5164,7 +5118,7 @@ void ncon_edge_coloring_from_faces(Geometry &geom, const ncon_opts &opts)
 
 // mark edge circuits for methods 2 and 3 color by adjacent edge
 // also for method 1, color by symmetry
-void mark_edge_circuits(Geometry &geom, const vector<edgeList *> &edge_list)
+void mark_edge_circuits(Geometry &geom, const pooledList<edgeList> &edge_list)
 {
   for (auto i : edge_list) {
     int j = i->edge_no;
@@ -5175,7 +5129,7 @@ void mark_edge_circuits(Geometry &geom, const vector<edgeList *> &edge_list)
 
 // for method 2, if indented edges are not shown, overwrite them as invisible
 void set_indented_edges_invisible(Geometry &geom,
-                                  const vector<edgeList *> &edge_list,
+                                  const pooledList<edgeList> &edge_list,
                                   const vector<poleList *> &pole)
 {
   for (auto i : edge_list) {
@@ -5313,8 +5267,8 @@ void build_color_table(map<int, pair<int, int>> &color_table,
 }
 
 // point_cut is not that of opts
-void ncon_coloring(Geometry &geom, const vector<faceList *> &face_list,
-                   const vector<edgeList *> &edge_list,
+void ncon_coloring(Geometry &geom, const pooledList<faceList> &face_list,
+                   const pooledList<edgeList> &edge_list,
                    const vector<poleList *> &pole, const bool point_cut_calc,
                    const int lat_mode, const ncon_opts &opts)
 {
@@ -5431,9 +5385,10 @@ void ncon_coloring(Geometry &geom, const vector<faceList *> &face_list,
 // inner_radius and outer_radius is calculated within
 // double sweep is set in build_globe()
 // radius_inversion is set
-void build_globe(Geometry &geom, vector<coordList *> &coordinates,
-                 vector<faceList *> &face_list, vector<edgeList *> &edge_list,
-                 vector<poleList *> &pole, vector<int> &caps,
+void build_globe(Geometry &geom, pooledList<coordList> &coordinates,
+                 pooledList<faceList> &face_list,
+                 pooledList<edgeList> &edge_list, vector<poleList *> &pole,
+                 vector<int> &caps,
                  double &inner_radius, double &outer_radius,
                  bool &radius_inversion, bool &double_sweep,
                  const bool second_half, const ncon_opts &opts)
@@ -5574,8 +5529,8 @@ double hybrid_twist_angle(const ncon_opts &opts)
 }
 
 // if partial model, delete appropriate elements
-void delete_unused_longitudes(Geometry &geom, vector<faceList *> &face_list,
-                              vector<edgeList *> &edge_list,
+void delete_unused_longitudes(Geometry &geom, pooledList<faceList> &face_list,
+                              pooledList<edgeList> &edge_list,
                               const vector<int> &caps, const bool opposite,
                               const bool del_override, const ncon_opts &opts)
 {
@@ -5596,6 +5551,7 @@ void delete_unused_longitudes(Geometry &geom, vector<faceList *> &face_list,
       if (lon < opts.longitudes.front() / 2)
         face_list[cap]->lon = -1;
     }
+    face_list.reindex();
   }
 
   vector<int> delete_list;
@@ -5612,7 +5568,7 @@ void delete_unused_longitudes(Geometry &geom, vector<faceList *> &face_list,
 
   if (delete_list.size()) {
     if (!longitudes_inv) {
-      delete_face_list_items(face_list, delete_list);
+      face_list.remove(delete_list);
       geom.del(FACES, delete_elem);
     }
     else {
@@ -5636,7 +5592,7 @@ void delete_unused_longitudes(Geometry &geom, vector<faceList *> &face_list,
 
   if (delete_list.size()) {
     if (!longitudes_inv) {
-      delete_edge_list_items(edge_list, delete_list);
+      edge_list.remove(delete_list);
       geom.del(EDGES, delete_elem);
     }
     else {
@@ -5720,14 +5676,15 @@ void add_triangles_to_close(Geometry &geom, vector<int> &added_triangles,
 // hybrids lose opts.longitudes.front()/2-1 from the edge_list
 // be able to back it up and restore it using color elements that are carried
 // along with them
-void backup_flood_longitude_edges(Geometry &geom, vector<edgeList *> &edge_list,
+void backup_flood_longitude_edges(Geometry &geom,
+                                  pooledList<edgeList> &edge_list,
                                   const ncon_opts &opts)
 {
   int lat = 1;
   int lon = opts.longitudes.front() / 2 - 1;
   unsigned int sz = 0;
   do {
-    vector<int> idx = find_edge_by_lat_lon(edge_list, lat, lon);
+    const vector<int> &idx = edge_list.find(lat, lon);
     sz = idx.size();
     for (unsigned int j = 0; j < sz; j++)
       geom.colors(EDGES).set(idx[j], Color(lat));
@@ -5737,7 +5694,7 @@ void backup_flood_longitude_edges(Geometry &geom, vector<edgeList *> &edge_list,
 
 // after restore, change color index to INT_MAX for flood fill procedure
 void restore_flood_longitude_edges(Geometry &geom,
-                                   vector<edgeList *> &edge_list,
+                                   pooledList<edgeList> &edge_list,
                                    const ncon_opts &opts)
 {
   const vector<vector<int>> &edges = geom.edges();
@@ -5745,21 +5702,21 @@ void restore_flood_longitude_edges(Geometry &geom,
   for (unsigned int i = 0; i < edges.size(); i++) {
     Color c = geom.colors(EDGES).get(i);
     if (!c.is_maximum_index() && !c.is_invisible()) {
-      edge_list.push_back(
-          new edgeList(i, c.get_index(), opts.longitudes.front() / 2 - 1));
+      edge_list.add(i, c.get_index(), opts.longitudes.front() / 2 - 1);
       geom.colors(EDGES).set(i, Color::maximum_index);
     }
   }
 }
 
-void backup_flood_longitude_faces(Geometry &geom, vector<faceList *> &face_list,
+void backup_flood_longitude_faces(Geometry &geom,
+                                  pooledList<faceList> &face_list,
                                   const ncon_opts &opts)
 {
   int lat = 0;
   int lon = opts.longitudes.front() / 2 - 1;
   unsigned int sz = 0;
   do {
-    vector<int> idx = find_face_by_lat_lon(face_list, lat, lon);
+    const vector<int> &idx = face_list.find(lat, lon);
     sz = idx.size();
     for (unsigned int j = 0; j < sz; j++)
       geom.colors(FACES).set(idx[j], Color(lat));
@@ -5769,7 +5726,7 @@ void backup_flood_longitude_faces(Geometry &geom, vector<faceList *> &face_list,
 
 // after restore, unset face color
 void restore_flood_longitude_faces(Geometry &geom,
-                                   vector<faceList *> &face_list,
+                                   pooledList<faceList> &face_list,
                                    const ncon_opts &opts)
 {
   const vector<vector<int>> &faces = geom.faces();
@@ -5777,8 +5734,7 @@ void restore_flood_longitude_faces(Geometry &geom,
   for (unsigned int i = 0; i < faces.size(); i++) {
     if (geom.colors(FACES).get(i).is_index()) {
       int j = geom.colors(FACES).get(i).get_index();
-      face_list.push_back(
-          new faceList(i, j, opts.longitudes.front() / 2 - 1, 0));
+      face_list.add(i, j, opts.longitudes.front() / 2 - 1, 0);
       geom.colors(FACES).set(i, Color());
     }
   }
@@ -5886,7 +5842,8 @@ void build_compound_polygon(vector<Geometry> &polar_polygons,
 }
 
 // geom copy
-Geometry find_polar_polygon(Geometry geom, const vector<faceList *> &face_list,
+Geometry find_polar_polygon(Geometry geom,
+                            const pooledList<faceList> &face_list,
                             const ncon_opts &opts)
 {
   const vector<vector<int>> &edges = geom.edges();
@@ -6079,12 +6036,13 @@ void ncon_face_coloring_by_compound(Geometry &geom,
       // need to filter out invisible edges
       // Coloring clrng(&geom);
       // clrng.f_from_adjacent(EDGES);
+      map<vector<int>, int> edge_idx = make_edge_index(geom.edges());
       for (unsigned int i = 0; i < geom.faces().size(); i++) {
         vector<int> face = geom.faces(i);
         unsigned int sz = face.size();
         for (unsigned int j = 0; j < sz; j++) {
           vector<int> edge = make_edge(face[j], face[(j + 1) % sz]);
-          int edge_no = find_edge_in_edge_list(geom.edges(), edge);
+          int edge_no = find_edge_in_edge_index(edge_idx, edge);
           Color c = geom.colors(EDGES).get(edge_no);
           if ((edge_no != -1) && !c.is_invisible()) {
             geom.colors(FACES).set(i, c);
@@ -6190,9 +6148,9 @@ int process_hybrid(Geometry &geom, ncon_opts &opts)
   int longitudes_back = opts.longitudes.back();
 
   // attributes of elements
-  vector<coordList *> coordinates;
-  vector<faceList *> face_list;
-  vector<edgeList *> edge_list;
+  pooledList<coordList> coordinates;
+  pooledList<faceList> face_list;
+  pooledList<edgeList> edge_list;
 
   // create memory for poles 0 - North Pole 1 - South Pole
   vector<poleList *> pole;
@@ -6242,9 +6200,9 @@ int process_hybrid(Geometry &geom, ncon_opts &opts)
     backup_flood_longitude_edges(geom_d, edge_list, opts);
 
   // start over. build base part second, then rotate it
-  clear_coord(coordinates);
-  clear_faces(face_list);
-  clear_edges(edge_list);
+  coordinates.clear();
+  face_list.clear();
+  edge_list.clear();
 
   caps.clear();
 
@@ -6332,9 +6290,9 @@ int process_hybrid(Geometry &geom, ncon_opts &opts)
   caps.clear();
 
   // clean up
-  clear_coord(coordinates);
-  clear_faces(face_list);
-  clear_edges(edge_list);
+  coordinates.clear();
+  face_list.clear();
+  edge_list.clear();
 
   return ret;
 }
@@ -6344,9 +6302,9 @@ int process_normal(Geometry &geom, ncon_opts &opts)
 {
   int ret = 0;
 
-  vector<coordList *> coordinates;
-  vector<faceList *> face_list;
-  vector<edgeList *> edge_list;
+  pooledList<coordList> coordinates;
+  pooledList<faceList> face_list;
+  pooledList<edgeList> edge_list;
 
   // create memory for poles 0 - North Pole 1 - South Pole
   vector<poleList *> pole;
@@ -6440,9 +6398,9 @@ int process_normal(Geometry &geom, ncon_opts &opts)
   caps.clear();
 
   // clean up
-  clear_coord(coordinates);
-  clear_faces(face_list);
-  clear_edges(edge_list);
+  coordinates.clear();
+  face_list.clear();
+  edge_list.clear();
 
   return ret;
 }
@@ -7009,12 +6967,13 @@ void color_by_symmetry(Geometry &geom, Geometry &pgon, const ncon_opts &opts)
       // need to filter out invisible edges
       // Coloring clrng(&geom);
       // clrng.f_from_adjacent(EDGES);
+      map<vector<int>, int> edge_idx = make_edge_index(geom.edges());
       for (unsigned int i = 0; i < geom.faces().size(); i++) {
         vector<int> face = geom.faces(i);
         unsigned int sz = face.size();
         for (unsigned int j = 0; j < sz; j++) {
           vector<int> edge = make_edge(face[j], face[(j + 1) % sz]);
-          int edge_no = find_edge_in_edge_list(geom.edges(), edge);
+          int edge_no = find_edge_in_edge_index(edge_idx, edge);
           Color c = geom.colors(EDGES).get(edge_no);
           if ((edge_no != -1) && !c.is_invisible()) {
             geom.colors(FACES).set(i, c);
@@ -7179,6 +7138,112 @@ int ncon_subsystem(Geometry &geom, ncon_opts &opts)
   return ret;
 }
 
+// survey the twists of one order of n-icon, returning the report line(s)
+string survey_order(const ncon_opts &opts, const int ncon_order,
+                    const char form, const int d, int &hit_count,
+                    int &model_count)
+{
+  string row;
+  char name[64];
+  char line[128];
+
+  bool point_cut = false;
+  bool hybrid = false;
+  bool info = false;
+
+  if (form == 'p' || form == 'o')
+    point_cut = true;
+  else if (form == 's')
+    point_cut = false;
+  else
+    hybrid = true;
+
+  // last twist
+  int last = (int)floor((double)ncon_order / ((!is_even(ncon_order)) ? 2 : 4));
+  if (hybrid)
+    last++;
+
+  bool none = true;
+
+  const char *order_fmt = (opts.long_form) ? "%-5d: " : "%d: ";
+  snprintf(line, sizeof(line), order_fmt, ncon_order);
+  row += line;
+
+  surfaceData sd;
+
+  int twist = (hybrid) ? 1 : 0;
+  for (; twist <= last; twist++) {
+    //  need list entry but...
+    //  now that d>1 is allowed must not allow n/0
+    if (!(d % ncon_order))
+      continue;
+    // don't allow d>n
+    if (d > ncon_order)
+      continue;
+
+    ncon_info(ncon_order, d, point_cut, twist, hybrid, info, sd);
+
+    if (opts.list_compounds) {
+      // bypass digon cases
+      if (ncon_order == 2 * d)
+        continue;
+
+      // compounds have to have more than one surface
+      // compounds can't have more parts than surfaces
+      if (sd.total_surfaces < opts.filter_surfaces.front())
+        continue;
+      model_count++;
+    }
+
+    const int cnt =
+        (!opts.list_compounds) ? sd.total_surfaces : sd.compound_parts;
+    if (cnt < opts.filter_surfaces.front() ||
+        cnt > opts.filter_surfaces.back())
+      continue;
+    if (!opts.list_compounds && sd.case2 && opts.filter_case2)
+      continue;
+
+    if (!none) {
+      if (opts.long_form) {
+        snprintf(line, sizeof(line), "%-5d: ", ncon_order);
+        row += line;
+      }
+      else
+        row += ", ";
+    }
+    const char *brackets = (sd.nonchiral) ? "[]" : (sd.case2) ? "{}" : "()";
+    if (d > 1)
+      snprintf(name, sizeof(name), "%c%d/%d+%d%c", brackets[0], ncon_order, d,
+               twist, brackets[1]);
+    else
+      snprintf(name, sizeof(name), "%c%d+%d%c", brackets[0], ncon_order,
+               twist, brackets[1]);
+    if (!opts.long_form)
+      row += name;
+    else {
+      if (!opts.list_compounds)
+        snprintf(line, sizeof(line), "%-15s %5d %10d %13d %10d %13d\n", name,
+                 sd.total_surfaces, sd.c_surfaces, sd.d_surfaces, sd.c_edges,
+                 sd.d_edges);
+      else
+        snprintf(line, sizeof(line), "%-15s %5d %19d\n", name,
+                 sd.compound_parts, sd.total_surfaces);
+      row += line;
+    }
+    none = false;
+    hit_count++;
+  }
+
+  if (none) {
+    row += "none";
+    if (opts.long_form)
+      row += "\n";
+  }
+  row += "\n";
+
+  return row;
+}
+
 void surface_subsystem(ncon_opts &opts)
 {
   int d = opts.list_d;
@@ -7322,145 +7387,36 @@ void surface_subsystem(ncon_opts &opts)
     }
   }
 
-  int hit_count = 0;
-  int model_count = 0;
-
-  int last = 0;
+  // the orders are independent, so each block of orders is surveyed in
+  // parallel and then printed in order. A block is limited by the number
+  // of twists, which sets the size of the report text held for it.
+  vector<int> orders;
   for (int ncon_order = ncon_range.front(); ncon_order <= ncon_range.back();
-       ncon_order += inc) {
-    // fprintf(stderr,"n = %d\n", ncon_order);
-
-    bool point_cut = false;
-    bool hybrid = false;
-    bool info = false;
-
-    if (form == 'p' || form == 'o')
-      point_cut = true;
-    else if (form == 's')
-      point_cut = false;
-    else
-      hybrid = true;
-
-    // last twist
-    last = (int)floor((double)ncon_order / ((!is_even(ncon_order)) ? 2 : 4));
-    if (hybrid)
-      last++;
-
-    bool none = true;
+       ncon_order += inc)
+    orders.push_back(ncon_order);
 
-    if (opts.long_form)
-      fprintf(stdout, "%-5d: ", ncon_order);
-    else
-      fprintf(stdout, "%d: ", ncon_order);
-
-    surfaceData sd;
-
-    int twist = (hybrid) ? 1 : 0;
-    for (; twist <= last; twist++) {
-      // fprintf(stderr,"twist = %d\n", twist);
-      //  need list entry but...
-      //  now that d>1 is allowed must not allow n/0
-      if (!(d % ncon_order))
-        continue;
-      // don't allow d>n
-      if (d > ncon_order)
-        continue;
-
-      ncon_info(ncon_order, d, point_cut, twist, hybrid, info, sd);
-
-      if (opts.list_compounds) {
-        // bypass digon cases
-        if (ncon_order == 2 * d)
-          continue;
-
-        // compounds have to have more than one surface
-        // compounds can't have more parts than surfaces
-        if (sd.total_surfaces < opts.filter_surfaces.front())
-          continue;
-        /*
-                // if hybrids of d mod 4 still has errors use direct measures
-                opts.ncon_order = ncon_order;
-                opts.twist = twist;
-                opts.point_cut = point_cut;
-                opts.hybrid = hybrid;
-
-                // epsilon lowered for large models, reset for each run
-                opts.eps = opts.list_eps;
-
-                Geometry geom;
-                // if (hybrid && (d % 4 == 0))
-                sd.compound_parts = ncon_subsystem(geom, opts);
-        */
-        model_count++;
-      }
-
-      string d_part = ((d > 1) ? "/" : "") + ((d > 1) ? std::to_string(d) : "");
-      if (!opts.list_compounds) {
-        if ((sd.total_surfaces >= opts.filter_surfaces.front()) &&
-            (sd.total_surfaces <= opts.filter_surfaces.back())) {
-          if (!sd.case2 || (sd.case2 && !opts.filter_case2)) {
-            if (!none) {
-              if (opts.long_form)
-                fprintf(stdout, "%-5d: ", ncon_order);
-              else
-                fprintf(stdout, ", ");
-            }
-            if (sd.nonchiral)
-              buffer = "[" + std::to_string(ncon_order) + d_part + "+" +
-                       std::to_string(twist) + "]";
-            else if (sd.case2)
-              buffer = "{" + std::to_string(ncon_order) + d_part + "+" +
-                       std::to_string(twist) + "}";
-            else
-              buffer = "(" + std::to_string(ncon_order) + d_part + "+" +
-                       std::to_string(twist) + ")";
-            if (opts.long_form)
-              fprintf(stdout, "%-15s %5d %10d %13d %10d %13d\n", buffer.c_str(),
-                      sd.total_surfaces, sd.c_surfaces, sd.d_surfaces,
-                      sd.c_edges, sd.d_edges);
-            else
-              fprintf(stdout, "%s", buffer.c_str());
-            none = false;
-            hit_count++;
-          }
-        }
-      }
-      else {
-        if ((sd.compound_parts >= opts.filter_surfaces.front()) &&
-            (sd.compound_parts <= opts.filter_surfaces.back())) {
-          if (!none) {
-            if (opts.long_form)
-              fprintf(stdout, "%-5d: ", ncon_order);
-            else
-              fprintf(stdout, ", ");
-          }
-          if (sd.nonchiral)
-            buffer = "[" + std::to_string(ncon_order) + d_part + "+" +
-                     std::to_string(twist) + "]";
-          else if (sd.case2)
-            buffer = "{" + std::to_string(ncon_order) + d_part + "+" +
-                     std::to_string(twist) + "}";
-          else
-            buffer = "(" + std::to_string(ncon_order) + d_part + "+" +
-                     std::to_string(twist) + ")";
-          if (opts.long_form) {
-            fprintf(stdout, "%-15s %5d %19d\n", buffer.c_str(),
-                    sd.compound_parts, sd.total_surfaces);
-          }
-          else
-            fprintf(stdout, "%s", buffer.c_str());
-          none = false;
-          hit_count++;
-        }
-      }
-    }
-
-    if (none) {
-      fprintf(stdout, "none");
-      if (opts.long_form)
-        fprintf(stdout, "\n");
-    }
-    fprintf(stdout, "\n");
+  int hit_count = 0;
+  int model_count = 0;
+  const long block_twists = 1 << 16;
+  for (size_t start = 0; start < orders.size();) {
+    size_t end = start;
+    long twists = 0;
+    while (end < orders.size() && (end == start || twists < block_twists))
+      twists += orders[end++] / 2 + 1;
+    const size_t num = end - start;
+    vector<string> rows(num);
+    vector<int> hits(num, 0);
+    vector<int> models(num, 0);
+    parallel_for(num, [&](size_t i) {
+      rows[i] = survey_order(opts, orders[start + i], form, d, hits[i],
+                             models[i]);
+    });
+    for (size_t i = 0; i < num; i++) {
+      fputs(rows[i].c_str(), stdout);
+      hit_count += hits[i];
+      model_count += models[i];
+    }
+    start = end;
   }
 
   fprintf(
@@ -31,6 +31,11 @@
 #ifndef NCONS_H
 #define NCONS_H
 
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
 class coordList {
 public:
   int coord_no;
@@ -85,6 +90,107 @@ public:
   polarOrb(int c) : coord_no(c) {}
 };
 
+// Elements are held in a pool, which does not move them as it grows, and
+// listed in order by pointer. Elements with a latitude and longitude can
+// be found through an index on these. The index follows elements being
+// added and removed, but reindex() must be called after writing the
+// latitude or longitude of an element.
+template <typename T> class pooledList {
+private:
+  std::deque<T> pool;
+  std::vector<T *> items;
+  mutable std::unordered_map<long long, std::vector<int>> lat_lon_idx;
+  mutable bool idx_valid = false;
+
+  static long long lat_lon_key(int lat, int lon)
+  {
+    return ((long long)lat << 32) + (unsigned int)lon;
+  }
+
+public:
+  // iterate as pointers to const elements
+  class const_iterator {
+  private:
+    typename std::vector<T *>::const_iterator it;
+
+  public:
+    explicit const_iterator(typename std::vector<T *>::const_iterator i)
+        : it(i)
+    {
+    }
+    const T *operator*() const { return *it; }
+    const_iterator &operator++()
+    {
+      ++it;
+      return *this;
+    }
+    bool operator!=(const const_iterator &other) const
+    {
+      return it != other.it;
+    }
+  };
+
+  template <typename... Args> T *add(Args &&...args)
+  {
+    pool.emplace_back(std::forward<Args>(args)...);
+    items.push_back(&pool.back());
+    idx_valid = false;
+    return items.back();
+  }
+
+  size_t size() const { return items.size(); }
+
+  T *operator[](size_t i) { return items[i]; }
+  const T *operator[](size_t i) const { return items[i]; }
+
+  T *back() { return items.back(); }
+  const T *back() const { return items.back(); }
+
+  typename std::vector<T *>::iterator begin() { return items.begin(); }
+  typename std::vector<T *>::iterator end() { return items.end(); }
+  const_iterator begin() const { return const_iterator(items.begin()); }
+  const_iterator end() const { return const_iterator(items.end()); }
+
+  void clear()
+  {
+    items.clear();
+    pool.clear();
+    idx_valid = false;
+  }
+
+  // remove elements from the list, by list index
+  void remove(std::vector<int> idxs)
+  {
+    std::sort(idxs.begin(), idxs.end());
+    unsigned int del_cnt = 0;
+    for (unsigned int i = 0; i < items.size(); i++) {
+      if (del_cnt < idxs.size() && (int)i == idxs[del_cnt])
+        del_cnt++;
+      else
+        items[i - del_cnt] = items[i];
+    }
+    items.resize(items.size() - del_cnt);
+    idx_valid = false;
+  }
+
+  // rebuild the latitude and longitude index when it is next used
+  void reindex() { idx_valid = false; }
+
+  // list indexes of the elements at a latitude and longitude, in order
+  const std::vector<int> &find(int lat, int lon) const
+  {
+    static const std::vector<int> none;
+    if (!idx_valid) {
+      lat_lon_idx.clear();
+      for (unsigned int i = 0; i < items.size(); i++)
+        lat_lon_idx[lat_lon_key(items[i]->lat, items[i]->lon)].push_back(i);
+      idx_valid = true;
+    }
+    auto it = lat_lon_idx.find(lat_lon_key(lat, lon));
+    return (it != lat_lon_idx.end()) ? it->second : none;
+  }
+};
+
 struct surfaceData {
   int c_surfaces;
   int c_edges;
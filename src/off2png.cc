@@ -0,0 +1,182 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/* \file off2png.cc
+   \brief Render OFF files to a PNG or PPM image
+*/
+
+#include "../base/antiprism.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using namespace anti;
+
+class o2i_opts : public ViewOpts {
+public:
+  int width;
+  int height;
+  int samples;
+  bool persp;
+  string format;
+
+  string ofile;
+
+  o2i_opts()
+      : ViewOpts("off2png"), width(400), height(400), samples(2),
+        persp(true)
+  {
+  }
+
+  void process_command_line(int argc, char **argv);
+  void usage();
+};
+
+void o2i_opts::usage()
+{
+  fprintf(stdout, R"(
+Usage: %s [options] input_files
+
+Render files in OFF format to a PNG or PPM image, without needing
+OpenGL or POV-Ray. If input_files are not given the program reads
+from standard input. The view is the same as the initial antiview view.
+Number labels are not drawn.
+
+Options
+%s
+%s
+  -f <fmt>  image format: png, ppm (default: from the output file
+            extension, otherwise png)
+  -z <size> image size in pixels, in form 'width,height', or a single
+            value for a square image (default: 400)
+  -a <num>  antialias, number of samples along the side of each pixel
+            (default: 2, 1 for no antialiasing)
+  -o <file> write output to file (default: write to standard output)
+
+  Scene options
+%s
+  -P        use a parallel projection (default: perspective)
+
+)",
+          prog_name(), help_ver_text, help_view_text, help_scene_text);
+}
+
+void o2i_opts::process_command_line(int argc, char **argv)
+{
+  Status stat;
+  opterr = 0;
+  int c;
+  vector<int> nums;
+
+  handle_long_opts(argc, argv);
+
+  while ((c = getopt(argc, argv,
+                     ":hv:e:V:E:F:m:x:s:n:o:D:C:L:R:B:t:I:f:z:a:P")) != -1) {
+    if (common_opts(c, optopt))
+      continue;
+
+    switch (c) {
+    case 'o':
+      ofile = optarg;
+      break;
+
+    case 'f':
+      if (strcmp(optarg, "png") != 0 && strcmp(optarg, "ppm") != 0)
+        error("image format must be png or ppm", c);
+      format = optarg;
+      break;
+
+    case 'z':
+      print_status_or_exit(read_int_list(optarg, nums, true, 2), c);
+      width = nums[0];
+      height = (nums.size() > 1) ? nums[1] : nums[0];
+      if (width < 1 || height < 1)
+        error("image width and height must be positive", c);
+      break;
+
+    case 'a':
+      print_status_or_exit(read_int(optarg, &samples), c);
+      if (samples < 1 || samples > 8)
+        error("number of samples must be between 1 and 8", c);
+      break;
+
+    case 'P':
+      persp = false;
+      break;
+
+    default:
+      if (!(stat = read_disp_option(c, optarg))) {
+        if (stat.is_warning())
+          warning(stat.msg(), c);
+        else
+          error(stat.msg(), c);
+      }
+    }
+  }
+
+  if (argc - optind >= 1)
+    while (argc - optind >= 1)
+      ifiles.push_back(argv[optind++]);
+  else
+    ifiles.push_back("");
+
+  if (format == "") {
+    size_t len = ofile.size();
+    format = (len > 4 && ofile.compare(len - 4, 4, ".ppm") == 0) ? "ppm"
+                                                                   : "png";
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  o2i_opts opts;
+  opts.process_command_line(argc, argv);
+  Scene scen = opts.scen_defs;
+  opts.set_view_vals(scen);
+
+  RasterWriter rast(opts.width, opts.height);
+  rast.set_samples(opts.samples);
+  rast.set_persp(opts.persp);
+  rast.render(scen);
+
+  FILE *ofile = stdout; // write to stdout by default
+  if (opts.ofile != "") {
+    ofile = fopen(opts.ofile.c_str(), "wb");
+    if (ofile == nullptr)
+      opts.error("could not open output file \'" + opts.ofile + "\'");
+  }
+
+  Status stat =
+      (opts.format == "ppm") ? rast.write_ppm(ofile) : rast.write_png(ofile);
+  if (opts.ofile != "")
+    fclose(ofile);
+  if (!stat)
+    opts.error(stat.msg());
+
+  return 0;
+}
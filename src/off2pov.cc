@@ -78,6 +78,9 @@ Options
   -j <fils> include files (separated by commas) for the POV scene file
   -J <fils> include files (separated by commas) containing additional POV
             objects for the POV scene file
+  -g        group vertex and edge elements by colour, each group is a union
+            sharing one texture, making smaller files for large models
+            (disp_vertex and disp_edge are not used)
   -o <file> write output to file (default: write to standard output)
 
   Scene options
@@ -105,9 +108,9 @@ void o2p_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv,
-                     ":hv:e:V:E:F:m:x:s:n:o:D:C:L:R:P:W:S:B:d:t:I:j:J:i:O:")) !=
-         -1) {
+  while ((c = getopt(
+              argc, argv,
+              ":hv:e:V:E:F:m:x:s:n:go:D:C:L:R:P:W:S:B:d:t:I:j:J:i:O:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -120,6 +123,10 @@ void o2p_opts::process_command_line(int argc, char **argv)
       shadow = true;
       break;
 
+    case 'g':
+      get_geom_defs().set_instanced(true);
+      break;
+
     case 'S':
       print_status_or_exit(read_int(optarg, &stereo_type), c);
       if (stereo_type < 0 || stereo_type > 3)
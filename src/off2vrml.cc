@@ -63,6 +63,8 @@ Options
 %s
 %s
   -l        use lines for edges, points for vertices, in default colours
+  -g        group vertex and edge elements by colour, each group shares a
+            single shape, making smaller files for large models
   -o <file> write output to file (default: write to standard output)
 
   Scene options
@@ -85,7 +87,7 @@ void o2v_opts::process_command_line(int argc, char **argv)
   handle_long_opts(argc, argv);
 
   while ((c = getopt(argc, argv,
-                     ":hv:e:V:E:F:m:x:n:s:lo:D:C:L:R:P:I:B:d:t:")) != -1) {
+                     ":hv:e:V:E:F:m:x:n:s:lgo:D:C:L:R:P:I:B:d:t:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -98,6 +100,10 @@ void o2v_opts::process_command_line(int argc, char **argv)
       get_geom_defs().set_use_lines(true);
       break;
 
+    case 'g':
+      get_geom_defs().set_instanced(true);
+      break;
+
     case 'd':
       print_status_or_exit(read_int(optarg, &sig_dgts), c);
       if (sig_dgts < 1)
@@ -687,66 +687,81 @@ void find_fronts_from_list(map<int, vector<int>> &fronts, const Geometry &geom,
   }
 }
 
+// faces around each vertex, in compressed form: the faces of vertex v are
+// v_faces[v_offs[v]] up to, but not including, v_faces[v_offs[v + 1]]
+void vert_faces_index(const Geometry &geom, vector<int> &v_offs,
+                      vector<int> &v_faces)
+{
+  v_offs.assign(geom.verts().size() + 1, 0);
+  for (const auto &face : geom.faces())
+    for (int v : face)
+      v_offs[v + 1]++;
+  for (unsigned int v = 0; v < geom.verts().size(); v++)
+    v_offs[v + 1] += v_offs[v];
+
+  v_faces.resize(v_offs.back());
+  vector<int> pos(v_offs.begin(), v_offs.end() - 1);
+  for (unsigned int i = 0; i < geom.faces().size(); i++)
+    for (int v : geom.faces(i))
+      v_faces[pos[v]++] = i;
+}
+
 // color with map indexes
 void radial_coloring(Geometry &geom, map<int, vector<int>> &fronts)
 {
   // clear all colors
   geom.colors(FACES).clear();
 
+  vector<int> v_offs;
+  vector<int> v_faces;
+  vert_faces_index(geom, v_offs, v_faces);
+
+  // ridge number of each face, or -1 if not colored yet
+  const unsigned int fsz = geom.faces().size();
+  vector<int> f_ridge(fsz, -1);
+  // the last front step that each face was added to a next ridge in
+  vector<int> f_step(fsz, -1);
+  int step = 0;
+
   int ridge = 0;
   bool found = true;
 
   while (found) {
     found = false;
     // starting from each radial point
-    for (auto const &key1 : fronts) {
-      vector<int> front = fronts[key1.first];
-      vector<int> next_ridge;
-      vector<int> adjacent_faces;
-
-      for (unsigned int i = 0; i < front.size(); i++) {
-        // color faces in radial ridge with indexes
-        // it can be set in one final ridge but still listed in another so check
-        if (!(geom.colors(FACES).get(front[i])).is_set())
-          geom.colors(FACES).set(front[i], ridge);
-
-        // get faces connected to this face via edge or vertex
-        vector<int> face_idx;
-        vector<int> face = geom.faces()[front[i]];
-        unsigned int fsz = face.size();
-        for (unsigned int j = 0; j < fsz; j++) {
-          int v1 = face[j];
-          int v2 = face[(j + 1) % fsz];
-          // face_idx = find_faces_with_edge(geom.faces(), make_edge(v1, v2));
-          // adjacent_faces.insert(adjacent_faces.end(), face_idx.begin(),
-          //                      face_idx.end());
-          face_idx = find_faces_with_vertex(geom.faces(), v1);
-          adjacent_faces.insert(adjacent_faces.end(), face_idx.begin(),
-                                face_idx.end());
-          face_idx = find_faces_with_vertex(geom.faces(), v2);
-          adjacent_faces.insert(adjacent_faces.end(), face_idx.begin(),
-                                face_idx.end());
-        }
-      }
+    for (auto &key1 : fronts) {
+      vector<int> &front = key1.second;
 
-      // make list unique
-      sort(adjacent_faces.begin(), adjacent_faces.end());
-      auto vi = unique(adjacent_faces.begin(), adjacent_faces.end());
-      adjacent_faces.resize(vi - adjacent_faces.begin());
+      // color faces in radial ridge with indexes
+      // it can be set in one final ridge but still listed in another so check
+      for (int f_idx : front)
+        if (f_ridge[f_idx] < 0)
+          f_ridge[f_idx] = ridge;
 
-      // find next ridge of faces not yet colored
-      for (unsigned int i = 0; i < adjacent_faces.size(); i++) {
-        if (!(geom.colors(FACES).get(adjacent_faces[i])).is_set()) {
-          next_ridge.push_back(adjacent_faces[i]);
-        }
-      }
-      fronts[key1.first] = next_ridge;
+      // find next ridge of faces not yet colored, connected to faces of
+      // this ridge via edge or vertex
+      vector<int> next_ridge;
+      for (int f_idx : front)
+        for (int v : geom.faces(f_idx))
+          for (int i = v_offs[v]; i < v_offs[v + 1]; i++) {
+            const int adj = v_faces[i];
+            if (f_ridge[adj] < 0 && f_step[adj] != step) {
+              f_step[adj] = step;
+              next_ridge.push_back(adj);
+            }
+          }
+      step++;
+      front.swap(next_ridge);
 
-      if (next_ridge.size())
+      if (front.size())
         found = true;
     }
     ridge++;
   }
+
+  for (unsigned int i = 0; i < fsz; i++)
+    if (f_ridge[i] >= 0)
+      geom.colors(FACES).set(i, f_ridge[i]);
 }
 
 // break down model into parts
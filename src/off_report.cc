@@ -86,6 +86,7 @@ Options
             F - faces                   E - edges
             S - solid angles            a - plane angles
             D - distances (min/max)     s - symmetry
+            i - face intersections
   -C <vals> Print counts of values, given as a list of letters
             A - all                     F - faces type by angles
             E - edge lengths            w - windings
@@ -126,7 +127,7 @@ void or_opts::process_command_line(int argc, char **argv)
       break;
 
     case 'S': {
-      const char *all_section_letters = "AGFEaSsD";
+      const char *all_section_letters = "AGFEaSsDi";
       size_t len;
       if ((len = strspn(optarg, all_section_letters)) == strlen(optarg)) {
         if (strchr(optarg, 'A'))
@@ -236,6 +237,9 @@ void print_sections(rep_printer &rep, const char *sections)
     case 's':
       rep.symmetry();
       break;
+    case 'i':
+      rep.intersections_sec();
+      break;
     }
   }
 }
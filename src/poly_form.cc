@@ -30,6 +30,7 @@
 
 #include "../base/antiprism.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstdlib>
@@ -114,6 +115,10 @@ Options
             check) (0 for final report only, -1 for no report), optionally
             followed by a comma and the number of iterations between
             termination checks (0 for report checks only) (default: %d,%d)
+  -R <file> write progress records to file on status reports, as CSV if
+            the name ends in .csv, otherwise as JSON lines
+  -K <file> write a checkpoint to file on status reports, to resume from
+  -U <file> resume from a checkpoint file, using the same input and options
   -o <file> write output to file (default: write to standard output)
 
 )",
@@ -132,11 +137,23 @@ void pf_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hn:s:l:k:f:a:yE:z:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":hn:s:l:k:f:a:yE:z:R:K:U:o:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
     switch (c) {
+    case 'R':
+      print_status_or_exit(it_ctrl.set_record_file(optarg), c);
+      break;
+
+    case 'K':
+      print_status_or_exit(it_ctrl.set_checkpoint_file(optarg), c);
+      break;
+
+    case 'U':
+      print_status_or_exit(it_ctrl.set_resume_file(optarg), c);
+      break;
+
     case 'o':
       ofile = optarg;
       break;
@@ -200,6 +217,12 @@ void pf_opts::process_command_line(int argc, char **argv)
     }
   }
 
+  if (!it_ctrl.get_checkpoint_file().empty() &&
+      it_ctrl.get_status_check_and_report_iters() <= 0)
+    warning("checkpoints are only written on status reports, which are "
+            "turned off by -z",
+            'K');
+
   // Default algorithm is 'e', but if unscrambling it is 'u'
   if (!algm)
     algm = 'r';
@@ -284,6 +307,7 @@ Status make_unscramble(Geometry &geom, IterationControl it_ctrl,
                        double shorten_factor, Vec4d ellipsoid,
                        bool with_initial_placement)
 {
+  ANTI_PROFILE_SCOPE("solve: unscramble");
   if (with_initial_placement)
     to_initial_unscramble(geom, ellipsoid);
 
@@ -295,6 +319,10 @@ Status make_unscramble(Geometry &geom, IterationControl it_ctrl,
 
   double g_max_dist = 0;
   double g_min_dist = 1e100;
+  Status stat = it_ctrl.resume(geom.raw_verts());
+  if (stat.is_error())
+    return stat;
+
   for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
     g_max_dist = 0;
     g_min_dist = 1e100;
@@ -325,8 +353,10 @@ Status make_unscramble(Geometry &geom, IterationControl it_ctrl,
       to_ellipsoid(geom.verts(p0), ellipsoid);
     }
 
-    // no status checks
-    // if (it_ctrl.is_status_check_iter()) { ; }
+    // no status checks, only progress records
+    if (it_ctrl.is_status_check_iter())
+      it_ctrl.record(sqrt(g_max_dist) - sqrt(g_min_dist),
+                     {{"max", sqrt(g_max_dist)}, {"min", sqrt(g_min_dist)}});
 
     if (it_ctrl.is_status_report_iter()) {
       if (it_ctrl.is_finished())
@@ -336,6 +366,9 @@ Status make_unscramble(Geometry &geom, IterationControl it_ctrl,
                     it_ctrl.get_current_iter(), sqrt(g_max_dist),
                     sqrt(g_min_dist));
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      it_ctrl.checkpoint(geom.verts());
   }
 
   return Status::ok();
@@ -348,34 +381,26 @@ Status make_equal_edges(Geometry &base_geom, IterationControl it_ctrl,
                         double shorten_factor, double shrink_factor,
                         Vec4d ellipsoid, const Symmetry &sym)
 {
+  ANTI_PROFILE_SCOPE("solve: equal edges");
   to_ellipsoid(base_geom, ellipsoid); // map before finding symmetry
 
   Status stat;
 
-  bool using_symmetry = (sym.get_sym_type() > Symmetry::C1);
-
   // No further processing if no faces, but not an error
   if (base_geom.faces().size() == 0)
     return Status::ok();
 
-  SymmetricUpdater sym_updater((using_symmetry) ? base_geom : Geometry(), sym);
-  const Geometry &geom =
-      (using_symmetry) ? sym_updater.get_geom_working() : base_geom;
+  Relaxation relax(base_geom, sym);
+  const Geometry &geom = relax.get_geom();
 
   const vector<Vec3d> &verts = geom.verts();
   auto eds = GeometryInfo(geom).get_vert_cons();
 
-  vector<int> principal_verts; // first vertex in each vertex orbit
-  vector<int> verts_to_update; // vertices accessed during iteration
-  if (using_symmetry) {
-    principal_verts = sym_updater.get_principal(VERTS);
-    verts_to_update =
-        SymmetricUpdater::get_included_verts(principal_verts, eds);
-  }
-  else {
-    principal_verts =
-        SymmetricUpdater::sequential_index_list(geom.verts().size());
-  }
+  // first vertex in each vertex orbit
+  const vector<int> &principal_verts = relax.get_principal_verts();
+  // vertices accessed during iteration
+  relax.add_verts_to_update(
+      SymmetricUpdater::get_included_verts(principal_verts, eds));
 
   double g_max_dist = 0;
   double g_min_dist = 1e100;
@@ -384,45 +409,51 @@ Status make_equal_edges(Geometry &base_geom, IterationControl it_ctrl,
   double min_dist = 1e100;
   double test_val = it_ctrl.get_test_val();
 
-  vector<Vec3d> offsets(verts.size()); // Vertex adjustments
+  vector<Vec3d> offsets(verts.size());    // Vertex adjustments
+  vector<double> max_dists(verts.size()); // Vertex longest edge
+  vector<double> min_dists(verts.size()); // Vertex shortest edge
+
+  stat = relax.resume(it_ctrl, {&g_min_dist, &g_scale_factor});
+  if (stat.is_error())
+    return stat;
 
   for (it_ctrl.start_iter_with_setup(); !it_ctrl.is_done();
        it_ctrl.next_iter()) {
-    std::fill(offsets.begin(), offsets.end(), Vec3d::zero);
+    // Ensure that the vertices used in adjustment are up to date
+    relax.update_verts();
 
-    if (using_symmetry) {
-      // Ensure that the vertices used in adjustment are up to date
-      for (auto v_idx : verts_to_update)
-        sym_updater.update_from_principal_vertex(v_idx);
-    }
-
-    max_dist = 0;
-    min_dist = 1e100;
-    for (int v_idx : principal_verts) {
-      if (eds[v_idx].size() == 0)
-        continue;
+    relax.for_each(principal_verts, [&](int v_idx) {
+      offsets[v_idx] = Vec3d::zero;
+      max_dists[v_idx] = 0;
+      min_dists[v_idx] = 1e100;
       for (unsigned int i = 0; i < eds[v_idx].size(); i++) {
         auto vec = verts[v_idx] - verts[eds[v_idx][i]];
         double dist = vec.len();
-        if (dist > max_dist)
-          max_dist = dist;
-        if (dist < min_dist)
-          min_dist = dist;
+        if (dist > max_dists[v_idx])
+          max_dists[v_idx] = dist;
+        if (dist < min_dists[v_idx])
+          min_dists[v_idx] = dist;
         offsets[v_idx] += (vec / dist) * (g_min_dist - dist) * g_scale_factor *
                           shorten_factor;
       }
-    }
+    });
+
+    max_dist = parallel_reduce<double>(
+        principal_verts.size(), 0.0,
+        [&](size_t i) { return max_dists[principal_verts[i]]; },
+        [](const double &a, const double &b) { return std::max(a, b); });
+    min_dist = parallel_reduce<double>(
+        principal_verts.size(), 1e100,
+        [&](size_t i) { return min_dists[principal_verts[i]]; },
+        [](const double &a, const double &b) { return std::min(a, b); });
 
     // adjust vertices post-loop (skip setup iter as global values not set)
     if (!it_ctrl.is_setup_iter()) {
-      for (int v_idx : principal_verts) {
+      relax.move_verts([&](int v_idx) {
         auto vert = verts[v_idx] + offsets[v_idx];
         to_ellipsoid(vert, ellipsoid);
-        if (using_symmetry)
-          sym_updater.update_principal_vertex(v_idx, vert);
-        else
-          base_geom.verts(v_idx) = vert;
-      }
+        return vert;
+      });
     }
 
     g_min_dist = min_dist * (1 - shrink_factor);
@@ -433,15 +464,11 @@ Status make_equal_edges(Geometry &base_geom, IterationControl it_ctrl,
     if (!it_ctrl.is_setup_iter()) {
       string finish_msg;
       if (it_ctrl.is_status_check_iter()) {
-
-        if ((max_dist - min_dist) < test_val) { // absolute difference
-          it_ctrl.set_finished();
-          finish_msg = "solved, test value achieved";
-        }
-        else if (it_ctrl.is_last_iter()) {
-          it_ctrl.set_finished();
-          finish_msg = "not solved, test value not achieved";
-        }
+        // absolute difference
+        bool solved = ((max_dist - min_dist) < test_val);
+        finish_msg = it_ctrl.check_solved(solved).msg();
+        it_ctrl.record(max_dist - min_dist,
+                       {{"max", max_dist}, {"min", min_dist}}, finish_msg);
       }
 
       if (it_ctrl.is_status_report_iter()) {
@@ -452,11 +479,13 @@ Status make_equal_edges(Geometry &base_geom, IterationControl it_ctrl,
                       it_ctrl.get_current_iter(), max_dist, min_dist,
                       max_dist - min_dist);
       }
+
+      if (it_ctrl.is_checkpoint_iter())
+        relax.checkpoint(it_ctrl, {g_min_dist, g_scale_factor});
     }
   }
 
-  if (using_symmetry)
-    base_geom = sym_updater.get_geom_final();
+  relax.finish();
 
   return Status::ok();
 }
@@ -468,10 +497,9 @@ Status make_regular_faces(Geometry &base_geom, IterationControl it_ctrl,
                           double shorten_factor, double plane_factor,
                           double radius_factor, const Symmetry &sym)
 {
+  ANTI_PROFILE_SCOPE("solve: regular faces");
   Status stat;
 
-  bool using_symmetry = (sym.get_sym_type() > Symmetry::C1);
-
   // No further processing if no faces, but not an error
   if (base_geom.faces().size() == 0)
     return Status::ok();
@@ -484,12 +512,12 @@ Status make_regular_faces(Geometry &base_geom, IterationControl it_ctrl,
   if (scale)
     base_geom.transform(Trans3d::scale(1 / scale));
 
-  SymmetricUpdater sym_updater((using_symmetry) ? base_geom : Geometry(), sym);
-  const Geometry &geom =
-      (using_symmetry) ? sym_updater.get_geom_working() : base_geom;
+  Relaxation relax(base_geom, sym);
+  const Geometry &geom = relax.get_geom();
 
   const vector<Vec3d> &verts = geom.verts();
   const vector<vector<int>> &faces = geom.faces();
+  const vector<vector<int>> &edges = info.get_impl_edges();
 
   double max_diff2 = 0;
   Vec3d origin(0, 0, 0);
@@ -502,40 +530,49 @@ Status make_regular_faces(Geometry &base_geom, IterationControl it_ctrl,
     rads[f] = 0.5 / sin(M_PI * D / N); // circumradius of regular polygon
   }
 
-  vector<int> principal_verts;  // first vertex in each vertex orbit
-  vector<int> verts_to_update;  // vertices accessed during iteration
-  vector<int> faces_to_process; // faces processed during iteration
-  vector<int> edges_to_process; // edges processed during iteration
-  if (using_symmetry) {
-    principal_verts = sym_updater.get_principal(VERTS);
-    faces_to_process = sym_updater.get_associated_elems(info.get_vert_faces());
-    edges_to_process =
-        sym_updater.get_associated_elems(info.get_vert_impl_edges());
-    // All the vertices that need to be updated lie on the faces to be processed
-    verts_to_update =
-        SymmetricUpdater::get_included_verts(faces_to_process, geom.faces());
+  // faces processed during iteration
+  vector<int> faces_to_process =
+      relax.get_elems_to_process(info.get_vert_faces(), faces.size());
+  // edges processed during iteration
+  vector<int> edges_to_process =
+      relax.get_elems_to_process(info.get_vert_impl_edges(), edges.size());
+  // All the vertices that need to be updated lie on the faces to be processed
+  relax.add_verts_to_update(
+      SymmetricUpdater::get_included_verts(faces_to_process, geom.faces()));
+
+  // The faces and edges write their offsets for each vertex into slots,
+  // which are then summed for each vertex in the order they were listed
+  vector<int> face_slots(faces.size()); // first slot of each face
+  vector<int> edge_slots(edges.size()); // first slot of each edge
+  vector<vector<int>> vert_slots(verts.size());
+  int num_slots = 0;
+  for (int f_idx : faces_to_process) {
+    face_slots[f_idx] = num_slots;
+    for (int v_idx : faces[f_idx]) {
+      vert_slots[v_idx].push_back(num_slots++); // planarity
+      vert_slots[v_idx].push_back(num_slots++); // polygon radius
+    }
   }
-  else { // not using_symmetry
-    principal_verts =
-        SymmetricUpdater::sequential_index_list(geom.verts().size());
-    faces_to_process =
-        SymmetricUpdater::sequential_index_list(geom.faces().size());
-    edges_to_process =
-        SymmetricUpdater::sequential_index_list(info.get_impl_edges().size());
+  for (int e_idx : edges_to_process) {
+    edge_slots[e_idx] = num_slots;
+    vert_slots[edges[e_idx][0]].push_back(num_slots++);
+    vert_slots[edges[e_idx][1]].push_back(num_slots++);
   }
+  const FlatLists vert_slot_lists(vert_slots);
+  vert_slots.clear();
+  vector<Vec3d> slots(num_slots);
 
   vector<Vec3d> offsets(verts.size()); // Vertex adjustments
 
-  for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
-    std::fill(offsets.begin(), offsets.end(), Vec3d::zero);
+  stat = relax.resume(it_ctrl);
+  if (stat.is_error())
+    return stat;
 
-    if (using_symmetry) {
-      // Ensure that the vertices used in adjustment are up to date
-      for (int v_idx : verts_to_update)
-        sym_updater.update_from_principal_vertex(v_idx);
-    }
+  for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
+    // Ensure that the vertices used in adjustment are up to date
+    relax.update_verts();
 
-    for (int f_idx : faces_to_process) {
+    relax.for_each(faces_to_process, [&](int f_idx) {
       const vector<int> &face = faces[f_idx];
 
       Vec3d norm = geom.face_norm(f_idx).unit();
@@ -543,61 +580,47 @@ Status make_regular_faces(Geometry &base_geom, IterationControl it_ctrl,
       if (vdot(norm, f_cent) < 0)
         norm *= -1.0;
 
+      int slot = face_slots[f_idx];
       for (int i = 0; i < (int)face.size(); i++) {
         const int v_idx = face[i];
         // offset for planarity
-        offsets[v_idx] +=
-            vdot(plane_factor * norm, f_cent - verts[v_idx]) * norm;
+        slots[slot++] = vdot(plane_factor * norm, f_cent - verts[v_idx]) * norm;
 
         // offset for polygon radius
         Vec3d rad_vec = (verts[v_idx] - f_cent);
-        offsets[v_idx] +=
-            (rads[f_idx] - rad_vec.len()) * radius_factor * rad_vec;
+        slots[slot++] = (rads[f_idx] - rad_vec.len()) * radius_factor * rad_vec;
       }
-    }
+    });
 
     // offsets for unit edges
-    for (int e_idx : edges_to_process) {
-      const auto &edge = info.get_impl_edges()[e_idx];
+    relax.for_each(edges_to_process, [&](int e_idx) {
+      const auto &edge = edges[e_idx];
       Vec3d offset =
           (1 - geom.edge_len(edge)) * shorten_factor * geom.edge_vec(edge);
-      offsets[edge[0]] -= 2 * offset;
-      offsets[edge[1]] += 2 * offset;
-    }
+      slots[edge_slots[e_idx]] = -(2 * offset);
+      slots[edge_slots[e_idx] + 1] = 2 * offset;
+    });
 
-    // adjust vertices post-loop
-    if (using_symmetry) {
-      // adjust principal vertices
-      for (int v_idx : principal_verts)
-        sym_updater.update_principal_vertex(v_idx,
-                                            verts[v_idx] + offsets[v_idx]);
-    }
-    else { // not using_symmetry
-      // adjust all vertices
-      for (unsigned int i = 0; i < verts.size(); i++)
-        base_geom.raw_verts()[i] += offsets[i];
-    }
+    relax.for_range(verts.size(), [&](int v_idx) {
+      offsets[v_idx] = Vec3d::zero;
+      for (auto p = vert_slot_lists.begin(v_idx);
+           p != vert_slot_lists.end(v_idx); ++p)
+        offsets[v_idx] += slots[*p];
+    });
+
+    // adjust principal vertices post-loop, or all without symmetry
+    relax.move_verts([&](int v_idx) { return verts[v_idx] + offsets[v_idx]; });
 
     string finish_msg;
     if (it_ctrl.is_status_check_iter()) {
 
-      max_diff2 = 0;
-      for (auto &offset : offsets) {
-        double diff2 = offset.len2();
-        if (diff2 > max_diff2)
-          max_diff2 = diff2;
-      }
+      max_diff2 = parallel_reduce<double>(
+          offsets.size(), 0.0, [&](size_t i) { return offsets[i].len2(); },
+          [](const double &a, const double &b) { return std::max(a, b); });
 
       double width = BoundBox(verts).max_width();
-      if (sqrt(max_diff2) / width < test_val) {
-        it_ctrl.set_finished();
-        finish_msg = "solved, test value achieved";
-      }
-      else if (it_ctrl.is_last_iter()) {
-        // reached last iteration without solving
-        it_ctrl.set_finished();
-        finish_msg = "not solved, test value not achieved";
-      }
+      bool solved = (sqrt(max_diff2) / width < test_val);
+      finish_msg = it_ctrl.check_solved(solved).msg();
 
       // check if radius is expanding or contracting unreasonably,
       // but only for the purpose of finishing early
@@ -608,6 +631,8 @@ Status make_regular_faces(Geometry &base_geom, IterationControl it_ctrl,
             finish_msg = "not solved, quit early as probably diverging";
           }
       }
+      it_ctrl.record(sqrt(max_diff2) / width, {{"max_diff", sqrt(max_diff2)}},
+                     finish_msg);
     }
 
     if (it_ctrl.is_status_report_iter()) {
@@ -617,10 +642,12 @@ Status make_regular_faces(Geometry &base_geom, IterationControl it_ctrl,
       it_ctrl.print("%-12u max_diff:%17.15e\n", it_ctrl.get_current_iter(),
                     sqrt(max_diff2));
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      relax.checkpoint(it_ctrl);
   }
 
-  if (using_symmetry)
-    base_geom = sym_updater.get_geom_final();
+  relax.finish();
 
   return Status::ok();
 }
@@ -646,6 +673,15 @@ int main(int argc, char *argv[])
   if (geom.faces().size() == 0)
     opts.warning("no face date in input, no iterative processing will occur");
 
+  // a checkpoint is only resumed by the same algorithm
+  string stage = msg_str("poly_form -a %c", opts.algm);
+  opts.it_ctrl.set_stage(stage);
+  if (opts.it_ctrl.is_resume_pending() &&
+      opts.it_ctrl.get_resume_stage() != stage)
+    opts.error(msg_str("checkpoint is from '%s', not this algorithm",
+                       opts.it_ctrl.get_resume_stage().c_str()),
+               'U');
+
   if (opts.algm == 'r') {
     opts.print_status_or_exit(make_regular_faces(
         geom, opts.it_ctrl, opts.shorten_by / 200, opts.flatten_by / 100,
@@ -666,6 +702,11 @@ int main(int argc, char *argv[])
         make_planar(geom, opts.it_ctrl, opts.flatten_by / 100, sym));
   }
 
+  if (opts.it_ctrl.is_resume_pending())
+    opts.error("checkpoint was not resumed, it does not match the model or "
+               "the options",
+               'U');
+
   opts.write_or_error(geom, opts.ofile);
 
   return 0;
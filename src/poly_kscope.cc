@@ -60,6 +60,7 @@ public:
   char col_elems;
   Coloring clrngs[3];
   bool consider_part_sym;
+  bool merge_orbits;
   bool print_report;
 
   bool compound_print_list;
@@ -72,7 +73,7 @@ public:
 
   ksc_opts()
       : ProgramOpts("poly_kscope"), sub_sym_conj(0), col_elems('\0'),
-        consider_part_sym(true), print_report(false),
+        consider_part_sym(true), merge_orbits(false), print_report(false),
         compound_print_list(false), compound_number(-1)
   {
   }
@@ -109,6 +110,8 @@ Options
             (default 'vef'). The 'compound' map should give useful results.
   -I        ignore shared symmetries, full kaleidoscopic repetition of
             component
+  -M        merge coincident elements, found from the symmetry orbits of
+            the component vertices rather than by comparing positions
   -Q        print information about compound
   -o <file> write output to file (default: write to standard output)
 
@@ -129,7 +132,7 @@ void ksc_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hs:c:m:Iy:Qo:")) != -1) {
+  while ((c = getopt(argc, argv, ":hs:c:m:IMy:Qo:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -208,6 +211,10 @@ void ksc_opts::process_command_line(int argc, char **argv)
       consider_part_sym = false;
       break;
 
+    case 'M':
+      merge_orbits = true;
+      break;
+
     case 'Q':
       print_report = true;
       break;
@@ -411,7 +418,13 @@ int main(int argc, char *argv[])
     print_report(stderr, opts.sym, part_sym, min_ts.size());
 
   Geometry comp_geom;
-  sym_repeat(comp_geom, geom, min_ts, opts.col_elems, opts.clrngs);
+  if (opts.merge_orbits) {
+    if (!sym_repeat_merged(comp_geom, geom, min_ts, opts.sym.get_trans(),
+                           opts.col_elems, opts.clrngs))
+      opts.error("symmetry transformations do not form a group", 'M');
+  }
+  else
+    sym_repeat(comp_geom, geom, min_ts, opts.col_elems, opts.clrngs);
 
   opts.write_or_error(comp_geom, opts.ofile);
 
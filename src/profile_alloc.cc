@@ -0,0 +1,103 @@
+/*
+   Copyright (c) 2026, Adrian Rossiter
+
+   Antiprism - http://www.antiprism.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+      The above copyright notice and this permission notice shall be included
+      in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+
+/*
+   Name: profile_alloc.cc
+   Description: replacement allocation functions, to count allocations
+                for --profile
+   Project: Antiprism - http://www.antiprism.com
+*/
+
+// These are linked into the programs, and not the library, so that a
+// program using the library keeps its own allocation functions. The
+// library's calls to operator new resolve to the program's functions.
+// Aligned allocation is C++17, and is not replaced in this C++14 build.
+
+#include "../base/antiprism.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifndef ANTI_NO_PROFILE
+
+namespace {
+
+void *alloc(std::size_t size)
+{
+  if (anti::Profiler::is_enabled())
+    anti::Profiler::add_alloc(size);
+  if (size == 0)
+    size = 1;
+  while (true) {
+    void *ptr = malloc(size);
+    if (ptr)
+      return ptr;
+    std::new_handler handler = std::get_new_handler();
+    if (!handler)
+      throw std::bad_alloc();
+    handler();
+  }
+}
+
+void *alloc_nothrow(std::size_t size) noexcept
+{
+  try {
+    return alloc(size);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+} // namespace
+
+void *operator new(std::size_t size) { return alloc(size); }
+
+void *operator new[](std::size_t size) { return alloc(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  return alloc_nothrow(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  return alloc_nothrow(size);
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete[](void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { free(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { free(ptr); }
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+  free(ptr);
+}
+
+#endif // ANTI_NO_PROFILE
@@ -278,6 +278,16 @@ void rep_printer::distances_sec()
   fprintf(ofile, "\n");
 }
 
+void rep_printer::intersections_sec()
+{
+  int f_cnt;
+  const long pair_cnt = FaceIntersections(get_geom()).count(&f_cnt);
+  fprintf(ofile, "[intersections]\n");
+  fprintf(ofile, "face_pairs = %ld\n", pair_cnt);
+  fprintf(ofile, "faces = %d\n", f_cnt);
+  fprintf(ofile, "\n");
+}
+
 void rep_printer::symmetry()
 {
   fprintf(ofile, "[symmetry]\n");
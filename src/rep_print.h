@@ -87,6 +87,7 @@ public:
   void solid_angles_sec();
   void distances_sec();
   void symmetry();
+  void intersections_sec();
 
   void face_sides_cnts();
   void vert_order_cnts();
@@ -30,6 +30,7 @@
 
 #include "../base/antiprism.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstdlib>
@@ -88,6 +89,10 @@ Options
             check) (0 for final report only, -1 for no report), optionally
             followed by a comma and the number of iterations between
             termination checks (0 for report checks only) (default: %d,%d)
+  -R <file> write progress records to file on status reports, as CSV if
+            the name ends in .csv, otherwise as JSON lines
+  -K <file> write a checkpoint to file on status reports, to resume from
+  -U <file> resume from a checkpoint file, using the same input and options
   -o <file> write output to file (default: write to standard output)
 
 )",
@@ -106,7 +111,7 @@ void rep_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hn:z:N:s:l:r:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":hn:z:N:s:l:r:R:K:U:o:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -145,6 +150,18 @@ void rep_opts::process_command_line(int argc, char **argv)
                 c);
       break;
 
+    case 'R':
+      print_status_or_exit(it_ctrl.set_record_file(optarg), c);
+      break;
+
+    case 'K':
+      print_status_or_exit(it_ctrl.set_checkpoint_file(optarg), c);
+      break;
+
+    case 'U':
+      print_status_or_exit(it_ctrl.set_resume_file(optarg), c);
+      break;
+
     case 'o':
       ofile = optarg;
       break;
@@ -154,6 +171,12 @@ void rep_opts::process_command_line(int argc, char **argv)
     }
   }
 
+  if (!it_ctrl.get_checkpoint_file().empty() &&
+      it_ctrl.get_status_check_and_report_iters() <= 0)
+    warning("checkpoints are only written on status reports, which are "
+            "turned off by -z",
+            'K');
+
   if (argc - optind > 1)
     error("too many arguments");
 
@@ -186,6 +209,7 @@ void random_placement(Geometry &geom, int n)
 void repel(Geometry &geom, IterationControl it_ctrl, double exponent,
            double shorten_factor)
 {
+  ANTI_PROFILE_SCOPE("solve: repel");
   const int v_sz = geom.verts().size();
   vector<int> wts(v_sz);
   for (int i = 0; i < v_sz; i++) {
@@ -193,11 +217,12 @@ void repel(Geometry &geom, IterationControl it_ctrl, double exponent,
     wts[i] = col.is_index() ? col.get_index() : 1;
   }
   vector<Vec3d> offsets(v_sz);
-  double dist2, max_dist2 = 0;
+  double max_dist2 = 0;
   double last_av_max_dist2 = 0, max_dist2_sum = 0;
   bool adaptive = false;
-  int chng_cnt = 0;
-  int converge = 0;
+  // counters are held as doubles so they can be checkpointed
+  double chng_cnt = 0;
+  double converge = 0;
   const int anum = 50;
   if (shorten_factor < 0) {
     adaptive = true;
@@ -206,9 +231,15 @@ void repel(Geometry &geom, IterationControl it_ctrl, double exponent,
 
   double test_val = it_ctrl.get_test_val();
 
+  // a checkpoint that does not match is reported by the caller
+  if (it_ctrl.resume(geom.raw_verts(),
+                     {&shorten_factor, &last_av_max_dist2, &max_dist2_sum,
+                      &chng_cnt, &converge})
+          .is_error())
+    return;
+
   for (it_ctrl.start_iter(); !it_ctrl.is_done(); it_ctrl.next_iter()) {
     std::fill(offsets.begin(), offsets.end(), Vec3d::zero);
-    max_dist2 = 0;
 
     for (int i = 0; i < v_sz - 1; i++) {
       for (int j = i + 1; j < v_sz; j++) {
@@ -219,15 +250,18 @@ void repel(Geometry &geom, IterationControl it_ctrl, double exponent,
       }
     }
 
-    for (int i = 0; i < v_sz; i++) {
-      Vec3d new_pos = (geom.verts(i) + offsets[i] * shorten_factor).unit();
-      dist2 = (new_pos - geom.verts(i)).len2();
-      if (dist2 > max_dist2)
-        max_dist2 = dist2;
-      if (dist2 > 0.001)
-        new_pos = (new_pos + geom.verts(i)).unit();
-      geom.verts(i) = new_pos;
-    }
+    // each vertex is only moved by its own index
+    max_dist2 = parallel_reduce<double>(
+        v_sz, 0.0,
+        [&](size_t i) {
+          Vec3d new_pos = (geom.verts(i) + offsets[i] * shorten_factor).unit();
+          double dist2 = (new_pos - geom.verts(i)).len2();
+          if (dist2 > 0.001)
+            new_pos = (new_pos + geom.verts(i)).unit();
+          geom.verts(i) = new_pos;
+          return dist2;
+        },
+        [](const double &a, const double &b) { return std::max(a, b); });
 
     if (adaptive) {
       max_dist2_sum += max_dist2;
@@ -271,18 +305,26 @@ void repel(Geometry &geom, IterationControl it_ctrl, double exponent,
         finish_reason = "not solved, test value not achieved";
       }
 
-      if (it_ctrl.is_status_report_iter()) {
-        double offset_sum = 0.0;
+      double offset_sum = 0.0;
+      if (it_ctrl.is_status_report_iter() || it_ctrl.is_recording())
         for (auto &offset : offsets)
           offset_sum += offset.len();
 
+      if (it_ctrl.is_status_report_iter()) {
         if (it_ctrl.is_finished())
           it_ctrl.print("Final iteration (%s):\n", finish_reason.c_str());
         it_ctrl.print("%-12u  max_diff:%-16.10g  s:%-11.6g  F-sum:%-.16g\n",
                       it_ctrl.get_current_iter(), sqrt(max_dist2),
                       shorten_factor, offset_sum);
       }
+      it_ctrl.record(sqrt(max_dist2),
+                     {{"shorten", shorten_factor}, {"force_sum", offset_sum}},
+                     finish_reason);
     }
+
+    if (it_ctrl.is_checkpoint_iter())
+      it_ctrl.checkpoint(geom.verts(), {shorten_factor, last_av_max_dist2,
+                                        max_dist2_sum, chng_cnt, converge});
   }
 }
 
@@ -297,8 +339,21 @@ int main(int argc, char *argv[])
   else
     opts.read_or_error(geom, opts.ifile);
 
+  // a checkpoint is only resumed by the same algorithm
+  opts.it_ctrl.set_stage("repel");
+  if (opts.it_ctrl.is_resume_pending() &&
+      opts.it_ctrl.get_resume_stage() != "repel")
+    opts.error(msg_str("checkpoint is from '%s', not this algorithm",
+                       opts.it_ctrl.get_resume_stage().c_str()),
+               'U');
+
   repel(geom, opts.it_ctrl, opts.repel_formula_exp, opts.shorten_by / 100);
 
+  if (opts.it_ctrl.is_resume_pending())
+    opts.error("checkpoint was not resumed, it does not match the model or "
+               "the options",
+               'U');
+
   opts.write_or_error(geom, opts.ofile);
 
   return 0;
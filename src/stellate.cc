@@ -56,6 +56,7 @@ public:
 
   bool move_to_front = false; // move side with stellation to front
   int projection_width = 500; // magnification of diagram
+  string cache_dir;           // directory to store diagrams between runs
 
   vector<string> diagram_list_strings; // face numbers of diagram to use
   string sym_str;                      // for sub-symmetry
@@ -108,6 +109,8 @@ Scene Options
               F - highlight used faces only (when using D, S or R)
   -z        move first diagram to face front (out of symmetry alignment)
   -w <int>  width to project stellation diagram (default: 500)
+  -C <dir>  directory to store stellation diagrams, which are reused by later
+            runs with the same model and settings (directory must exist)
   
 Coloring Options (run 'off_util -H color' for help on color formats)
 keyword: none - sets no color
@@ -155,7 +158,7 @@ void stellate_opts::process_command_line(int argc, char **argv)
 
   handle_long_opts(argc, argv);
 
-  while ((c = getopt(argc, argv, ":hf:s:MISRDrzw:O:V:E:F:T:m:l:o:")) != -1) {
+  while ((c = getopt(argc, argv, ":hf:s:MISRDrzw:C:O:V:E:F:T:m:l:o:")) != -1) {
     if (common_opts(c, optopt))
       continue;
 
@@ -204,6 +207,10 @@ void stellate_opts::process_command_line(int argc, char **argv)
         error("projection width must be greater than zero", c);
       break;
 
+    case 'C':
+      cache_dir = optarg;
+      break;
+
     case 'O':
       if (strspn(optarg, "sdiDSFR") != strlen(optarg))
         error(msg_str("output parts are '%s' must be any or all from "
@@ -332,7 +339,7 @@ void stellate_opts::process_command_line(int argc, char **argv)
 }
 
 // idx_lists still contains stellation face number in position 0
-Geometry construct_model(Geometry &geom, map<int, Geometry> &diagrams,
+Geometry construct_model(Geometry &geom, StellationDiagrams &stel_diagrams,
                          vector<vector<int>> &idx_lists, stellate_opts &opts)
 {
   Geometry model;
@@ -340,18 +347,11 @@ Geometry construct_model(Geometry &geom, map<int, Geometry> &diagrams,
 
   // construct the stellation, before coloring diagrams...
   // make_stellation needs diagrams to have color indexes
-  string geom_sym_symbol = opts.sym_str;
   if (opts.output_parts.find("s") != string::npos) {
-    // set the symmetry
-    if (!geom_sym_symbol.length()) {
-      Symmetry geom_full_sym(geom);
-      geom_sym_symbol = geom_full_sym.get_symbol().c_str();
-    }
-
-    stellation = make_stellation(
-        geom, diagrams, idx_lists, geom_sym_symbol, opts.merge_faces,
-        opts.remove_inline_vertices, opts.split_pinched, opts.resolve_faces,
-        opts.remove_multiples, opts.map_string, opts.eps);
+    stellation = stel_diagrams.make_stellation(
+        idx_lists, opts.merge_faces, opts.remove_inline_vertices,
+        opts.split_pinched, opts.resolve_faces, opts.remove_multiples,
+        opts.map_string);
 
     if (opts.rebuild_compound_model) {
       rebuild_compound(stellation);
@@ -362,10 +362,12 @@ Geometry construct_model(Geometry &geom, map<int, Geometry> &diagrams,
   // need to execute before coloring diagrams
   // these functions need diagrams to have color indexes
   vector<vector<int>> idx_lists_full =
-      lists_full(diagrams, idx_lists, opts.remove_multiples);
-  vector<vector<int>> idx_lists_resolved =
-      lists_resolved(geom, geom_sym_symbol, diagrams, idx_lists, idx_lists_full,
-                     opts.remove_multiples);
+      stel_diagrams.lists_full(idx_lists, opts.remove_multiples);
+  vector<vector<int>> idx_lists_resolved = stel_diagrams.lists_resolved(
+      idx_lists, idx_lists_full, opts.remove_multiples);
+
+  // diagrams for display, the originals keep their color indexes
+  map<int, Geometry> diagrams = stel_diagrams.get_diagrams();
 
   // color diagrams
   for (auto const &key1 : diagrams) {
@@ -511,7 +513,9 @@ int main(int argc, char *argv[])
 
   int fsz = geom.faces().size() - 1;
 
-  map<int, Geometry> diagrams;
+  StellationDiagrams stel_diagrams;
+  stel_diagrams.init(geom, opts.sym_str, opts.projection_width, opts.eps);
+  stel_diagrams.set_cache_dir(opts.cache_dir);
 
   int sz = opts.diagram_list_strings.size();
   vector<vector<int>> idx_lists(sz);
@@ -537,11 +541,12 @@ int main(int argc, char *argv[])
     if (idx_lists[i].size() > 1)
       display_diagrams_only = false;
 
-    // construct the diagrams
-    if (!diagrams[stellation_face_idx].verts().size())
-      diagrams[stellation_face_idx] =
-          make_stellation_diagram(geom, stellation_face_idx, opts.sym_str,
-                                  opts.projection_width, opts.eps);
+    // construct the diagrams, or read them from the cache
+    Status stat = stel_diagrams.add_diagram(stellation_face_idx);
+    if (stat.is_warning())
+      opts.warning(stat.msg(), 'C');
+    else if (stat.is_error())
+      opts.error(stat.msg(), 'f');
 
     // check face index range. start from 1 since 0 is a placeholder for
     // stellation face
@@ -551,7 +556,8 @@ int main(int argc, char *argv[])
         max_idx = idx_lists[i][j];
     }
 
-    int dsz = (int)diagrams[stellation_face_idx].faces().size() - 1;
+    int dsz =
+        (int)stel_diagrams.get_diagram(stellation_face_idx).faces().size() - 1;
     if (max_idx > dsz)
       opts.error(msg_str("diagram(%d) number given: %d is larger than maximum "
                          "face number: %d",
@@ -567,7 +573,7 @@ int main(int argc, char *argv[])
     opts.output_parts = "d" + opts.output_parts;
   }
 
-  geom = construct_model(geom, diagrams, idx_lists, opts);
+  geom = construct_model(geom, stel_diagrams, idx_lists, opts);
   // color_by_edge_usage(geom);
 
   opts.write_or_error(geom, opts.ofile);
@@ -351,15 +351,15 @@ private:
 
   bool find_nbrs();
   vector<Vec3d> point_on_face(int f_idx, const Vec3d &crds) const;
-  void add_circuit(Geometry &wv, int start_idx, const weave_pattern &pat,
-                   vector<bool> &seen) const;
+  bool trace_circuit(int start_idx, const weave_pattern &pat,
+                     vector<Vec3d> &pts, vector<int> &starts) const;
   const vector<weave_pattern> &get_pats() const { return pats; }
 
 public:
   bool set_geom(const Geometry &geom, double face_ht = 0.0);
   void add_pattern(const weave_pattern &pattern) { pats.push_back(pattern); }
   Status add_pattern(const string &pat);
-  void make_weave(Geometry &wv) const;
+  void make_weave(Geometry &wv, int num_threads = 0) const;
 
   const Geometry &get_meta() const { return meta; }
 };
@@ -407,35 +407,31 @@ inline vector<Vec3d> weave::point_on_face(int f_idx, const Vec3d &crds) const
   return ret;
 }
 
-void weave::add_circuit(Geometry &wv, int start_idx, const weave_pattern &pat,
-                        vector<bool> &seen) const
+// Get the points of a circuit, and append the start triangle of each
+// application of the pattern to starts, return false if the circuit tried
+// to cross an open edge
+bool weave::trace_circuit(int start_idx, const weave_pattern &pat,
+                          vector<Vec3d> &pts, vector<int> &starts) const
 {
   // Apply pattern until circuit completes
+  pts.clear();
   vector<Vec3d> prev_pt;
   bool finish = false;
-  int start_v_sz = wv.verts().size();
   int idx = start_idx;
   while (true) {
-    seen[idx] = true;
+    starts.push_back(idx);
     pat.start_op();
     while (pat.get_op() != weave_pattern::END) {
-      // fprintf(stderr, "op=%d\n", pat.get_op());
-      // fprintf(stderr, "nbrs[%d] = %d, %d, %d\n", idx,
-      // nbrs[idx][0],nbrs[idx][1],nbrs[idx][2]);
-      // fprintf(stderr, "nbrs[%d][%d] = %d, idx=%d, start_idx=%d\n", idx, op,
-      // nbrs[idx][op], idx, start_idx);
       if (pat.get_op() == weave_pattern::P) {
         vector<Vec3d> pt = point_on_face(idx, pat.get_path().get_point());
         if (prev_pt.size())
-          pat.get_path().add_points(&wv.raw_verts(), prev_pt, pt);
+          pat.get_path().add_points(&pts, prev_pt, pt);
         prev_pt = pt;
       }
       else {
         idx = nbrs[idx][pat.get_op()]; // move to next triangle
-        if (idx < 0) { // abandon: circuit tried to cross an open edge
-          wv.raw_verts().resize(start_v_sz); // remove any added verts
-          return;
-        }
+        if (idx < 0) // abandon: circuit tried to cross an open edge
+          return false;
       }
       pat.next_op();
     }
@@ -444,12 +440,7 @@ void weave::add_circuit(Geometry &wv, int start_idx, const weave_pattern &pat,
     if (idx == start_idx && prev_pt.size()) // circuit complete
       finish = true;
   }
-
-  const int f_sz = wv.verts().size() - start_v_sz;
-  vector<int> face(f_sz);
-  for (int i = 0; i < f_sz; i++)
-    face[i] = start_v_sz + i;
-  wv.add_face(face);
+  return true;
 }
 
 static void reverse_odd_faces(Geometry &geom)
@@ -493,7 +484,7 @@ bool valid_start_face(int f, int start_faces)
     return false;
 }
 
-void weave::make_weave(Geometry &wv) const
+void weave::make_weave(Geometry &wv, int num_threads) const
 {
   // for(unsigned int i=0; i<nbrs.size(); i++)
   //   fprintf(stderr, "nbrs[%d] = %d, %d, %d\n", i,
@@ -503,11 +494,71 @@ void weave::make_weave(Geometry &wv) const
   int faces_sz = meta.faces().size();
   for (const auto &pat : pats) {
     // fprintf(stderr, "pattern is '%s'\n", pats[p].get_pattern().c_str());
-    vector<bool> seen(faces_sz, false);
+    // Trace the circuits from the start triangles of each block in
+    // parallel, skipping triangles already seen in the block, then claim
+    // them in start order, skipping those that start on a triangle seen
+    // by an earlier claimed circuit. This gives the circuits found by
+    // tracing from each triangle in order.
+    struct Trace {
+      int start;
+      bool complete;
+      size_t starts_end; // end of the start triangles in the block list
+      vector<Vec3d> pts;
+    };
+    struct BlockTraces {
+      vector<Trace> traces;
+      vector<int> starts; // start triangles of each pattern application
+    };
     unsigned char start_faces = pat.get_start_faces();
-    for (int i = 0; i < faces_sz; i++) {
-      if (!seen[i] && valid_start_face(i, start_faces))
-        add_circuit(wv, i, pat, seen);
+    // a circuit that passes through several blocks is traced in each of
+    // them, so use one block for each thread
+    const size_t num_blocks =
+        std::min((size_t)faces_sz,
+                 (size_t)((num_threads > 0) ? num_threads : get_max_threads()));
+    vector<BlockTraces> blocks(num_blocks);
+    parallel_for_blocks(
+        faces_sz, num_blocks,
+        [&](size_t b, size_t begin, size_t end) {
+          weave_pattern pat_copy = pat; // keeps its own reading position
+          vector<bool> block_seen(faces_sz, false);
+          BlockTraces &blk = blocks[b];
+          for (size_t i = begin; i < end; i++) {
+            if (block_seen[i] || !valid_start_face(i, start_faces))
+              continue;
+            Trace trace;
+            trace.start = i;
+            const size_t starts_begin = blk.starts.size();
+            trace.complete = trace_circuit(i, pat_copy, trace.pts, blk.starts);
+            if (!trace.complete)
+              trace.pts.clear();
+            trace.starts_end = blk.starts.size();
+            for (size_t k = starts_begin; k < trace.starts_end; k++)
+              block_seen[blk.starts[k]] = true;
+            blk.traces.push_back(std::move(trace));
+          }
+        },
+        num_threads);
+
+    vector<bool> seen(faces_sz, false);
+    vector<const vector<Vec3d> *> circuits;
+    for (const auto &blk : blocks) {
+      size_t starts_begin = 0;
+      for (const auto &trace : blk.traces) {
+        if (!seen[trace.start]) {
+          for (size_t k = starts_begin; k < trace.starts_end; k++)
+            seen[blk.starts[k]] = true;
+          if (trace.complete)
+            circuits.push_back(&trace.pts);
+        }
+        starts_begin = trace.starts_end;
+      }
+    }
+
+    for (const auto *pts : circuits) {
+      vector<int> face(pts->size());
+      for (unsigned int i = 0; i < pts->size(); i++)
+        face[i] = wv.add_vert((*pts)[i]);
+      wv.add_face(face);
     }
   }
 }